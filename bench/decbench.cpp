@@ -0,0 +1,246 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+// Reference benchmark: replays discriminator captures through DSDDecoder in each relevant decode mode
+// and prints the results as JSON. Usage: decbench [-r <runs>] file.dis...
+// The decode modes are guessed from the file name (dmr, dpmr, dstar, ysf, nxdn48, nxdn96, p25 prefixes).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <sys/resource.h>
+
+#include "dsd_decoder.h"
+#include "dsd_filters.h"
+
+struct BenchMode
+{
+    const char *prefix; //!< file name prefix
+    const char *name;
+    DSDcc::DSDDecoder::DSDDecodeMode mode;
+    DSDcc::DSDDecoder::DSDRate rate;
+};
+
+static const BenchMode benchModes[] = {
+    {"dmr",    "DMR",      DSDcc::DSDDecoder::DSDDecodeDMR,    DSDcc::DSDDecoder::DSDRate4800},
+    {"dmr",    "Auto4800", DSDcc::DSDDecoder::DSDDecodeAuto,   DSDcc::DSDDecoder::DSDRate4800},
+    {"dpmr",   "dPMR",     DSDcc::DSDDecoder::DSDDecodeDPMR,   DSDcc::DSDDecoder::DSDRate2400},
+    {"dpmr",   "Auto2400", DSDcc::DSDDecoder::DSDDecodeAuto,   DSDcc::DSDDecoder::DSDRate2400},
+    {"dstar",  "DStar",    DSDcc::DSDDecoder::DSDDecodeDStar,  DSDcc::DSDDecoder::DSDRate4800},
+    {"dstar",  "Auto4800", DSDcc::DSDDecoder::DSDDecodeAuto,   DSDcc::DSDDecoder::DSDRate4800},
+    {"ysf",    "YSF",      DSDcc::DSDDecoder::DSDDecodeYSF,    DSDcc::DSDDecoder::DSDRate4800},
+    {"ysf",    "Auto4800", DSDcc::DSDDecoder::DSDDecodeAuto,   DSDcc::DSDDecoder::DSDRate4800},
+    {"nxdn48", "NXDN48",   DSDcc::DSDDecoder::DSDDecodeNXDN48, DSDcc::DSDDecoder::DSDRate2400},
+    {"nxdn96", "NXDN96",   DSDcc::DSDDecoder::DSDDecodeNXDN96, DSDcc::DSDDecoder::DSDRate4800},
+    {"p25",    "P25P1",    DSDcc::DSDDecoder::DSDDecodeP25P1,  DSDcc::DSDDecoder::DSDRate4800}
+};
+
+static const unsigned int blockSize = 4800;
+
+static bool loadSamples(const char *fileName, std::vector<short>& samples)
+{
+    FILE *fp = fopen(fileName, "rb");
+
+    if (!fp) {
+        return false;
+    }
+
+    short buffer[4096];
+    size_t n;
+
+    while ((n = fread(buffer, sizeof(short), 4096, fp)) > 0) {
+        samples.insert(samples.end(), buffer, buffer + n);
+    }
+
+    fclose(fp);
+    return true;
+}
+
+static bool matchPrefix(const char *fileName, const char *prefix)
+{
+    const char *baseName = strrchr(fileName, '/');
+    baseName = baseName ? baseName + 1 : fileName;
+
+    if (strncmp(baseName, prefix, strlen(prefix)) != 0) {
+        return false;
+    }
+
+    char next = baseName[strlen(prefix)];
+    return (next < 'a') || (next > 'z'); // whole word only
+}
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static void runBench(const char *fileName, const std::vector<short>& samples, const BenchMode& benchMode, int nbRuns, bool& first)
+{
+    double decoderTime = 0.0, filterTime = 0.0;
+    long long nbSymbols = 0, nbFrames = 0, nbAudioFrames = 0;
+    std::vector<short> filtered(blockSize);
+    DSDcc::DSDStatsSnapshot stats;
+
+    for (int run = 0; run < nbRuns; run++)
+    {
+        DSDcc::DSDDecoder decoder;
+        decoder.setQuiet();
+        decoder.setLogVerbosity(0);
+        decoder.setDecodeMode(DSDcc::DSDDecoder::DSDDecodeNone, true);
+        decoder.setDataRate(benchMode.rate);
+        decoder.setDecodeMode(benchMode.mode, true);
+        nbSymbols = nbFrames = nbAudioFrames = 0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::size_t index = 0;
+
+        while (index < samples.size())
+        {
+            int blockSymbols, blockAudioFrames;
+            std::size_t nbSamples = std::min((std::size_t) blockSize, samples.size() - index);
+            index += decoder.runBlock(&samples[index], nbSamples, blockSymbols, blockAudioFrames);
+            nbSymbols += blockSymbols;
+            nbAudioFrames += blockAudioFrames;
+
+            if (decoder.mbeDVReady1())
+            {
+                nbFrames++;
+                decoder.resetMbeDV1();
+            }
+
+            if (decoder.mbeDVReady2())
+            {
+                nbFrames++;
+                decoder.resetMbeDV2();
+            }
+
+            int nbAudioSamples;
+            decoder.getAudioView1(nbAudioSamples);
+            decoder.releaseAudio1(nbAudioSamples);
+            decoder.getAudioView2(nbAudioSamples);
+            decoder.releaseAudio2(nbAudioSamples);
+        }
+
+        decoderTime += seconds(start);
+        decoder.getStats(stats);
+
+        // matched filter stage alone
+        DSDcc::DSDFilters filters;
+        start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < samples.size(); i += blockSize)
+        {
+            int nbSamples = std::min((std::size_t) blockSize, samples.size() - i);
+
+            if (benchMode.rate == DSDcc::DSDDecoder::DSDRate2400) {
+                filters.nxdn_filter(&samples[i], &filtered[0], nbSamples);
+            } else {
+                filters.dmr_filter(&samples[i], &filtered[0], nbSamples);
+            }
+        }
+
+        filterTime += seconds(start);
+    }
+
+    decoderTime /= nbRuns;
+    filterTime /= nbRuns;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("%s    {\n", first ? "" : ",\n");
+    printf("      \"file\": \"%s\",\n", fileName);
+    printf("      \"mode\": \"%s\",\n", benchMode.name);
+    printf("      \"runs\": %d,\n", nbRuns);
+    printf("      \"samples\": %zu,\n", samples.size());
+    printf("      \"symbols\": %lld,\n", nbSymbols);
+    printf("      \"dv_frames\": %lld,\n", nbFrames);
+    printf("      \"audio_frames\": %lld,\n", nbAudioFrames);
+    printf("      \"seconds\": %.6f,\n", decoderTime);
+    printf("      \"samples_per_sec\": %.0f,\n", samples.size() / decoderTime);
+    printf("      \"symbols_per_sec\": %.0f,\n", nbSymbols / decoderTime);
+    printf("      \"realtime_factor\": %.1f,\n", (samples.size() / 48000.0) / decoderTime);
+    printf("      \"stages\": {\n");
+    printf("        \"matched_filter\": %.6f,\n", filterTime);
+    printf("        \"decoder\": %.6f\n", decoderTime);
+    printf("      },\n");
+
+    if (stats.m_enabled) // cycles of the last run from the library instrumentation
+    {
+        printf("      \"cycles\": {\n");
+
+        for (int stage = 0; stage < DSDcc::DSDStatsSnapshot::StageCount; stage++)
+        {
+            printf("        \"%s\": { \"cycles\": %llu, \"events\": %llu }%s\n",
+                    DSDcc::DSDStatsSnapshot::getStageName((DSDcc::DSDStatsSnapshot::Stage) stage),
+                    (unsigned long long) stats.m_cycles[stage],
+                    (unsigned long long) stats.m_events[stage],
+                    stage == DSDcc::DSDStatsSnapshot::StageCount - 1 ? "" : ",");
+        }
+
+        printf("      },\n");
+    }
+
+    printf("      \"peak_rss_kb\": %ld\n", usage.ru_maxrss);
+    printf("    }");
+    first = false;
+}
+
+int main(int argc, char **argv)
+{
+    int nbRuns = 1;
+    int argIndex = 1;
+
+    if ((argc > 2) && (strcmp(argv[1], "-r") == 0))
+    {
+        nbRuns = atoi(argv[2]);
+        nbRuns = nbRuns < 1 ? 1 : nbRuns;
+        argIndex = 3;
+    }
+
+    if (argIndex >= argc)
+    {
+        fprintf(stderr, "Usage: %s [-r <runs>] file.dis...\n", argv[0]);
+        return 1;
+    }
+
+    bool first = true;
+    printf("{\n  \"results\": [\n");
+
+    for (; argIndex < argc; argIndex++)
+    {
+        std::vector<short> samples;
+
+        if (!loadSamples(argv[argIndex], samples))
+        {
+            fprintf(stderr, "Cannot read %s\n", argv[argIndex]);
+            continue;
+        }
+
+        for (unsigned int m = 0; m < sizeof(benchModes)/sizeof(benchModes[0]); m++)
+        {
+            if (matchPrefix(argv[argIndex], benchModes[m].prefix)) {
+                runBench(argv[argIndex], samples, benchModes[m], nbRuns, first);
+            }
+        }
+    }
+
+    printf("\n  ]\n}\n");
+    return 0;
+}
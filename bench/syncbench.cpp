@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+// Sync hunting cost per mode: correlates a random dibit stream against the sync pattern
+// subset a decoder configured in each mode searches for versus all the patterns.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <chrono>
+
+#include "dsd_decoder.h"
+#include "dsd_sync.h"
+
+struct BenchMode
+{
+    const char *name;
+    DSDcc::DSDDecoder::DSDDecodeMode mode;
+};
+
+static const BenchMode benchModes[] = {
+    {"Auto4800", DSDcc::DSDDecoder::DSDDecodeAuto},
+    {"DMR",      DSDcc::DSDDecoder::DSDDecodeDMR},
+    {"DStar",    DSDcc::DSDDecoder::DSDDecodeDStar},
+    {"P25P1",    DSDcc::DSDDecoder::DSDDecodeP25P1},
+    {"X2TDMA",   DSDcc::DSDDecoder::DSDDecodeX2TDMA},
+    {"YSF",      DSDcc::DSDDecoder::DSDDecodeYSF},
+    {"NXDN96",   DSDcc::DSDDecoder::DSDDecodeNXDN96},
+    {"NXDN48",   DSDcc::DSDDecoder::DSDDecodeNXDN48},
+    {"dPMR",     DSDcc::DSDDecoder::DSDDecodeDPMR},
+    {"ProVoice", DSDcc::DSDDecoder::DSDDecodeProVoice}
+};
+
+static const int nbSymbols = 1<<16;
+static const int nbRuns = 200;
+
+static double timeSync(const unsigned char *dibits, const DSDcc::DSDSync::SyncPattern *patterns, int nbPatterns, unsigned int& matches)
+{
+    DSDcc::DSDSync syncEngine;
+    uint64_t history = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (int run = 0; run < nbRuns; run++)
+    {
+        for (int i = 0; i < nbSymbols; i++)
+        {
+            DSDcc::DSDSync::pushDibit(history, dibits[i]);
+
+            if (patterns) {
+                syncEngine.matchSome(history, patterns, nbPatterns);
+            } else {
+                syncEngine.matchAll(history);
+            }
+
+            matches += syncEngine.isMatching(DSDcc::DSDSync::SyncDMRVoiceBS) ? 1 : 0;
+        }
+    }
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / ((double) nbSymbols * nbRuns);
+}
+
+int main()
+{
+    unsigned char *dibits = new unsigned char[nbSymbols];
+    unsigned int matches = 0;
+    srand(1);
+
+    for (int i = 0; i < nbSymbols; i++) {
+        dibits[i] = (rand() & 1) ? 1 : 3;
+    }
+
+    double allNs = timeSync(dibits, 0, DSDcc::DSDSync::m_patterns, matches);
+    printf("%-10s %2d patterns %6.2f ns/symbol\n", "All", DSDcc::DSDSync::m_patterns, allNs);
+
+    for (unsigned int m = 0; m < sizeof(benchModes)/sizeof(benchModes[0]); m++)
+    {
+        DSDcc::DSDDecoder decoder;
+        decoder.setQuiet();
+        decoder.setLogVerbosity(0);
+        decoder.setDecodeMode(DSDcc::DSDDecoder::DSDDecodeNone, true);
+        decoder.setDecodeMode(benchModes[m].mode, true);
+
+        int nbPatterns;
+        const DSDcc::DSDSync::SyncPattern *patterns = decoder.getSyncPatterns(nbPatterns);
+        double ns = timeSync(dibits, patterns, nbPatterns, matches);
+        printf("%-10s %2d patterns %6.2f ns/symbol (%.2fx)\n", benchModes[m].name, nbPatterns, ns, allNs / ns);
+    }
+
+    printf("(%u DMR voice matches)\n", matches);
+    delete[] dibits;
+    return 0;
+}
@@ -16,6 +16,9 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <vector>
+#include <mutex>
+
 #include "crc.h"
 
 namespace DSDcc
@@ -41,8 +44,11 @@ CRC::CRC(unsigned long polynomial,
 {
     m_crcmask = ((((unsigned long) 1 << (m_order - 1)) - 1) << 1) | 1;
     m_crchighbit = (unsigned long) 1 << (m_order - 1);
+    m_polyaligned = m_refin ? (uint32_t) reflect(m_poly, m_order) : (uint32_t) (m_poly << (32 - m_order));
 
-    generate_crc_table();
+    const Tables *tables = getTables();
+    m_crctab = tables->m_crctab;
+    m_crcslice = tables->m_crcslice;
     init();
 }
 
@@ -65,7 +71,33 @@ unsigned long CRC::reflect(unsigned long crc, int bitnum)
     return (crcout);
 }
 
-void CRC::generate_crc_table()
+const CRC::Tables *CRC::getTables()
+{
+    // tables are built once per process for each polynomial and kept until exit
+
+    static std::mutex mutex;
+    static std::vector<Tables*> tablesList;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (std::vector<Tables*>::const_iterator it = tablesList.begin(); it != tablesList.end(); ++it)
+    {
+        if (((*it)->m_poly == m_poly) && ((*it)->m_order == m_order) && ((*it)->m_refin == m_refin)) {
+            return *it;
+        }
+    }
+
+    Tables *tables = new Tables;
+    tables->m_poly = m_poly;
+    tables->m_order = m_order;
+    tables->m_refin = m_refin;
+    generate_crc_table(tables->m_crctab);
+    generate_slice_tables(tables->m_crcslice);
+    tablesList.push_back(tables);
+
+    return tables;
+}
+
+void CRC::generate_crc_table(unsigned long *crctab)
 {
     // make CRC lookup table used by table algorithms
 
@@ -93,7 +125,45 @@ void CRC::generate_crc_table()
         if (m_refin)
             crc = reflect(crc, m_order);
         crc &= m_crcmask;
-        m_crctab[i] = crc;
+        crctab[i] = crc;
+    }
+}
+
+void CRC::generate_slice_tables(uint32_t crcslice[8][256])
+{
+    // make the slicing-by-8 tables. The register is aligned to bit 31 so that any order up to 32 works
+    // or kept in the low bits when reflected.
+
+    int i, j, k;
+    uint32_t crc;
+
+    for (i = 0; i < 256; i++)
+    {
+        if (m_refin)
+        {
+            crc = i;
+
+            for (j = 0; j < 8; j++)
+                crc = (crc & 1) ? (crc >> 1) ^ m_polyaligned : crc >> 1;
+        }
+        else
+        {
+            crc = (uint32_t) i << 24;
+
+            for (j = 0; j < 8; j++)
+                crc = (crc & 0x80000000) ? (crc << 1) ^ m_polyaligned : crc << 1;
+        }
+
+        crcslice[0][i] = crc;
+    }
+
+    for (k = 1; k < 8; k++)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            crc = crcslice[k-1][i];
+            crcslice[k][i] = m_refin ? (crc >> 8) ^ crcslice[0][crc & 0xff] : (crc << 8) ^ crcslice[0][crc >> 24];
+        }
     }
 }
 
@@ -141,30 +211,106 @@ void CRC::init()
     }
 }
 
-unsigned long CRC::crctablefast(unsigned char* p, unsigned long len)
+uint32_t CRC::alignedInit()
 {
-    // fast lookup table algorithm without augmented zero bytes, e.g. used in pkzip.
-    // only usable with polynom orders of 8, 16, 24 or 32.
+    return m_refin ? (uint32_t) reflect(m_crcinit_direct, m_order) : (uint32_t) (m_crcinit_direct << (32 - m_order));
+}
 
-    unsigned long crc = m_crcinit_direct;
+unsigned long CRC::finalize(uint32_t aligned)
+{
+    unsigned long crc = m_refin ? aligned : aligned >> (32 - m_order);
 
-    if (m_refin)
+    if (m_refout ^ m_refin)
         crc = reflect(crc, m_order);
 
-    if (!m_refin)
+    crc ^= m_crcxor;
+    crc &= m_crcmask;
+
+    return (crc);
+}
+
+uint32_t CRC::sliceBytes(uint32_t crc, const unsigned char* p, unsigned long len) const
+{
+    // slicing-by-8: 8 table lookups for 8 bytes that do not depend on each other
+
+    if (m_refin)
+    {
+        for (; len >= 8; len -= 8, p += 8)
+        {
+            uint32_t a = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24));
+            crc = m_crcslice[7][a & 0xff] ^ m_crcslice[6][(a >> 8) & 0xff]
+                ^ m_crcslice[5][(a >> 16) & 0xff] ^ m_crcslice[4][a >> 24]
+                ^ m_crcslice[3][p[4]] ^ m_crcslice[2][p[5]]
+                ^ m_crcslice[1][p[6]] ^ m_crcslice[0][p[7]];
+        }
+
         while (len--)
-            crc = (crc << 8) ^ m_crctab[((crc >> (m_order - 8)) & 0xff) ^ *p++];
+            crc = (crc >> 8) ^ m_crcslice[0][(crc ^ *p++) & 0xff];
+    }
     else
+    {
+        for (; len >= 8; len -= 8, p += 8)
+        {
+            uint32_t a = crc ^ (((uint32_t) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]);
+            crc = m_crcslice[7][a >> 24] ^ m_crcslice[6][(a >> 16) & 0xff]
+                ^ m_crcslice[5][(a >> 8) & 0xff] ^ m_crcslice[4][a & 0xff]
+                ^ m_crcslice[3][p[4]] ^ m_crcslice[2][p[5]]
+                ^ m_crcslice[1][p[6]] ^ m_crcslice[0][p[7]];
+        }
+
         while (len--)
-            crc = (crc >> 8) ^ m_crctab[(crc & 0xff) ^ *p++];
+            crc = (crc << 8) ^ m_crcslice[0][(crc >> 24) ^ *p++];
+    }
 
-    if (m_refout ^ m_refin)
-        crc = reflect(crc, m_order);
+    return crc;
+}
 
-    crc ^= m_crcxor;
-    crc &= m_crcmask;
+unsigned long CRC::crctablefast(const unsigned char* p, unsigned long len)
+{
+    // fast lookup table algorithm without augmented zero bytes, e.g. used in pkzip.
+    // slicing-by-8 usable with polynom orders between 1...32.
 
-    return (crc);
+    return finalize(sliceBytes(alignedInit(), p, len));
+}
+
+unsigned long CRC::crcbits(const unsigned char* bits, unsigned long nbBits)
+{
+    // whole bytes are packed in processing order and go through the tables
+
+    uint32_t crc = alignedInit();
+    unsigned char bytes[8];
+
+    while (nbBits >= 8)
+    {
+        unsigned long nbBytes = nbBits/8 < 8 ? nbBits/8 : 8;
+
+        for (unsigned long i = 0; i < nbBytes; i++, bits += 8)
+        {
+            bytes[i] = 0;
+
+            for (int j = 0; j < 8; j++)
+                bytes[i] |= (bits[j] & 1) << (m_refin ? j : 7 - j);
+        }
+
+        crc = sliceBytes(crc, bytes, nbBytes);
+        nbBits -= 8*nbBytes;
+    }
+
+    for (; nbBits; nbBits--, bits++) // remaining bits one by one
+    {
+        if (m_refin)
+        {
+            crc ^= *bits & 1;
+            crc = (crc & 1) ? (crc >> 1) ^ m_polyaligned : crc >> 1;
+        }
+        else
+        {
+            crc ^= (uint32_t) (*bits & 1) << 31;
+            crc = (crc & 0x80000000) ? (crc << 1) ^ m_polyaligned : crc << 1;
+        }
+    }
+
+    return finalize(crc);
 }
 
 unsigned long CRC::crctable(unsigned char* p, unsigned long len)
@@ -286,40 +432,17 @@ unsigned long CRC::crcbitbybitfast(unsigned char* p, unsigned long len)
 
 // ====================================================================
 
-DStarCRC::DStarCRC() : crc(0)
+DStarCRC::DStarCRC() :
+        m_crc(CRC::PolyCCITT16, 16, 0xffff, 0xffff, 1, 1, 1),
+        crc(0)
 {}
 
 DStarCRC::~DStarCRC()
 {}
 
-void DStarCRC::fcsbit(unsigned char tbyte)
-{
-	  crc ^= tbyte;
-
-	  if (crc & 1)
-	  {
-		    crc = (crc >> 1) ^ 0x8408;  // X-modem CRC poly
-	  }
-	  else
-	  {
-		    crc = crc >> 1;
-	  }
-}
-
-
 void DStarCRC::compute_crc(unsigned char *array, int size_buffer)
 {
-	crc = 0xffff;
-
-	for (int n = 0; n < (size_buffer - 2); n++)
-	{
-		for (int m = 0; m < 8; m++)
-		{    //each bit must be calculated separately
-			fcsbit(bitRead(array[n], m));
-		}
-	}
-
-	crc ^= 0xffff;
+	crc = m_crc.crctablefast(array, size_buffer - 2); // bits LSB first with 0x8408 i.e. reflected 0x1021
 }
 
 
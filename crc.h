@@ -19,6 +19,8 @@
 #ifndef CRC_H_
 #define CRC_H_
 
+#include <stdint.h>
+
 #include "export.h"
 
 namespace DSDcc
@@ -76,9 +78,14 @@ public:
     unsigned long crctable(unsigned char* p, unsigned long len);
 
     /** fast lookup table algorithm without augmented zero bytes, e.g. used in pkzip.
-    * only usable with polynomial orders of 8, 16, 24 or 32.
+    * processes 8 bytes per iteration with slicing-by-8 tables, suited for polynomial orders between 1...32.
+    */
+    unsigned long crctablefast(const unsigned char* p, unsigned long len);
+
+    /** same as crctablefast on a bit array with one bit per byte in transmission order.
+    * the number of bits needs not be a multiple of 8.
     */
-    unsigned long crctablefast(unsigned char* p, unsigned long len);
+    unsigned long crcbits(const unsigned char* bits, unsigned long nbBits);
 
     /** bit by bit algorithm with augmented zero bytes.
     * does not use lookup table, suited for polynomial orders between 1...32.
@@ -94,9 +101,23 @@ public:
     static const unsigned long PolyDStar16;
 
 private:
+    struct Tables //!< lookup tables shared by the CRC objects with the same polynomial, order and input reflection
+    {
+        unsigned long m_poly;
+        unsigned int  m_order;
+        int           m_refin;
+        unsigned long m_crctab[256];
+        uint32_t      m_crcslice[8][256];
+    };
+
     unsigned long reflect(unsigned long crc, int bitnum);
-    void generate_crc_table();
+    const Tables *getTables();
+    void generate_crc_table(unsigned long *crctab);
+    void generate_slice_tables(uint32_t crcslice[8][256]);
     void init();
+    uint32_t sliceBytes(uint32_t crc, const unsigned char* p, unsigned long len) const;
+    uint32_t alignedInit();
+    unsigned long finalize(uint32_t crc);
 
     unsigned int  m_order;   //!< CRC order (# bits) or polynomial order
     unsigned long m_poly;    //!< Polynomial in binary form with implicit order ex: X^16+X^12+X^5+1 -> (1)0001 0000 0010 0001 = 0x1021
@@ -110,7 +131,9 @@ private:
     unsigned long m_crchighbit;
     unsigned long m_crcinit_direct;
     unsigned long m_crcinit_nondirect;
-    unsigned long m_crctab[256];
+    const unsigned long *m_crctab;
+    const uint32_t (*m_crcslice)[256]; //!< slicing-by-8 tables with the register aligned to bit 31 (bit 0 if reflected)
+    uint32_t      m_polyaligned;      //!< polynomial aligned like the register
 };
 
 /* D-Star specific CRC16 calculation. It is so weird that I just copied it from:
@@ -127,10 +150,9 @@ public:
 	bool check_crc(unsigned char *array, int size_buffer, unsigned int crcVlaue);
 
 private:
-	unsigned char bitRead(unsigned char value, unsigned int bit) { return (((value) >> (bit)) & 0x01); }
-	void fcsbit(unsigned char tbyte);
 	void compute_crc(unsigned char *array, int size_buffer);
 
+	CRC m_crc; //!< reflected CCITT16 (X.25) that is what the bit by bit original was doing
 	unsigned int crc;
 };
 
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <vector>
+#include <mutex>
+
+#include "deinterleave.h"
+
+namespace DSDcc
+{
+
+/*
+ * AMBE interleave schedule. Position row*24 + column in the AMBE frame
+ * of bit 1 then bit 0 of each of the 36 dibits.
+ */
+const int Deinterleaver::AMBE3600x2450[72] = {
+    23,  5, 34, 51, 22,  4, 33, 50, 21,  3, 32, 49,
+    20,  2, 31, 48, 19,  1, 30, 85, 18,  0, 29, 84,
+    17, 46, 28, 83, 16, 45, 27, 82, 15, 44, 26, 81,
+    14, 43, 25, 80, 13, 42, 24, 79, 12, 41, 58, 78,
+    11, 40, 57, 77, 10, 39, 56, 76,  9, 38, 55, 75,
+     8, 37, 54, 74,  7, 36, 53, 73,  6, 35, 52, 72,
+};
+
+Deinterleaver::Deinterleaver(const int *schedule, unsigned int nbInBits, unsigned int nbOutBits)
+{
+    int16_t positions[MAX_BITS];
+
+    for (unsigned int i = 0; i < nbInBits; i++) {
+        positions[i] = schedule[i];
+    }
+
+    init(positions, nbInBits, nbOutBits);
+}
+
+Deinterleaver::Deinterleaver(const int *rows, const int *cols, unsigned int rowLength, unsigned int nbInBits, unsigned int nbOutBits)
+{
+    int16_t positions[MAX_BITS];
+
+    for (unsigned int i = 0; i < nbInBits; i++) {
+        positions[i] = rows[i]*rowLength + cols[i];
+    }
+
+    init(positions, nbInBits, nbOutBits);
+}
+
+Deinterleaver::~Deinterleaver()
+{
+}
+
+void Deinterleaver::init(const int16_t *schedule, unsigned int nbInBits, unsigned int nbOutBits)
+{
+    memset(m_burst, 0, nbInBits);
+    m_tables = getTables(schedule, nbInBits, nbOutBits);
+}
+
+const Deinterleaver::Tables *Deinterleaver::getTables(const int16_t *schedule, unsigned int nbInBits, unsigned int nbOutBits)
+{
+    // tables are built once per process for each schedule and kept until exit
+
+    static std::mutex mutex;
+    static std::vector<Tables*> tablesList;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (std::vector<Tables*>::const_iterator it = tablesList.begin(); it != tablesList.end(); ++it)
+    {
+        if (((*it)->m_nbInBits == nbInBits) && ((*it)->m_nbOutBits == nbOutBits)
+            && (memcmp((*it)->m_schedule, schedule, nbInBits * sizeof(int16_t)) == 0)) {
+            return *it;
+        }
+    }
+
+    Tables *tables = new Tables;
+    tables->m_nbInBits = nbInBits;
+    tables->m_nbOutBits = nbOutBits;
+    memcpy(tables->m_schedule, schedule, nbInBits * sizeof(int16_t));
+    memset(tables->m_source, 0xFF, sizeof(tables->m_source));
+
+    for (unsigned int i = 0; i < nbInBits; i++) {
+        tables->m_source[schedule[i]] = i;
+    }
+
+    tables->m_nbGather = 0;
+
+    for (unsigned int i = 0; i < nbOutBits; i++)
+    {
+        if (tables->m_source[i] >= 0)
+        {
+            tables->m_gatherOut[tables->m_nbGather] = i;
+            tables->m_gatherIn[tables->m_nbGather] = tables->m_source[i];
+            tables->m_nbGather++;
+        }
+    }
+
+    tablesList.push_back(tables);
+
+    return tables;
+}
+
+void Deinterleaver::getBits(unsigned char *bits, const unsigned char *whitening) const
+{
+    const unsigned char *gatherOut = m_tables->m_gatherOut;
+    const unsigned char *gatherIn = m_tables->m_gatherIn;
+
+    if (whitening)
+    {
+        for (unsigned int i = 0; i < m_tables->m_nbGather; i++) {
+            bits[gatherOut[i]] = m_burst[gatherIn[i]] ^ whitening[gatherOut[i]];
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < m_tables->m_nbGather; i++) {
+            bits[gatherOut[i]] = m_burst[gatherIn[i]];
+        }
+    }
+}
+
+uint32_t Deinterleaver::getCodeword(unsigned int start, unsigned int nbBits) const
+{
+    uint32_t codeword = 0;
+
+    for (unsigned int i = start; i < start + nbBits; i++) {
+        codeword = (codeword << 1) | (m_tables->m_source[i] < 0 ? 0 : m_burst[m_tables->m_source[i]]);
+    }
+
+    return codeword;
+}
+
+} // namespace DSDcc
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DEINTERLEAVE_H_
+#define DEINTERLEAVE_H_
+
+#include <stdint.h>
+
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Burst de-interleaver. The bits of a burst are stored in arrival order as the symbols come in
+ * and the permutation is applied in one pass at the end of the burst using a gather table
+ * generated from the interleave schedule at construction time.
+ */
+class DSDCC_API Deinterleaver
+{
+public:
+    /** The schedule gives for each received bit its position in the de-interleaved output */
+    Deinterleaver(const int *schedule, unsigned int nbInBits, unsigned int nbOutBits);
+    /** The schedule gives for each received bit its row and column in the de-interleaved output */
+    Deinterleaver(const int *rows, const int *cols, unsigned int rowLength, unsigned int nbInBits, unsigned int nbOutBits);
+    ~Deinterleaver();
+
+    /** Store the dibit at index in the burst. Bit 1 comes first. */
+    void pushDibit(unsigned int index, unsigned char dibit)
+    {
+        m_burst[2*index]     = (dibit >> 1) & 1;
+        m_burst[2*index + 1] = dibit & 1;
+    }
+
+    /** Store the bit at index in the burst */
+    void pushBit(unsigned int index, unsigned char bit)
+    {
+        m_burst[index] = bit & 1;
+    }
+
+    /** De-interleave the burst into bits. Output positions not in the schedule are left untouched.
+     *  When given the whitening sequence is xored with the output bits in the same pass. */
+    void getBits(unsigned char *bits, const unsigned char *whitening = 0) const;
+
+    /** De-interleaved bits from start to start+nbBits-1 packed in a codeword with its first bit as MSB */
+    uint32_t getCodeword(unsigned int start, unsigned int nbBits) const;
+
+    static const unsigned int MAX_BITS = 144U;
+    static const int AMBE3600x2450[72]; //!< AMBE+2 frame as used by DMR, dPMR, NXDN and YSF V/D mode 1 into 4 rows of 24 bits
+
+private:
+    struct Tables //!< gather tables shared by the de-interleavers with the same schedule
+    {
+        unsigned int  m_nbInBits;
+        unsigned int  m_nbOutBits;
+        int16_t       m_schedule[MAX_BITS];  //!< output position of each received bit
+        unsigned int  m_nbGather;
+        int16_t       m_source[MAX_BITS];    //!< index in the burst of each output bit or -1 if not in the schedule
+        unsigned char m_gatherOut[MAX_BITS]; //!< output positions in the schedule in increasing order
+        unsigned char m_gatherIn[MAX_BITS];  //!< corresponding indexes in the burst
+    };
+
+    void init(const int16_t *schedule, unsigned int nbInBits, unsigned int nbOutBits);
+    static const Tables *getTables(const int16_t *schedule, unsigned int nbInBits, unsigned int nbOutBits);
+
+    unsigned char m_burst[MAX_BITS]; //!< received bits in arrival order
+    const Tables *m_tables;
+};
+
+} // namespace DSDcc
+
+#endif /* DEINTERLEAVE_H_ */
@@ -354,6 +354,20 @@ void Descramble::scramble (unsigned char *in, unsigned char *out)
     }; // end for
 }
 
+void Descramble::scrambleSoft (const unsigned char *in, unsigned char *out)
+{
+    int m_count = 0;
+
+    for (int loop = 0; loop < 660; loop++)
+    {
+        out[loop] = SCRAMBLER_TABLE_BITS[m_count++] ? 255 - in[loop] : in[loop];
+
+        if (m_count >= SCRAMBLER_TABLE_BITS_LENGTH) {
+            m_count = 0U;
+        }
+    }
+}
+
 } // namespace DSDcc
 
 
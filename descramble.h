@@ -26,6 +26,7 @@ class DSDCC_API Descramble
 {
 public:
     static void scramble (unsigned char *in, unsigned char *out);
+    static void scrambleSoft (const unsigned char *in, unsigned char *out); //!< same on soft bits (0..255)
     static void deinterleave (unsigned char *in, unsigned char *out);
     static int FECdecoder (unsigned char *in, unsigned char *out);
 
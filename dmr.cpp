@@ -58,47 +58,6 @@ const char *DSDDMR::m_slotTypeText[DMR_TYPES_COUNT] = {
         "USB"
 };
 
-/*
- * DMR AMBE interleave schedule
- */
-// bit 1
-const int DSDDMR::rW[36] = {
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 2,
-  0, 2, 0, 2, 0, 2,
-  0, 2, 0, 2, 0, 2
-};
-
-const int DSDDMR::rX[36] = {
-  23, 10, 22, 9, 21, 8,
-  20, 7, 19, 6, 18, 5,
-  17, 4, 16, 3, 15, 2,
-  14, 1, 13, 0, 12, 10,
-  11, 9, 10, 8, 9, 7,
-  8, 6, 7, 5, 6, 4
-};
-
-// bit 0
-const int DSDDMR::rY[36] = {
-  0, 2, 0, 2, 0, 2,
-  0, 2, 0, 3, 0, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3
-};
-
-const int DSDDMR::rZ[36] = {
-  5, 3, 4, 2, 3, 1,
-  2, 0, 1, 13, 0, 12,
-  22, 11, 21, 10, 20, 9,
-  19, 8, 18, 7, 17, 6,
-  16, 5, 15, 4, 14, 3,
-  13, 2, 12, 1, 11, 0
-};
-
 // MotoTRBO algo only. Hytera don`t use hardcoded keys
 const unsigned short DSDDMR::BasicPrivacyKeys[DMR_BP_KEYS_COUNT] = {
   0x1F00, 0xE300, 0xFC00, 0x2503, 0x3A03, 0xC603, 0xD903, 0x4A05, 0x5505, 0xA905,
@@ -146,20 +105,17 @@ DSDDMR::DSDDMR(DSDDecoder *dsdDecoder) :
         m_voice2EmbSig_dibitsIndex(0),
         m_voice2EmbSig_OK(false),
         m_voice1FrameCount(DMR_VOX_SUPERFRAME_LEN),
-        m_voice2FrameCount(DMR_VOX_SUPERFRAME_LEN)
+        m_voice2FrameCount(DMR_VOX_SUPERFRAME_LEN),
+        m_ambeDeinterleaver(Deinterleaver::AMBE3600x2450, 72, 96),
+        m_cachDeinterleaver(m_cachInterleave, 24, 24),
+        m_voice1EmbSigDeinterleaver(m_embSigInterleave, 128, 128),
+        m_voice2EmbSigDeinterleaver(m_embSigInterleave, 128, 128)
 {
     m_slotText = m_dsdDecoder->m_state.slot0light;
-    w = 0;
-    x = 0;
-    y = 0;
-    z = 0;
 
     memset(m_slotTypePDU_dibits, 0, 10);
-    memset(m_cachBits, 0, 24);
     memset(m_emb_dibits, 0, 8);
     memset(m_voiceEmbSig_dibits, 0, 16);
-    memset(m_voice1EmbSigRawBits, 0, 16*8);
-    memset(m_voice2EmbSigRawBits, 0, 16*8);
     memset(m_syncDibits, 0, 24);
     memset(m_mbeDVFrame, 0, 9);
 }
@@ -405,7 +361,7 @@ void DSDDMR::processSyncOrSkip()
     if (m_symbolIndex > sync_db_size) // accumulate enough symbols to look for a sync
     {
         DSDSync syncEngine;
-        syncEngine.matchSome(m_dsdDecoder->m_dsdSymbol.getSyncDibitBack(sync_db_size), sync_db_size, patterns, 2);
+        syncEngine.matchSome(m_dsdDecoder->m_dsdSymbol.getSyncDibitRegister(), patterns, 2);
 
         if (syncEngine.isMatching(DSDSync::SyncDMRDataBS))
         {
@@ -575,12 +531,11 @@ void DSDDMR::processDataDibit(unsigned char dibit)
     {
         if (m_burstType == DSDDMRBaseStation)
         {
-            m_cachBits[m_cachInterleave[2*m_symbolIndex]]   = (dibit >> 1) & 1;
-            m_cachBits[m_cachInterleave[2*m_symbolIndex+1]] = dibit & 1;
+            m_cachDeinterleaver.pushDibit(m_symbolIndex, dibit);
 
             if(m_symbolIndex == nextPartOff-1)
             {
-                decodeCACH(m_cachBits);
+                decodeCACH();
 
     //            std::cerr << "DSDDMR::processDataDibit: start frame:"
     //                    << " slot: " << (int) m_slot
@@ -673,12 +628,11 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
     {
         if (m_burstType == DSDDMRBaseStation)
         {
-            m_cachBits[m_cachInterleave[2*m_symbolIndex]]   = (dibit >> 1) & 1;
-            m_cachBits[m_cachInterleave[2*m_symbolIndex+1]] = dibit & 1;
+            m_cachDeinterleaver.pushDibit(m_symbolIndex, dibit);
 
             if(m_symbolIndex == nextPartOff-1)
             {
-                decodeCACH(m_cachBits);
+                decodeCACH();
 
                 if (m_cachOK)
                 {
@@ -707,11 +661,6 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
 
         if (mbeIndex == 0)
         {
-            w = rW;
-            x = rX;
-            y = rY;
-            z = rZ;
-
             if (m_slot == DSDDMRSlot1) {
                 memset((void *) m_dsdDecoder->m_mbeDVFrame1, 0, IN_BYTES(DMR_VOCODER_FRAME_LEN)); // initialize DVSI frame 1
             } else {
@@ -721,12 +670,7 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
 
         BasicPrivacyXOR(&dibit, mbeIndex);
 
-        m_dsdDecoder->ambe_fr[*w][*x] = (1 & (dibit >> 1)); // bit 1
-        m_dsdDecoder->ambe_fr[*y][*z] = (1 & dibit);        // bit 0
-        w++;
-        x++;
-        y++;
-        z++;
+        m_ambeDeinterleaver.pushDibit(mbeIndex, dibit);
 
         if (m_slot == DSDDMRSlot1) {
             storeSymbolDV(m_dsdDecoder->m_mbeDVFrame1, mbeIndex, dibit); // store dibit for DVSI hardware decoder
@@ -736,6 +680,8 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
 
         if (mbeIndex == IN_DIBITS(DMR_VOCODER_FRAME_LEN) - 1)
         {
+            m_ambeDeinterleaver.getBits((unsigned char *) m_dsdDecoder->ambe_fr);
+
             if (m_slot == DSDDMRSlot1)
             {
                 m_dsdDecoder->m_mbeDecoder1.processFrame(0, m_dsdDecoder->ambe_fr, 0);
@@ -759,22 +705,12 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
 
         if (mbeIndex == 0)
         {
-            w = rW;
-            x = rX;
-            y = rY;
-            z = rZ;
-
             memset((void *) m_mbeDVFrame, 0, IN_BYTES(DMR_VOCODER_FRAME_LEN)); // initialize DVSI frame
         }
 
         BasicPrivacyXOR(&dibit, mbeIndex);
 
-        m_dsdDecoder->ambe_fr[*w][*x] = (1 & (dibit >> 1)); // bit 1
-        m_dsdDecoder->ambe_fr[*y][*z] = (1 & dibit);        // bit 0
-        w++;
-        x++;
-        y++;
-        z++;
+        m_ambeDeinterleaver.pushDibit(mbeIndex, dibit);
 
         storeSymbolDV(m_mbeDVFrame, mbeIndex, dibit); // store dibit for DVSI hardware decoder
         return;
@@ -811,7 +747,7 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
             {
                 if (processEMB())
                 {
-                    if (processVoiceEmbeddedSignalling(m_voice1EmbSig_dibitsIndex, m_voice1EmbSigRawBits, m_voice1EmbSig_OK, m_slot1Addresses))
+                    if (processVoiceEmbeddedSignalling(m_voice1EmbSig_dibitsIndex, m_voice1EmbSigDeinterleaver, m_voice1EmbSig_OK, m_slot1Addresses))
                     {
                         textVoiceEmbeddedSignalling(m_slot1Addresses, m_dsdDecoder->m_state.slot0light);
 //                        std::cerr << "DSDDMR::processVoiceDibit: "
@@ -825,7 +761,7 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
             {
                 if (processEMB())
                 {
-                    if (processVoiceEmbeddedSignalling(m_voice2EmbSig_dibitsIndex, m_voice2EmbSigRawBits, m_voice2EmbSig_OK, m_slot2Addresses))
+                    if (processVoiceEmbeddedSignalling(m_voice2EmbSig_dibitsIndex, m_voice2EmbSigDeinterleaver, m_voice2EmbSig_OK, m_slot2Addresses))
                     {
                         textVoiceEmbeddedSignalling(m_slot2Addresses, m_dsdDecoder->m_state.slot1light);
 //                        std::cerr << "DSDDMR::processVoiceDibit: "
@@ -848,17 +784,14 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
 
         BasicPrivacyXOR(&dibit, mbeIndex);
 
-        m_dsdDecoder->ambe_fr[*w][*x] = (1 & (dibit >> 1)); // bit 1
-        m_dsdDecoder->ambe_fr[*y][*z] = (1 & dibit);        // bit 0
-        w++;
-        x++;
-        y++;
-        z++;
+        m_ambeDeinterleaver.pushDibit(mbeIndex, dibit);
 
         storeSymbolDV(m_mbeDVFrame, mbeIndex, dibit); // store dibit for DVSI hardware decoder
 
         if (mbeIndex == IN_DIBITS(DMR_VOCODER_FRAME_LEN) - 1)
         {
+            m_ambeDeinterleaver.getBits((unsigned char *) m_dsdDecoder->ambe_fr);
+
             if (m_slot == DSDDMRSlot1)
             {
                 m_dsdDecoder->m_mbeDecoder1.processFrame(0, m_dsdDecoder->ambe_fr, 0);
@@ -886,11 +819,6 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
 
         if (mbeIndex == 0)
         {
-            w = rW;
-            x = rX;
-            y = rY;
-            z = rZ;
-
             if (m_slot == DSDDMRSlot1) {
                 memset((void *) m_dsdDecoder->m_mbeDVFrame1, 0, IN_BYTES(DMR_VOCODER_FRAME_LEN)); // initialize DVSI frame 1
             } else {
@@ -898,12 +826,7 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
             }
         }
 
-        m_dsdDecoder->ambe_fr[*w][*x] = (1 & (dibit >> 1)); // bit 1
-        m_dsdDecoder->ambe_fr[*y][*z] = (1 & dibit);        // bit 0
-        w++;
-        x++;
-        y++;
-        z++;
+        m_ambeDeinterleaver.pushDibit(mbeIndex, dibit);
 
         if (m_slot == DSDDMRSlot1) {
             storeSymbolDV(m_dsdDecoder->m_mbeDVFrame1, mbeIndex, dibit); // store dibit for DVSI hardware decoder
@@ -913,6 +836,8 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
 
         if (mbeIndex == IN_DIBITS(DMR_VOCODER_FRAME_LEN) - 1)
         {
+            m_ambeDeinterleaver.getBits((unsigned char *) m_dsdDecoder->ambe_fr);
+
             if (m_slot == DSDDMRSlot1)
             {
                 m_dsdDecoder->m_mbeDecoder1.processFrame(0, m_dsdDecoder->ambe_fr, 0);
@@ -928,7 +853,7 @@ void DSDDMR::processVoiceDibit(unsigned char dibit)
     }
 }
 
-void DSDDMR::decodeCACH(unsigned char *cachBits)
+void DSDDMR::decodeCACH()
 {
     m_cachOK = true;
 
@@ -943,25 +868,27 @@ void DSDDMR::decodeCACH(unsigned char *cachBits)
     }
     else
     {
-        // Hamming (7,4) decode and store results if successful
-        if (m_hamming_7_4.decode(cachBits)) // positive CACH information
+        // Hamming (7,4) decode of the TACT and store results if successful
+        uint16_t tact;
+
+        if (m_hamming_7_4.decode(m_cachDeinterleaver.getCodeword(0, 7), tact)) // positive CACH information
         {
-            unsigned int slotIndex = cachBits[1] & 1;
+            unsigned int slotIndex = (tact >> 2) & 1;
             m_dsdDecoder->m_state.currentslot = slotIndex; // FIXME: remove this when done with new voice processing
 
             if (slotIndex)
             {
                 m_slotText = m_dsdDecoder->m_state.slot1light;
-                m_dsdDecoder->m_state.slot0light[0] = ((cachBits[0] & 1) ? '*' : '.'); // the activity indicator is shifted by one slot
+                m_dsdDecoder->m_state.slot0light[0] = (((tact >> 3) & 1) ? '*' : '.'); // the activity indicator is shifted by one slot
             }
             else
             {
                 m_slotText = m_dsdDecoder->m_state.slot0light;
-                m_dsdDecoder->m_state.slot1light[0] = ((cachBits[0] & 1) ? '*' : '.'); // the activity indicator is shifted by one slot
+                m_dsdDecoder->m_state.slot1light[0] = (((tact >> 3) & 1) ? '*' : '.'); // the activity indicator is shifted by one slot
             }
 
             m_slot = (DSDDMRSlot) slotIndex;
-            m_lcss = 2*cachBits[2] + cachBits[3];
+            m_lcss = tact & 3;
 
 //            std::cerr << "DSDDMR::decodeCACH: cach: " << " OK: at: " << m_cachSymbolIndex << " Slot: " << (int) cachBits[1] << " LCSS: " << (int) m_lcss << std::endl;
 
@@ -978,20 +905,19 @@ void DSDDMR::decodeCACH(unsigned char *cachBits)
 
 void DSDDMR::processSlotTypePDU()
 {
-    unsigned char slotTypeBits[DMR_SLOT_TYPE_PART_LEN * 2];
+    uint32_t slotType = 0; // Golay (20,8) codeword with its first bit as MSB
+    uint16_t slotTypeData;
 
-    for (int i = 0; i < DMR_SLOT_TYPE_PART_LEN; i++)
-    {
-        slotTypeBits[2*i]     = (m_slotTypePDU_dibits[i] >> 1) & 1;
-        slotTypeBits[2*i + 1] = m_slotTypePDU_dibits[i] & 1;
+    for (int i = 0; i < DMR_SLOT_TYPE_PART_LEN; i++) {
+        slotType = (slotType << 2) | (m_slotTypePDU_dibits[i] & 3);
     }
 
-    if (m_golay_20_8.decode(slotTypeBits))
+    if (m_golay_20_8.decode(slotType, slotTypeData))
     {
-        m_colorCode = (slotTypeBits[0] << 3) + (slotTypeBits[1] << 2) + (slotTypeBits[2] << 1) + slotTypeBits[3];
+        m_colorCode = (slotTypeData >> 4) & 0x0F;
         sprintf(&m_slotText[1], "%02d ", m_colorCode);
 
-        unsigned int dataType = (slotTypeBits[4] << 3) + (slotTypeBits[5] << 2) + (slotTypeBits[6] << 1) + slotTypeBits[7];
+        unsigned int dataType = slotTypeData & 0x0F;
 
         if (dataType >= DMR_TYPES_COUNT)
         {
@@ -1015,20 +941,19 @@ void DSDDMR::processSlotTypePDU()
 
 bool DSDDMR::processEMB()
 {
-    unsigned char embBits[DMR_EMB_PART_LEN * 2];
+    uint32_t emb = 0; // QR (16,7,6) codeword with its first bit as MSB
+    uint16_t embData; // CC(4) PI(1) LCSS(2)
 
-    for (int i = 0; i < DMR_EMB_PART_LEN; i++)
-    {
-        embBits[2*i]     = (m_emb_dibits[i] >> 1) & 1;
-        embBits[2*i + 1] = m_emb_dibits[i] & 1;
+    for (int i = 0; i < DMR_EMB_PART_LEN; i++) {
+        emb = (emb << 2) | (m_emb_dibits[i] & 3);
     }
 
-    if (m_qr_16_7_6.decode(embBits))
+    if (m_qr_16_7_6.decode(emb, embData))
     {
-        m_colorCode = (embBits[0] << 3) + (embBits[1] << 2) + (embBits[2] << 1) + embBits[3];
+        m_colorCode = (embData >> 3) & 0x0F;
         sprintf(&m_slotText[1], "%02d", m_colorCode);
         m_slotText[3] = ' ';
-        m_lcss = (embBits[5] << 1) + embBits[6];
+        m_lcss = embData & 3;
         return true;
     }
     else
@@ -1038,7 +963,7 @@ bool DSDDMR::processEMB()
 }
 
 bool DSDDMR::processVoiceEmbeddedSignalling(int& voiceEmbSig_dibitsIndex,
-        unsigned char *voiceEmbSigRawBits,
+        Deinterleaver& voiceEmbSigDeinterleaver,
         bool& voiceEmbSig_OK,
         DMRAddresses& addresses)
 {
@@ -1052,18 +977,14 @@ bool DSDDMR::processVoiceEmbeddedSignalling(int& voiceEmbSig_dibitsIndex,
                 break;
             }
 
-            int bit1Index = m_embSigInterleave[2*voiceEmbSig_dibitsIndex];
-            int bit0Index = m_embSigInterleave[2*voiceEmbSig_dibitsIndex + 1];
-
             if ((i%4) == 0)
             {
                 parityCheck = 0;
             }
 
-            voiceEmbSigRawBits[bit1Index] = (1 & (m_voiceEmbSig_dibits[i] >> 1)); // bit 1
-            voiceEmbSigRawBits[bit0Index] = (1 & m_voiceEmbSig_dibits[i]);        // bit 0
-            parityCheck ^= voiceEmbSigRawBits[bit1Index];
-            parityCheck ^= voiceEmbSigRawBits[bit0Index];
+            voiceEmbSigDeinterleaver.pushDibit(voiceEmbSig_dibitsIndex, m_voiceEmbSig_dibits[i]);
+            parityCheck ^= (m_voiceEmbSig_dibits[i] >> 1) & 1; // bit 1
+            parityCheck ^= m_voiceEmbSig_dibits[i] & 1;        // bit 0
 
             if ((i%4) == 3)
             {
@@ -1079,63 +1000,23 @@ bool DSDDMR::processVoiceEmbeddedSignalling(int& voiceEmbSig_dibitsIndex,
 
         if (voiceEmbSig_dibitsIndex == 16*4) // BPTC matrix collected
         {
-            if (m_hamming_16_11_4.decode(voiceEmbSigRawBits, 0, 7)) // TODO: 5 bit checksum
+            uint32_t rows[7]; // the 7 rows of the BPTC matrix carrying the LC. The last row is column parity.
+            uint16_t lc[7];   // 11 information bits of each row
+
+            for (int r = 0; r < 7; r++) {
+                rows[r] = voiceEmbSigDeinterleaver.getCodeword(16*r, 16);
+            }
+
+            if (m_hamming_16_11_4.decodeBatch(rows, lc, 7)) // TODO: 5 bit checksum
             {
-                unsigned char flco = (voiceEmbSigRawBits[2] << 5)
-                        + (voiceEmbSigRawBits[3] << 4)
-                        + (voiceEmbSigRawBits[4] << 3)
-                        + (voiceEmbSigRawBits[5] << 2)
-                        + (voiceEmbSigRawBits[6] << 1)
-                        + (voiceEmbSigRawBits[7]);
+                unsigned char flco = (lc[0] >> 3) & 0x3F;
                 addresses.m_group = (flco == 0);
-                addresses.m_target = (voiceEmbSigRawBits[16*2 + 2] << 23) // (LC47)
-                        + (voiceEmbSigRawBits[16*2 + 3] << 22)
-                        + (voiceEmbSigRawBits[16*2 + 4] << 21)
-                        + (voiceEmbSigRawBits[16*2 + 5] << 20)
-                        + (voiceEmbSigRawBits[16*2 + 6] << 19)
-                        + (voiceEmbSigRawBits[16*2 + 7] << 18)
-                        + (voiceEmbSigRawBits[16*2 + 8] << 17)
-                        + (voiceEmbSigRawBits[16*2 + 9] << 16) // 2:7
-                        + (voiceEmbSigRawBits[16*3 + 0] << 15) // (LC39)
-                        + (voiceEmbSigRawBits[16*3 + 1] << 14)
-                        + (voiceEmbSigRawBits[16*3 + 2] << 13)
-                        + (voiceEmbSigRawBits[16*3 + 3] << 12)
-                        + (voiceEmbSigRawBits[16*3 + 4] << 11)
-                        + (voiceEmbSigRawBits[16*3 + 5] << 10)
-                        + (voiceEmbSigRawBits[16*3 + 6] << 9)
-                        + (voiceEmbSigRawBits[16*3 + 7] << 8)  // 1:7
-                        + (voiceEmbSigRawBits[16*3 + 8] << 7)  // (LC31)
-                        + (voiceEmbSigRawBits[16*3 + 9] << 6)
-                        + (voiceEmbSigRawBits[16*4 + 0] << 5)  // (LC29)
-                        + (voiceEmbSigRawBits[16*4 + 1] << 4)
-                        + (voiceEmbSigRawBits[16*4 + 2] << 3)
-                        + (voiceEmbSigRawBits[16*4 + 3] << 2)
-                        + (voiceEmbSigRawBits[16*4 + 4] << 1)
-                        + (voiceEmbSigRawBits[16*4 + 5]);      // (LC24)
-                addresses.m_source = (voiceEmbSigRawBits[16*4 + 6] << 23) // (LC23)
-                        + (voiceEmbSigRawBits[16*4 + 7] << 22)
-                        + (voiceEmbSigRawBits[16*4 + 8] << 21)
-                        + (voiceEmbSigRawBits[16*4 + 9] << 20)
-                        + (voiceEmbSigRawBits[16*5 + 0] << 19)
-                        + (voiceEmbSigRawBits[16*5 + 1] << 18)
-                        + (voiceEmbSigRawBits[16*5 + 2] << 17)
-                        + (voiceEmbSigRawBits[16*5 + 3] << 16) // 2:7
-                        + (voiceEmbSigRawBits[16*5 + 4] << 15) // (LC15)
-                        + (voiceEmbSigRawBits[16*5 + 5] << 14)
-                        + (voiceEmbSigRawBits[16*5 + 6] << 13)
-                        + (voiceEmbSigRawBits[16*5 + 7] << 12)
-                        + (voiceEmbSigRawBits[16*5 + 8] << 11)
-                        + (voiceEmbSigRawBits[16*5 + 9] << 10)
-                        + (voiceEmbSigRawBits[16*6 + 0] << 9)
-                        + (voiceEmbSigRawBits[16*6 + 1] << 8)  // 1:7
-                        + (voiceEmbSigRawBits[16*6 + 2] << 7)  // (LC7)
-                        + (voiceEmbSigRawBits[16*6 + 3] << 6)
-                        + (voiceEmbSigRawBits[16*6 + 4] << 5)
-                        + (voiceEmbSigRawBits[16*6 + 5] << 4)
-                        + (voiceEmbSigRawBits[16*6 + 6] << 3)
-                        + (voiceEmbSigRawBits[16*6 + 7] << 2)
-                        + (voiceEmbSigRawBits[16*6 + 8] << 1)
-                        + (voiceEmbSigRawBits[16*6 + 9]);      // (LC0)
+                addresses.m_target = (((lc[2] >> 1) & 0xFF) << 16) // LC47..LC40
+                        + (((lc[3] >> 1) & 0x3FF) << 6)             // LC39..LC30
+                        + ((lc[4] >> 5) & 0x3F);                    // LC29..LC24
+                addresses.m_source = (((lc[4] >> 1) & 0x0F) << 20) // LC23..LC20
+                        + (((lc[5] >> 1) & 0x3FF) << 10)            // LC19..LC10
+                        + ((lc[6] >> 1) & 0x3FF);                   // LC9..LC0
 
                 return true; // we have a result
             }
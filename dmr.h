@@ -18,6 +18,7 @@
 #define DMR_H_
 
 #include "fec.h"
+#include "deinterleave.h"
 #include "export.h"
 
 #define DMR_TYPES_COUNT 12
@@ -127,10 +128,10 @@ private:
 
     void processDataFirstHalf(unsigned int shiftBack);  //!< Because sync is in the middle of a frame you need to process the first half first: CACH to end of SYNC
     void processVoiceFirstHalf(unsigned int shiftBack); //!< Because sync is in the middle of a frame you need to process the first half first: CACH to end of SYNC
-    void decodeCACH(unsigned char *cachBits);
+    void decodeCACH();
     void processSlotTypePDU();
     bool processEMB();
-    bool processVoiceEmbeddedSignalling(int& voiceEmbSig_dibitsIndex, unsigned char *voiceEmbSigRawBits, bool& voiceEmbSig_OK, DMRAddresses& addresses);
+    bool processVoiceEmbeddedSignalling(int& voiceEmbSig_dibitsIndex, Deinterleaver& voiceEmbSigDeinterleaver, bool& voiceEmbSig_OK, DMRAddresses& addresses);
     void processVoiceDibit(unsigned char dibit);
     void processDataDibit(unsigned char dibit);
     void storeSymbolDV(unsigned char *mbeFrame, int dibitindex, unsigned char dibit, bool invertDibit = false);
@@ -153,14 +154,11 @@ private:
     DSDDMRDataTYpe m_dataType;
     char *m_slotText;
     unsigned char m_slotTypePDU_dibits[10];
-    unsigned char m_cachBits[24];
     unsigned char m_emb_dibits[8];
     unsigned char m_voiceEmbSig_dibits[16];
-    unsigned char m_voice1EmbSigRawBits[16*8];
     int           m_voice1EmbSig_dibitsIndex;
     bool          m_voice1EmbSig_OK;
     DMRAddresses  m_slot1Addresses;
-    unsigned char m_voice2EmbSigRawBits[16*8];
     int           m_voice2EmbSig_dibitsIndex;
     bool          m_voice2EmbSig_OK;
     DMRAddresses  m_slot2Addresses;
@@ -173,17 +171,14 @@ private:
     Golay_20_8 m_golay_20_8;
     QR_16_7_6 m_qr_16_7_6;
     Hamming_16_11_4 m_hamming_16_11_4;
-
-    const int *w, *x, *y, *z;
+    Deinterleaver m_ambeDeinterleaver;
+    Deinterleaver m_cachDeinterleaver;
+    Deinterleaver m_voice1EmbSigDeinterleaver; //!< BPTC matrix of the embedded signalling of a voice superframe
+    Deinterleaver m_voice2EmbSigDeinterleaver;
 
     static const int m_cachInterleave[24];
     static const int m_embSigInterleave[128];
     static const char *m_slotTypeText[DMR_TYPES_COUNT];
-
-    static const int rW[36];
-    static const int rX[36];
-    static const int rY[36];
-    static const int rZ[36];
     static const unsigned short BasicPrivacyKeys[DMR_BP_KEYS_COUNT];
 };
 
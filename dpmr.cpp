@@ -23,50 +23,32 @@
 namespace DSDcc
 {
 
-/*
- * DMR AMBE interleave schedule
- */
-// bit 1
-const int DSDdPMR::rW[36] = {
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 2,
-  0, 2, 0, 2, 0, 2,
-  0, 2, 0, 2, 0, 2
-};
-
-const int DSDdPMR::rX[36] = {
-  23, 10, 22, 9, 21, 8,
-  20, 7, 19, 6, 18, 5,
-  17, 4, 16, 3, 15, 2,
-  14, 1, 13, 0, 12, 10,
-  11, 9, 10, 8, 9, 7,
-  8, 6, 7, 5, 6, 4
-};
+const unsigned char DSDdPMR::m_preamble[12] = {1, 1, 3, 3, 1, 1, 3, 3, 1, 1, 3, 3};
 
-// bit 0
-const int DSDdPMR::rY[36] = {
-  0, 2, 0, 2, 0, 2,
-  0, 2, 0, 3, 0, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3
+// position of each received bit in the rows of 12 bit Hamming codewords of the CCH (6 rows) and header (10 rows)
+const int DSDdPMR::m_interleave72[72] = {
+      0,  12,  24,  36,  48,  60,   1,  13,  25,  37,  49,  61,
+      2,  14,  26,  38,  50,  62,   3,  15,  27,  39,  51,  63,
+      4,  16,  28,  40,  52,  64,   5,  17,  29,  41,  53,  65,
+      6,  18,  30,  42,  54,  66,   7,  19,  31,  43,  55,  67,
+      8,  20,  32,  44,  56,  68,   9,  21,  33,  45,  57,  69,
+     10,  22,  34,  46,  58,  70,  11,  23,  35,  47,  59,  71,
 };
 
-const int DSDdPMR::rZ[36] = {
-  5, 3, 4, 2, 3, 1,
-  2, 0, 1, 13, 0, 12,
-  22, 11, 21, 10, 20, 9,
-  19, 8, 18, 7, 17, 6,
-  16, 5, 15, 4, 14, 3,
-  13, 2, 12, 1, 11, 0
+const int DSDdPMR::m_interleave120[120] = {
+      0,  12,  24,  36,  48,  60,  72,  84,  96, 108,   1,  13,
+     25,  37,  49,  61,  73,  85,  97, 109,   2,  14,  26,  38,
+     50,  62,  74,  86,  98, 110,   3,  15,  27,  39,  51,  63,
+     75,  87,  99, 111,   4,  16,  28,  40,  52,  64,  76,  88,
+    100, 112,   5,  17,  29,  41,  53,  65,  77,  89, 101, 113,
+      6,  18,  30,  42,  54,  66,  78,  90, 102, 114,   7,  19,
+     31,  43,  55,  67,  79,  91, 103, 115,   8,  20,  32,  44,
+     56,  68,  80,  92, 104, 116,   9,  21,  33,  45,  57,  69,
+     81,  93, 105, 117,  10,  22,  34,  46,  58,  70,  82,  94,
+    106, 118,  11,  23,  35,  47,  59,  71,  83,  95, 107, 119,
 };
 
-const unsigned char DSDdPMR::m_preamble[12] = {1, 1, 3, 3, 1, 1, 3, 3, 1, 1, 3, 3};
-
-char DSDdPMR::dpmrFrameTypes[][3] = {
+const char DSDdPMR::dpmrFrameTypes[][3] = {
         "--", // 0: no frame sync
         "XS", // 1: no frame - extensive search of FS2
         "HD", // 2: header frame
@@ -87,26 +69,24 @@ DSDdPMR::DSDdPMR(DSDDecoder *dsdDecoder) :
         m_symbolIndex(0),
         m_frameIndex(0),
         m_colourCode(0),
+        m_crc7(0x09, 7, 0, 0),
+        m_crc8(0x07, 8, 0, 0),
         m_calledId(0),
         m_ownId(0),
         m_calledIdHalf(false),
         m_ownIdHalf(false),
         m_frameNumber(0xFF),
-        w(0),
-        x(0),
-        y(0),
-        z(0)
+        m_ambeDeinterleaver(Deinterleaver::AMBE3600x2450, 72, 96),
+        m_cchDeinterleaver(m_interleave72, 72, 72),
+        m_headerDeinterleaver(m_interleave120, 120, 120)
 {
     memset(m_bitBuffer, 0, 80);
-    memset(m_bitBufferRx, 0, 120);
-    memset(m_bitWork, 0, 80);
     m_calledIdWork = 0;
     memset(m_colourBuffer, 0, 12);
     m_ownIdWork = 0;
     memset(m_syncDoubleBuffer, 0, 24);
 
     initScrambling();
-    initInterleaveIndexes();
     init();
 }
 
@@ -193,12 +173,11 @@ void DSDdPMR::processHeader()
 
 void DSDdPMR::processHIn(int symbolIndex, int dibit) // FIXME
 {
-    m_bitBufferRx[dI120[2*symbolIndex]]     = ((dibit >> 1) & 1) ^ m_scrambleBits[2*symbolIndex]; // MSB
-    m_bitBufferRx[dI120[2*symbolIndex + 1]] = (dibit & 1) ^ m_scrambleBits[2*symbolIndex + 1];    // LSB
+    m_headerDeinterleaver.pushDibit(symbolIndex, dibit ^ ((m_scrambleBits[2*symbolIndex] << 1) | m_scrambleBits[2*symbolIndex + 1]));
 
     if (symbolIndex == 59)
     {
-        bool hammingStatus = m_hamming.decode(m_bitBufferRx, m_bitBuffer, 10);
+        bool hammingStatus = decodeHamming(m_headerDeinterleaver, 10);
 
         if (checkCRC8(m_bitBuffer, 72)) // CRC8 check OK
         {
@@ -544,12 +523,11 @@ void DSDdPMR::processFS2(int symbolIndex, int dibit)
 
 void DSDdPMR::processCCH(int symbolIndex, int dibit)
 {
-    m_bitBufferRx[dI72[2*symbolIndex]]     = ((dibit >> 1) & 1) ^ m_scrambleBits[2*symbolIndex]; // MSB
-    m_bitBufferRx[dI72[2*symbolIndex + 1]] = (dibit & 1) ^ m_scrambleBits[2*symbolIndex + 1];    // LSB
+    m_cchDeinterleaver.pushDibit(symbolIndex, dibit ^ ((m_scrambleBits[2*symbolIndex] << 1) | m_scrambleBits[2*symbolIndex + 1]));
 
     if (symbolIndex == 35)
     {
-        m_hamming.decode(m_bitBufferRx, m_bitBuffer, 6);
+        decodeHamming(m_cchDeinterleaver, 6);
 
         if (checkCRC7(m_bitBuffer, 41)) // CRC7 check OK
         {
@@ -717,24 +695,16 @@ void DSDdPMR::processVoiceFrame(int symbolIndex, int dibit)
 
     if (symbolIndex % 36 == 0)
     {
-        w = rW;
-        x = rX;
-        y = rY;
-        z = rZ;
         memset((void *) m_dsdDecoder->m_mbeDVFrame1, 0, 9); // initialize DVSI frame
     }
 
-    m_dsdDecoder->ambe_fr[*w][*x] = (1 & (dibit >> 1)); // bit 1
-    m_dsdDecoder->ambe_fr[*y][*z] = (1 & dibit);        // bit 0
-    w++;
-    x++;
-    y++;
-    z++;
+    m_ambeDeinterleaver.pushDibit(symbolIndex % 36, dibit);
 
     storeSymbolDV(symbolIndex % 36, dibit); // store dibit for DVSI hardware decoder
 
     if (symbolIndex % 36 == 35)
     {
+        m_ambeDeinterleaver.getBits((unsigned char *) m_dsdDecoder->ambe_fr);
         m_dsdDecoder->m_mbeDecoder1.processFrame(0, m_dsdDecoder->ambe_fr, 0);
         m_dsdDecoder->m_mbeDVReady1 = true; // Indicate that a DVSI frame is available
 
@@ -770,68 +740,44 @@ void DSDdPMR::initScrambling()
     }
 }
 
-void DSDdPMR::initInterleaveIndexes()
+bool DSDdPMR::decodeHamming(const Deinterleaver& deinterleaver, int nbCodewords)
 {
-    for (int i = 0; i < 72; i++)
-    {
-        dI72[i] = 12 * (i % 6) + (i / 6);
+    uint32_t codewords[10];
+    uint16_t data[10];
+
+    for (int i = 0; i < nbCodewords; i++) {
+        codewords[i] = deinterleaver.getCodeword(12*i, 12);
     }
 
-    for (int i = 0; i < 120; i++)
-    {
-        dI120[i] = 12 * (i % 10) + (i / 10);
+    bool correctable = m_hamming.decodeBatch(codewords, data, nbCodewords);
+
+    for (int i = 0; i < 8*nbCodewords; i++) { // CRC and fields work on the information bits
+        m_bitBuffer[i] = (data[i/8] >> (7 - (i%8))) & 1;
     }
+
+    return correctable;
 }
 
 bool DSDdPMR::checkCRC7(unsigned char *bits, int nbBits)
 {
-    memcpy(m_bitWork, bits, nbBits);
-    memset(&m_bitWork[nbBits], 0, 7);
+    unsigned int crc = 0;
 
-    for (int i = 0; i < nbBits; i++)
-    {
-        if (m_bitWork[i] == 1) // divide by X^7+X^3+1 (10001001)
-        {
-            m_bitWork[i]    = 0; // X^8
-            m_bitWork[i+4] ^= 1; // X^3
-            m_bitWork[i+7] ^= 1; // 1
-        }
+    for (int i = 0; i < 7; i++) {
+        crc = (crc << 1) | bits[nbBits + i];
     }
 
-    if (memcmp(&bits[nbBits], &m_bitWork[nbBits], 7) == 0) // CRC OK
-    {
-        return true;
-    }
-    else
-    {
-        return false;
-    }
+    return m_crc7.crcbits(bits, nbBits) == crc; // divide by X^7+X^3+1 (10001001)
 }
 
 bool DSDdPMR::checkCRC8(unsigned char *bits, int nbBits)
 {
-    memcpy(m_bitWork, bits, nbBits);
-    memset(&m_bitWork[nbBits], 0, 8);
+    unsigned int crc = 0;
 
-    for (int i = 0; i < nbBits; i++)
-    {
-        if (m_bitWork[i] == 1) // divide by X^8+X^2+X+1  (100000111)
-        {
-            m_bitWork[i]    = 0; // X^8
-            m_bitWork[i+6] ^= 1; // X^2
-            m_bitWork[i+7] ^= 1; // X
-            m_bitWork[i+8] ^= 1; // 1
-        }
+    for (int i = 0; i < 8; i++) {
+        crc = (crc << 1) | bits[nbBits + i];
     }
 
-    if (memcmp(&bits[nbBits], &m_bitWork[nbBits], 8) == 0) // CRC OK
-    {
-        return true;
-    }
-    else
-    {
-        return false;
-    }
+    return m_crc8.crcbits(bits, nbBits) == crc; // divide by X^8+X^2+X+1  (100000111)
 }
 
 DSDdPMR::LFSRGenerator::LFSRGenerator()
@@ -18,6 +18,8 @@
 #define DPMR_H_
 
 #include "fec.h"
+#include "crc.h"
+#include "deinterleave.h"
 #include "export.h"
 
 namespace DSDcc
@@ -87,7 +89,7 @@ public:
     unsigned int getCalledId() const { return m_calledId; }
     unsigned int getOwnId() const { return m_ownId; }
 
-    static char dpmrFrameTypes[9][3];
+    static const char dpmrFrameTypes[9][3];
 
 private:
     class LFSRGenerator
@@ -125,7 +127,7 @@ private:
     void processVoiceFrame(int symbolIndex, int dibit);
     void storeSymbolDV(int dibitindex, unsigned char dibit, bool invertDibit = false);
     void initScrambling();
-    void initInterleaveIndexes();
+    bool decodeHamming(const Deinterleaver& deinterleaver, int nbCodewords); //!< Hamming (12,8) rows to information bits in m_bitBuffer
     bool checkCRC7(unsigned char *bits, int nbBits);
     bool checkCRC8(unsigned char *bits, int nbBits);
 
@@ -141,11 +143,9 @@ private:
     LFSRGenerator m_scramblingGenerator;
     Hamming_12_8  m_hamming;
     unsigned char m_scrambleBits[120];
-    unsigned char m_bitBufferRx[120];
     unsigned char m_bitBuffer[80];
-    unsigned char m_bitWork[80];
-    unsigned int dI72[72];
-    unsigned int dI120[120];
+    CRC m_crc7;                           //!< X^7+X^3+1
+    CRC m_crc8;                           //!< X^8+X^2+X+1
     DPMRHeaderType m_headerType;
     DPMRCommMode m_commMode;
     DPMRCommFormat m_commFormat;
@@ -156,13 +156,13 @@ private:
     bool m_calledIdHalf;
     bool m_ownIdHalf;
     unsigned char m_frameNumber;
+    Deinterleaver m_ambeDeinterleaver;
+    Deinterleaver m_cchDeinterleaver;
+    Deinterleaver m_headerDeinterleaver;
 
-    static const int rW[36];
-    static const int rX[36];
-    static const int rY[36];
-    static const int rZ[36];
     static const unsigned char m_preamble[12];
-    const int *w, *x, *y, *z;
+    static const int m_interleave72[72];   //!< CCH
+    static const int m_interleave120[120]; //!< header HI0 and HI1
 };
 
 
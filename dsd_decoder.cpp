@@ -15,6 +15,7 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <algorithm>
 
@@ -28,21 +29,40 @@ namespace DSDcc
 DSDDecoder::DSDDecoder() :
         m_fsmState(DSDLookForSync),
         m_dsdSymbol(this),
+        m_multiRateSync(false),
+        m_autoDecode(false),
+        m_confirmSymbol(0),
+        m_frontEndFilters(0),
+        m_sampleHistory(0),
+        m_sampleHistoryIndex(0),
         m_mbelibEnable(true),
         m_mbeRate(DSDMBERateNone),
         m_mbeDecoder1(this),
         m_mbeDecoder2(this),
         m_mbeDVReady1(false),
-        m_dsdDMR(this),
-        m_dsdDstar(this),
-        m_dsdYSF(this),
-        m_dsdDPMR(this),
-		m_dsdNXDN(this),
+        m_mbeDVReady2(false),
+        m_dsdDMR(0),
+        m_dsdDstar(0),
+        m_dsdYSF(0),
+        m_dsdDPMR(0),
+        m_dsdNXDN(0),
         m_dataRate(DSDRate4800),
         m_syncType(DSDSyncNone),
         m_lastSyncType(DSDSyncNone),
         m_signalFormat(signalFormatNone)
 {
+    static const DSDRate rates[3] = {DSDRate2400, DSDRate4800, DSDRate9600};
+
+    for (int i = 0; i < 3; i++)
+    {
+        m_rateBranches[i].m_rate = rates[i];
+        m_rateBranches[i].m_symbol = 0;
+        m_rateBranches[i].m_nbSyncPatterns = 0;
+        m_rateBranches[i].m_nbSymbols = 0;
+    }
+
+    allocateDecoders();
+    updateSyncPatterns();
     resetFrameSync();
     noCarrier();
     m_squelchTimeoutCount = 0;
@@ -51,6 +71,90 @@ DSDDecoder::DSDDecoder() :
 
 DSDDecoder::~DSDDecoder()
 {
+    for (int i = 0; i < 3; i++) {
+        delete m_rateBranches[i].m_symbol;
+    }
+
+    delete[] m_sampleHistory;
+    delete m_frontEndFilters;
+    delete m_confirmSymbol;
+
+    delete m_dsdNXDN;
+    delete m_dsdDPMR;
+    delete m_dsdYSF;
+    delete m_dsdDstar;
+    delete m_dsdDMR;
+}
+
+void DSDDecoder::allocateDecoders()
+{
+    if (m_opts.frame_dmr && !m_dsdDMR) {
+        m_dsdDMR = new DSDDMR(this);
+    }
+
+    if (m_opts.frame_dstar && !m_dsdDstar) {
+        m_dsdDstar = new DSDDstar(this);
+    }
+
+    if (m_opts.frame_ysf && !m_dsdYSF) {
+        m_dsdYSF = new DSDYSF(this);
+    }
+
+    if (m_opts.frame_dpmr && !m_dsdDPMR) {
+        m_dsdDPMR = new DSDdPMR(this);
+    }
+
+    if ((m_opts.frame_nxdn48 || m_opts.frame_nxdn96) && !m_dsdNXDN) {
+        m_dsdNXDN = new DSDNXDN(this);
+    }
+}
+
+const DSDDecoder& DSDDecoder::idleDecoder()
+{
+    // built on first use (thread safe) and kept until exit
+    static const DSDDecoder *idle = createIdleDecoder();
+    return *idle;
+}
+
+DSDDecoder *DSDDecoder::createIdleDecoder()
+{
+    DSDDecoder *decoder = new DSDDecoder();
+    decoder->setQuiet();
+    decoder->setAudioRingSize(DSDMBEDecoder::m_minAudioRingSize);
+    decoder->m_opts.frame_dmr = 1;
+    decoder->m_opts.frame_dstar = 1;
+    decoder->m_opts.frame_ysf = 1;
+    decoder->m_opts.frame_dpmr = 1;
+    decoder->m_opts.frame_nxdn48 = 1;
+    decoder->allocateDecoders();
+    return decoder;
+}
+
+// frame decoders are only allocated by allocateDecoders(). The getters never allocate
+
+const DSDDMR& DSDDecoder::getDMRDecoder() const
+{
+    return m_dsdDMR ? *m_dsdDMR : *idleDecoder().m_dsdDMR;
+}
+
+const DSDDstar& DSDDecoder::getDStarDecoder() const
+{
+    return m_dsdDstar ? *m_dsdDstar : *idleDecoder().m_dsdDstar;
+}
+
+const DSDdPMR& DSDDecoder::getDPMRDecoder() const
+{
+    return m_dsdDPMR ? *m_dsdDPMR : *idleDecoder().m_dsdDPMR;
+}
+
+const DSDYSF& DSDDecoder::getYSFDecoder() const
+{
+    return m_dsdYSF ? *m_dsdYSF : *idleDecoder().m_dsdYSF;
+}
+
+const DSDNXDN& DSDDecoder::getNXDNDecoder() const
+{
+    return m_dsdNXDN ? *m_dsdNXDN : *idleDecoder().m_dsdNXDN;
 }
 
 void DSDDecoder::setQuiet()
@@ -115,6 +219,7 @@ void DSDDecoder::setDecodeMode(DSDDecodeMode mode, bool on)
     case DSDDecodeNone:
         if (on)
         {
+            m_autoDecode = false;
             m_opts.frame_dmr = 0;
             m_opts.frame_dstar = 0;
             m_opts.frame_p25p1 = 0;
@@ -181,31 +286,47 @@ void DSDDecoder::setDecodeMode(DSDDecodeMode mode, bool on)
         m_opts.frame_x2tdma = 0;
         m_opts.frame_dpmr = 0;
         m_opts.frame_ysf = 0;
-        switch (m_dataRate)
+        m_autoDecode = on;
+        if (m_multiRateSync && on) // modes of all rates
         {
-        case DSDRate2400:
-            m_opts.frame_nxdn48 = (on ? 1 : 0);
-            m_opts.frame_dpmr = (on ? 1 : 0);
-            break;
-        case DSDRate4800:
-            m_opts.frame_dmr = (on ? 1 : 0);
-            m_opts.frame_dstar = (on ? 1 : 0);
-            m_opts.frame_x2tdma = (on ? 1 : 0);
-            m_opts.frame_p25p1 = (on ? 1 : 0);
-            m_opts.frame_nxdn96 = (on ? 1 : 0);
-            m_opts.frame_ysf = (on ? 1 : 0);
-            break;
-        case DSDRate9600:
-            m_opts.frame_provoice = (on ? 1 : 0);
-            break;
-        default:
-            m_opts.frame_dmr = (on ? 1 : 0);
-            m_opts.frame_dstar = (on ? 1 : 0);
-            m_opts.frame_x2tdma = (on ? 1 : 0);
-            m_opts.frame_p25p1 = (on ? 1 : 0);
-            m_opts.frame_nxdn96 = (on ? 1 : 0);
-            m_opts.frame_ysf = (on ? 1 : 0);
-            break;
+            m_opts.frame_nxdn48 = 1;
+            m_opts.frame_dpmr = 1;
+            m_opts.frame_dmr = 1;
+            m_opts.frame_dstar = 1;
+            m_opts.frame_x2tdma = 1;
+            m_opts.frame_p25p1 = 1;
+            m_opts.frame_nxdn96 = 1;
+            m_opts.frame_ysf = 1;
+            m_opts.frame_provoice = 1;
+        }
+        else
+        {
+            switch (m_dataRate)
+            {
+            case DSDRate2400:
+                m_opts.frame_nxdn48 = (on ? 1 : 0);
+                m_opts.frame_dpmr = (on ? 1 : 0);
+                break;
+            case DSDRate4800:
+                m_opts.frame_dmr = (on ? 1 : 0);
+                m_opts.frame_dstar = (on ? 1 : 0);
+                m_opts.frame_x2tdma = (on ? 1 : 0);
+                m_opts.frame_p25p1 = (on ? 1 : 0);
+                m_opts.frame_nxdn96 = (on ? 1 : 0);
+                m_opts.frame_ysf = (on ? 1 : 0);
+                break;
+            case DSDRate9600:
+                m_opts.frame_provoice = (on ? 1 : 0);
+                break;
+            default:
+                m_opts.frame_dmr = (on ? 1 : 0);
+                m_opts.frame_dstar = (on ? 1 : 0);
+                m_opts.frame_x2tdma = (on ? 1 : 0);
+                m_opts.frame_p25p1 = (on ? 1 : 0);
+                m_opts.frame_nxdn96 = (on ? 1 : 0);
+                m_opts.frame_ysf = (on ? 1 : 0);
+                break;
+            }
         }
         m_dsdLogger.log("%s auto frame decoding.\n", (on ? "Enabling" : "Disabling"));
         break;
@@ -213,12 +334,36 @@ void DSDDecoder::setDecodeMode(DSDDecodeMode mode, bool on)
         break;
     }
 
+    allocateDecoders();
+    updateSyncPatterns();
     resetFrameSync();
     noCarrier();
     m_squelchTimeoutCount = 0;
     m_nxdnInterSyncCount = -1; // reset to quiet state
 }
 
+void DSDDecoder::setSoftDecision(DSDDecodeMode mode, bool on)
+{
+    switch(mode)
+    {
+    case DSDDecodeDStar:
+        m_opts.soft_dstar = (on ? 1 : 0);
+        m_dsdLogger.log("%s soft decision for D-Star header.\n", (on ? "Enabling" : "Disabling"));
+        break;
+    case DSDDecodeYSF:
+        m_opts.soft_ysf = (on ? 1 : 0);
+        m_dsdLogger.log("%s soft decision for YSF.\n", (on ? "Enabling" : "Disabling"));
+        break;
+    case DSDDecodeNXDN48:
+    case DSDDecodeNXDN96:
+        m_opts.soft_nxdn = (on ? 1 : 0);
+        m_dsdLogger.log("%s soft decision for NXDN.\n", (on ? "Enabling" : "Disabling"));
+        break;
+    default:
+        break;
+    }
+}
+
 void DSDDecoder::setAudioGain(float gain)
 {
     m_opts.audio_gain = gain;
@@ -283,6 +428,12 @@ void DSDDecoder::setStereo(bool on)
 	m_mbeDecoder2.setStereo(on);
 }
 
+void DSDDecoder::setAsyncVocoder(bool async)
+{
+    m_mbeDecoder1.setAsync(async);
+    m_mbeDecoder2.setAsync(async);
+}
+
 void DSDDecoder::setInvertedXTDMA(bool on)
 {
     m_opts.inverted_x2tdma = (on ? 1 : 0);
@@ -330,9 +481,93 @@ void DSDDecoder::setDataRate(DSDRate dataRate)
         m_dsdSymbol.setSamplesPerSymbol(10);
         break;
     }
+
+    updateSyncPatterns();
 }
 
-void DSDDecoder::run(short sample)
+void DSDDecoder::updateSyncPatterns()
+{
+    m_nbSyncPatterns = getSyncPatterns(m_dataRate, m_syncPatterns);
+
+    // the hunting branches leave out the NXDN frame sync word alone as it is only accepted
+    // after a full sync has been seen at the current rate
+    for (int i = 0; i < 3; i++)
+    {
+        RateBranch& branch = m_rateBranches[i];
+        DSDSync::SyncPattern syncPatterns[DSDSync::m_patterns];
+        int nbSyncPatterns = getSyncPatterns(branch.m_rate, syncPatterns);
+        branch.m_nbSyncPatterns = 0;
+
+        for (int j = 0; j < nbSyncPatterns; j++)
+        {
+            if ((syncPatterns[j] != DSDSync::SyncNXDNRDCHFSW) && (syncPatterns[j] != DSDSync::SyncNXDNRDCHFSWInv)) {
+                branch.m_syncPatterns[branch.m_nbSyncPatterns++] = syncPatterns[j];
+            }
+        }
+    }
+}
+
+int DSDDecoder::getSyncPatterns(DSDRate dataRate, DSDSync::SyncPattern *syncPatterns) const
+{
+    // only the patterns of the enabled modes that can run at the data rate are searched for
+    bool rate2400 = (dataRate == DSDRate2400);
+    bool rate4800 = (dataRate != DSDRate2400) && (dataRate != DSDRate9600); // default is 4800
+    bool rate9600 = (dataRate == DSDRate9600);
+    int nbSyncPatterns = 0;
+
+    if ((m_opts.frame_p25p1 == 1) && rate4800)
+    {
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncP25P1;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncP25P1Inv;
+    }
+    if ((m_opts.frame_x2tdma == 1) && rate4800)
+    {
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncX2TDMADataBS;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncX2TDMADataMS;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncX2TDMAVoiceBS;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncX2TDMAVoiceMS;
+    }
+    if ((m_opts.frame_ysf == 1) && rate4800)
+    {
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncYSF;
+    }
+    if ((m_opts.frame_dmr == 1) && rate4800)
+    {
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncDMRDataBS;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncDMRDataMS;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncDMRVoiceBS;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncDMRVoiceMS;
+    }
+    if ((m_opts.frame_provoice == 1) && rate9600)
+    {
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncProVoice;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncProVoiceEA;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncProVoiceInv;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncProVoiceEAInv;
+    }
+    if (((m_opts.frame_nxdn48 == 1) && rate2400) || ((m_opts.frame_nxdn96 == 1) && rate4800))
+    {
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncNXDNRDCHFull;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncNXDNRDCHFullInv;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncNXDNRDCHFSW;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncNXDNRDCHFSWInv;
+    }
+    if ((m_opts.frame_dpmr == 1) && rate2400)
+    {
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncDPMRFS1;
+    }
+    if ((m_opts.frame_dstar == 1) && rate4800)
+    {
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncDStar;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncDStarInv;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncDStarHeader;
+        syncPatterns[nbSyncPatterns++] = DSDSync::SyncDStarHeaderInv;
+    }
+
+    return nbSyncPatterns;
+}
+
+inline bool DSDDecoder::runSample(short sample)
 {
     // mode time out if squelch has been closed for a number of samples
     if (m_fsmState != DSDLookForSync)
@@ -356,73 +591,367 @@ void DSDDecoder::run(short sample)
         }
     }
 
-    if (m_dsdSymbol.pushSample(sample)) // a symbol is retrieved
+    if (m_multiRateSync)
+    {
+        if (!runMultiRateSample(sample)) { // no symbol retrieved
+            return false;
+        }
+    }
+    else if (!m_dsdSymbol.pushSample(sample)) // no symbol retrieved
+    {
+        return false;
+    }
+
+    m_state.symbolcnt++;
+    processSymbol();
+    return true;
+}
+
+void DSDDecoder::processSymbol()
+{
+    DSD_STATS_SCOPE(&m_stats, getStatsStage());
+
+    switch (m_fsmState)
     {
-        switch (m_fsmState)
+    case DSDLookForSync:
+        m_sync = getFrameSync(); // -> -2: still looking, -1 not found, 0 and above: sync found
+
+        if (m_sync == -2) // -2 means no sync has been found at all
+        {
+            break; // still searching -> no change in FSM state
+        }
+        else if (m_sync == -1) // -1 means sync has been found but is invalid
         {
-        case DSDLookForSync:
-            m_sync = getFrameSync(); // -> -2: still looking, -1 not found, 0 and above: sync found
+            m_dsdLogger.log("DSDDecoder::run: invalid sync found: %d symbol %d (%d)\n", m_sync, m_state.symbolcnt, m_dsdSymbol.getSymbol());
+            resetFrameSync(); // go back searching
+        }
+        else // good sync found
+        {
+            m_dsdLogger.log("DSDDecoder::run: good sync found: %d symbol %d (%d)\n", m_sync, m_state.symbolcnt, m_dsdSymbol.getSymbol());
+            m_fsmState = DSDSyncFound; // go to processing state next time
+        }
 
-            if (m_sync == -2) // -2 means no sync has been found at all
-            {
-                break; // still searching -> no change in FSM state
+        break; // next
+    case DSDSyncFound:
+        m_syncType  = (DSDSyncType) m_sync;
+        m_dsdLogger.log("DSDDecoder::run: before processFrameInit: symbol %d (%d)\n", m_state.symbolcnt, m_dsdSymbol.getSymbol());
+        processFrameInit();   // initiate the process of the frame which sync has been found. This will change FSM state
+        break;
+    case DSDprocessDMRvoice:
+        m_dsdDMR->processVoice();
+        break;
+    case DSDprocessDMRvoiceMS:
+        m_dsdDMR->processVoiceMS();
+        break;
+    case DSDprocessDMRdata:
+        m_dsdDMR->processData();
+        break;
+    case DSDprocessDMRdataMS:
+        m_dsdDMR->processDataMS();
+        break;
+    case DSDprocessDMRsyncOrSkip:
+        m_dsdDMR->processSyncOrSkip();
+        break;
+    case DSDprocessDMRSkipMS:
+        m_dsdDMR->processSkipMS();
+        break;
+    case DSDprocessDSTAR:
+        m_dsdDstar->process();
+        break;
+    case DSDprocessDSTAR_HD:
+        m_dsdDstar->processHD();
+        break;
+    case DSDprocessYSF:
+        m_dsdYSF->process();
+        break;
+    case DSDprocessDPMR:
+        m_dsdDPMR->process();
+        break;
+    case DSDprocessNXDN:
+        m_dsdNXDN->process();
+        break;
+    default:
+        break;
+    }
+}
+
+bool DSDDecoder::runMultiRateSample(short sample)
+{
+    m_sampleHistory[m_sampleHistoryIndex] = sample;
+    m_sampleHistoryIndex = (m_sampleHistoryIndex + 1) & (m_sampleHistorySize - 1);
+    bool hunting = (m_fsmState == DSDLookForSync);
+    bool branchSymbols[3] = {false, false, false};
+    short dmrSample = sample;  // 12.5 kHz for 4800 and 9600 baud
+    short nxdnSample = sample; // 6.25 kHz for 2400 baud
+
+    {
+        DSD_STATS_SCOPE(&m_stats, DSDStatsSnapshot::StageSymbol);
+
+        if (m_opts.use_cosine_filter)
+        {
+            DSD_STATS_SCOPE(&m_stats, DSDStatsSnapshot::StageFilter);
+
+            if (hunting || (m_dataRate != DSDRate2400)) {
+                dmrSample = m_frontEndFilters->dmr_filter(sample);
             }
-            else if (m_sync == -1) // -1 means sync has been found but is invalid
+            if (hunting || (m_dataRate == DSDRate2400)) {
+                nxdnSample = m_frontEndFilters->nxdn_filter(sample);
+            }
+        }
+
+        for (int i = 0; i < 3; i++)
+        {
+            RateBranch& branch = m_rateBranches[i];
+
+            if (!hunting) // branches are idle while a frame is processed and start over at the next hunt
             {
-                m_dsdLogger.log("DSDDecoder::run: invalid sync found: %d symbol %d (%d)\n", m_sync, m_state.symbolcnt, m_dsdSymbol.getSymbol());
-                resetFrameSync(); // go back searching
+                branch.m_nbSymbols = 0;
+                continue;
+            }
+
+            if ((branch.m_rate == m_dataRate) || (branch.m_nbSyncPatterns == 0)) {
+                continue;
+            }
+
+            branchSymbols[i] = branch.m_symbol->pushFilteredSample(branch.m_rate == DSDRate2400 ? nxdnSample : dmrSample);
+        }
+    }
+
+    // the rate change and its replay run outside the symbol stage as they process frames
+    for (int i = 0; i < 3; i++)
+    {
+        RateBranch& branch = m_rateBranches[i];
+
+        if (!branchSymbols[i]) {
+            continue;
+        }
+
+        if (branch.m_nbSymbols < DSDSync::m_history) // flush the dibits left from the previous hunt
+        {
+            branch.m_nbSymbols++;
+            continue;
+        }
+
+        bool syncFound = false;
+
+        {
+            DSD_STATS_SCOPE(&m_stats, DSDStatsSnapshot::StageSync);
+            m_syncEngine.matchSome(branch.m_symbol->getSyncDibitRegister(), branch.m_syncPatterns, branch.m_nbSyncPatterns);
+
+            for (int j = 0; (j < branch.m_nbSyncPatterns) && !syncFound; j++) {
+                syncFound = (m_syncEngine.getErrors(branch.m_syncPatterns[j]) == 0); // a rate change is costly: no tolerance
             }
-            else // good sync found
+        }
+
+        if (syncFound && commitRate(branch)) {
+            return false; // the current sample has been replayed
+        }
+    }
+
+    DSD_STATS_SCOPE(&m_stats, DSDStatsSnapshot::StageSymbol);
+    return m_dsdSymbol.pushFilteredSample(m_dataRate == DSDRate2400 ? nxdnSample : dmrSample);
+}
+
+bool DSDDecoder::commitRate(const RateBranch& branch)
+{
+    m_dsdLogger.log("DSDDecoder::commitRate: sync found at %s bauds\n",
+            branch.m_rate == DSDRate2400 ? "2400" : branch.m_rate == DSDRate9600 ? "9600" : "4800");
+
+    for (int i = 0; i < 3; i++) {
+        m_rateBranches[i].m_nbSymbols = 0;
+    }
+
+    // the sync must be seen again by a fresh symbol recovery at the new rate else stay at the current rate
+    if (!confirmSync(branch.m_rate))
+    {
+        m_dsdLogger.log("DSDDecoder::commitRate: sync not confirmed\n");
+        return false;
+    }
+
+    setDataRate(branch.m_rate);
+    resetFrameSync();
+    replaySamples();
+    return true;
+}
+
+bool DSDDecoder::confirmSync(DSDRate dataRate)
+{
+    // dry run of the sample history: only the sync engine is used so that no frame is processed
+    DSD_STATS_SCOPE(&m_stats, DSDStatsSnapshot::StageSync);
+    DSDFilters filters;
+    DSDSync::SyncPattern syncPatterns[DSDSync::m_patterns];
+    int nbSyncPatterns = getSyncPatterns(dataRate, syncPatterns);
+    int samplesPerSymbol = (dataRate == DSDRate2400) ? 20 : (dataRate == DSDRate9600) ? 5 : 10;
+    int nbSymbols = 0;
+
+    m_confirmSymbol->noCarrier();
+    m_confirmSymbol->setSamplesPerSymbol(samplesPerSymbol);
+
+    for (unsigned int i = 0; i < m_sampleHistorySize; i++)
+    {
+        short sample = m_sampleHistory[(m_sampleHistoryIndex + i) & (m_sampleHistorySize - 1)];
+
+        if (m_opts.use_cosine_filter) {
+            sample = (dataRate == DSDRate2400) ? filters.nxdn_filter(sample) : filters.dmr_filter(sample);
+        }
+
+        if (!m_confirmSymbol->pushFilteredSample(sample)) {
+            continue;
+        }
+
+        // the sync seen by the hunting branch ends with the last samples. Allow some timing difference.
+        if ((++nbSymbols < DSDSync::m_history) || (i + 4*samplesPerSymbol < m_sampleHistorySize)) {
+            continue;
+        }
+
+        m_syncEngine.matchSome(m_confirmSymbol->getSyncDibitRegister(), syncPatterns, nbSyncPatterns);
+
+        for (int j = 0; j < nbSyncPatterns; j++)
+        {
+            if (m_syncEngine.isMatching(syncPatterns[j])) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void DSDDecoder::replaySamples()
+{
+    // replay the recent samples at the current rate so that the frame which sync has just been seen is not lost
+    DSDFilters filters;
+
+    for (unsigned int i = 0; i < m_sampleHistorySize; i++)
+    {
+        short sample = m_sampleHistory[(m_sampleHistoryIndex + i) & (m_sampleHistorySize - 1)];
+        bool symbol;
+
+        {
+            DSD_STATS_SCOPE(&m_stats, DSDStatsSnapshot::StageSymbol);
+
+            if (m_opts.use_cosine_filter)
             {
-                m_dsdLogger.log("DSDDecoder::run: good sync found: %d symbol %d (%d)\n", m_sync, m_state.symbolcnt, m_dsdSymbol.getSymbol());
-                m_fsmState = DSDSyncFound; // go to processing state next time
+                DSD_STATS_SCOPE(&m_stats, DSDStatsSnapshot::StageFilter);
+                sample = (m_dataRate == DSDRate2400) ? filters.nxdn_filter(sample) : filters.dmr_filter(sample);
             }
 
-            break; // next
-        case DSDSyncFound:
-            m_syncType  = (DSDSyncType) m_sync;
-            m_dsdLogger.log("DSDDecoder::run: before processFrameInit: symbol %d (%d)\n", m_state.symbolcnt, m_dsdSymbol.getSymbol());
-            processFrameInit();   // initiate the process of the frame which sync has been found. This will change FSM state
-            break;
-        case DSDprocessDMRvoice:
-            m_dsdDMR.processVoice();
-            break;
-        case DSDprocessDMRvoiceMS:
-            m_dsdDMR.processVoiceMS();
-            break;
-        case DSDprocessDMRdata:
-            m_dsdDMR.processData();
-            break;
-        case DSDprocessDMRdataMS:
-            m_dsdDMR.processDataMS();
-            break;
-        case DSDprocessDMRsyncOrSkip:
-            m_dsdDMR.processSyncOrSkip();
-            break;
-        case DSDprocessDMRSkipMS:
-            m_dsdDMR.processSkipMS();
-            break;
-        case DSDprocessDSTAR:
-            m_dsdDstar.process();
-            break;
-        case DSDprocessDSTAR_HD:
-            m_dsdDstar.processHD();
-            break;
-        case DSDprocessYSF:
-            m_dsdYSF.process();
-            break;
-        case DSDprocessDPMR:
-            m_dsdDPMR.process();
-            break;
-        case DSDprocessNXDN:
-            m_dsdNXDN.process();
-            break;
-        default:
-            break;
+            symbol = m_dsdSymbol.pushFilteredSample(sample);
+        }
+
+        if (symbol) // the state machine opens its own stage
+        {
+            m_state.symbolcnt++;
+            processSymbol();
         }
     }
 }
 
+void DSDDecoder::setMultiRateSync(bool on)
+{
+    if (on == m_multiRateSync) {
+        return;
+    }
+
+    m_multiRateSync = on;
+
+    if (on)
+    {
+        static const int samplesPerSymbol[3] = {20, 10, 5};
+
+        for (int i = 0; i < 3; i++)
+        {
+            m_rateBranches[i].m_symbol = new DSDSymbol(this);
+            m_rateBranches[i].m_symbol->setSamplesPerSymbol(samplesPerSymbol[i]);
+            m_rateBranches[i].m_nbSymbols = 0;
+        }
+
+        m_confirmSymbol = new DSDSymbol(this);
+        m_frontEndFilters = new DSDFilters();
+        m_sampleHistory = new short[m_sampleHistorySize];
+        memset(m_sampleHistory, 0, m_sampleHistorySize*sizeof(short));
+        m_sampleHistoryIndex = 0;
+        m_dsdLogger.log("Enabling sync hunting at 2400, 4800 and 9600 bauds.\n");
+    }
+    else
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            delete m_rateBranches[i].m_symbol;
+            m_rateBranches[i].m_symbol = 0;
+        }
+
+        delete m_confirmSymbol;
+        m_confirmSymbol = 0;
+        delete m_frontEndFilters;
+        m_frontEndFilters = 0;
+        delete[] m_sampleHistory;
+        m_sampleHistory = 0;
+        m_dsdLogger.log("Disabling sync hunting at 2400, 4800 and 9600 bauds.\n");
+    }
+
+    if (m_autoDecode) { // extend or restrict to the modes of the current rate
+        setDecodeMode(DSDDecodeAuto, true);
+    }
+}
+
+void DSDDecoder::run(short sample)
+{
+    DSD_STATS_CURRENT_SCOPE(&m_stats);
+    runSample(sample);
+}
+
+std::size_t DSDDecoder::runBlock(const short *samples, std::size_t nbSamples, int& nbSymbols, int& nbAudioFrames)
+{
+    unsigned int audioFramesStart = m_mbeDecoder1.getNbAudioFrames() + m_mbeDecoder2.getNbAudioFrames();
+    bool dvReady1 = m_mbeDVReady1;
+    bool dvReady2 = m_mbeDVReady2;
+    std::size_t i = 0;
+    nbSymbols = 0;
+    DSD_STATS_CURRENT_SCOPE(&m_stats);
+
+    while (i < nbSamples)
+    {
+        if (runSample(samples[i++]))
+        {
+            nbSymbols++;
+
+            // a DVSI frame has only one slot: give the caller a chance to fetch it before it gets overwritten
+            if ((m_mbeDVReady1 && !dvReady1) || (m_mbeDVReady2 && !dvReady2)) {
+                break;
+            }
+        }
+    }
+
+    nbAudioFrames = (m_mbeDecoder1.getNbAudioFrames() + m_mbeDecoder2.getNbAudioFrames()) - audioFramesStart;
+    return i;
+}
+
+DSDStatsSnapshot::Stage DSDDecoder::getStatsStage() const
+{
+    switch (m_fsmState)
+    {
+    case DSDprocessDMRvoice:
+    case DSDprocessDMRvoiceMS:
+    case DSDprocessDMRdata:
+    case DSDprocessDMRdataMS:
+    case DSDprocessDMRsyncOrSkip:
+    case DSDprocessDMRSkipMS:
+        return DSDStatsSnapshot::StageDMR;
+    case DSDprocessDSTAR:
+    case DSDprocessDSTAR_HD:
+        return DSDStatsSnapshot::StageDStar;
+    case DSDprocessYSF:
+        return DSDStatsSnapshot::StageYSF;
+    case DSDprocessDPMR:
+        return DSDStatsSnapshot::StageDPMR;
+    case DSDprocessNXDN:
+        return DSDStatsSnapshot::StageNXDN;
+    default:
+        return DSDStatsSnapshot::StageSync;
+    }
+}
+
 void DSDDecoder::processFrameInit()
 {
     if ((m_syncType == DSDSyncDMRDataP)
@@ -444,14 +973,14 @@ void DSDDecoder::processFrameInit()
         if (m_syncType == DSDSyncDMRVoiceP)
         {
             sprintf(m_state.fsubtype, " VOICE        ");
-            m_dsdDMR.initVoice();    // initializations not consuming a live symbol
-            m_dsdDMR.processVoice(); // process current symbol first
+            m_dsdDMR->initVoice();    // initializations not consuming a live symbol
+            m_dsdDMR->processVoice(); // process current symbol first
             m_fsmState = DSDprocessDMRvoice;
         }
         else
         {
-            m_dsdDMR.initData();    // initializations not consuming a live symbol
-            m_dsdDMR.processData(); // process current symbol first
+            m_dsdDMR->initData();    // initializations not consuming a live symbol
+            m_dsdDMR->processData(); // process current symbol first
             m_fsmState = DSDprocessDMRdata;
         }
     }
@@ -473,14 +1002,14 @@ void DSDDecoder::processFrameInit()
         if (m_syncType == DSDSyncDMRVoiceMS)
         {
             sprintf(m_state.fsubtype, " VOICE        ");
-            m_dsdDMR.initVoiceMS();    // initializations not consuming a live symbol
-            m_dsdDMR.processVoiceMS(); // process current symbol first
+            m_dsdDMR->initVoiceMS();    // initializations not consuming a live symbol
+            m_dsdDMR->processVoiceMS(); // process current symbol first
             m_fsmState = DSDprocessDMRvoiceMS;
         }
         else
         {
-            m_dsdDMR.initDataMS();    // initializations not consuming a live symbol
-            m_dsdDMR.processDataMS(); // process current symbol first
+            m_dsdDMR->initDataMS();    // initializations not consuming a live symbol
+            m_dsdDMR->processDataMS(); // process current symbol first
             m_fsmState = DSDprocessDMRdataMS;
         }
 
@@ -502,8 +1031,8 @@ void DSDDecoder::processFrameInit()
 
         m_state.nac = 0;
         sprintf(m_state.fsubtype, " VOICE        ");
-        m_dsdDstar.init();
-        m_dsdDstar.process(); // process current symbol first
+        m_dsdDstar->init();
+        m_dsdDstar->process(); // process current symbol first
         m_fsmState = DSDprocessDSTAR;
     }
     else if ((m_syncType == DSDSyncDStarHeaderP) || (m_syncType == DSDSyncDStarHeaderN)) // D-Star header
@@ -523,8 +1052,8 @@ void DSDDecoder::processFrameInit()
 
         m_state.nac = 0;
         sprintf(m_state.fsubtype, " DATA         ");
-        m_dsdDstar.init(true);
-        m_dsdDstar.processHD(); // process current symbol first
+        m_dsdDstar->init(true);
+        m_dsdDstar->processHD(); // process current symbol first
         m_fsmState = DSDprocessDSTAR_HD;
     }
     else if ((m_syncType == DSDSyncNXDNP) || (m_syncType == DSDSyncNXDNN)) // NXDN full sync with preamble
@@ -544,8 +1073,8 @@ void DSDDecoder::processFrameInit()
 
         m_state.nac = 0;
         sprintf(m_state.fsubtype, " RDCH         ");
-        m_dsdNXDN.init();
-        m_dsdNXDN.process(); // process current symbol first
+        m_dsdNXDN->init();
+        m_dsdNXDN->process(); // process current symbol first
         m_fsmState = DSDprocessNXDN;
     }
     else if (m_syncType == DSDSyncDPMR) // dPMR classic (not packet)
@@ -565,8 +1094,8 @@ void DSDDecoder::processFrameInit()
 
         m_state.nac = 0;
         sprintf(m_state.fsubtype, " ANY          ");
-        m_dsdDPMR.init();
-        m_dsdDPMR.process();
+        m_dsdDPMR->init();
+        m_dsdDPMR->process();
         m_fsmState = DSDprocessDPMR;
     }
     else if (m_syncType == DSDSyncYSF) // YSF
@@ -586,8 +1115,8 @@ void DSDDecoder::processFrameInit()
 
         m_state.nac = 0;
         sprintf(m_state.fsubtype, " ANY          ");
-        m_dsdYSF.init();
-        m_dsdYSF.process();
+        m_dsdYSF->init();
+        m_dsdYSF->process();
         m_fsmState = DSDprocessYSF;
     }
     else
@@ -636,13 +1165,12 @@ int DSDDecoder::getFrameSync()
     }
     else // Sync identification starts here
     {
-        DSDSync syncEngine;
         m_dmrBurstType = DSDDMR::DSDDMRBurstNone;
-        syncEngine.matchAll(m_dsdSymbol.getSyncDibitBack(DSDSync::m_history));
+        m_syncEngine.matchSome(m_dsdSymbol.getSyncDibitRegister(), m_syncPatterns, m_nbSyncPatterns);
 
         if (m_opts.frame_p25p1 == 1)
         {
-            if (syncEngine.isMatching(DSDSync::SyncP25P1))
+            if (m_syncEngine.isMatching(DSDSync::SyncP25P1))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -658,7 +1186,7 @@ int DSDDecoder::getFrameSync()
                 m_mbeRate = DSDMBERate3600x2450;
                 return (int) DSDSyncP25p1P;
             }
-            if (syncEngine.isMatching(DSDSync::SyncP25P1Inv))
+            if (m_syncEngine.isMatching(DSDSync::SyncP25P1Inv))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4, true);
@@ -677,7 +1205,7 @@ int DSDDecoder::getFrameSync()
         }
         if (m_opts.frame_x2tdma == 1)
         {
-            if (syncEngine.isMatching(DSDSync::SyncX2TDMADataBS))
+            if (m_syncEngine.isMatching(DSDSync::SyncX2TDMADataBS))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -695,7 +1223,7 @@ int DSDDecoder::getFrameSync()
                 return (int) DSDSyncX2TDMADataP; // done
             }
 
-            if (syncEngine.isMatching(DSDSync::SyncX2TDMADataMS))
+            if (m_syncEngine.isMatching(DSDSync::SyncX2TDMADataMS))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -713,7 +1241,7 @@ int DSDDecoder::getFrameSync()
                 return (int) DSDSyncX2TDMADataP; // done
             }
 
-            if (syncEngine.isMatching(DSDSync::SyncX2TDMAVoiceBS))
+            if (m_syncEngine.isMatching(DSDSync::SyncX2TDMAVoiceBS))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -731,7 +1259,7 @@ int DSDDecoder::getFrameSync()
                 return (int) DSDSyncX2TDMAVoiceP; // done
             }
 
-            if (syncEngine.isMatching(DSDSync::SyncX2TDMAVoiceMS))
+            if (m_syncEngine.isMatching(DSDSync::SyncX2TDMAVoiceMS))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -751,7 +1279,7 @@ int DSDDecoder::getFrameSync()
         }
         if (m_opts.frame_ysf == 1)
         {
-            if (syncEngine.isMatching(DSDSync::SyncYSF))
+            if (m_syncEngine.isMatching(DSDSync::SyncYSF))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -770,7 +1298,7 @@ int DSDDecoder::getFrameSync()
         }
         if (m_opts.frame_dmr == 1)
         {
-            if (syncEngine.isMatching(DSDSync::SyncDMRDataBS))
+            if (m_syncEngine.isMatching(DSDSync::SyncDMRDataBS))
         	{
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -791,7 +1319,7 @@ int DSDDecoder::getFrameSync()
 				return (int) DSDSyncDMRDataP; // done
         	}
 
-            if (syncEngine.isMatching(DSDSync::SyncDMRDataMS))
+            if (m_syncEngine.isMatching(DSDSync::SyncDMRDataMS))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -812,7 +1340,7 @@ int DSDDecoder::getFrameSync()
                 return (int) DSDSyncDMRDataMS; // done
             }
 
-            if (syncEngine.isMatching(DSDSync::SyncDMRVoiceBS))
+            if (m_syncEngine.isMatching(DSDSync::SyncDMRVoiceBS))
         	{
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -833,7 +1361,7 @@ int DSDDecoder::getFrameSync()
 				return (int) DSDSyncDMRVoiceP; // done
         	}
 
-            if (syncEngine.isMatching(DSDSync::SyncDMRVoiceMS))
+            if (m_syncEngine.isMatching(DSDSync::SyncDMRVoiceMS))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -856,7 +1384,7 @@ int DSDDecoder::getFrameSync()
         }
         if (m_opts.frame_provoice == 1)
         {
-            if (syncEngine.isMatching(DSDSync::SyncProVoice) || syncEngine.isMatching(DSDSync::SyncProVoiceEA))
+            if (m_syncEngine.isMatching(DSDSync::SyncProVoice) || m_syncEngine.isMatching(DSDSync::SyncProVoiceEA))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -872,7 +1400,7 @@ int DSDDecoder::getFrameSync()
                 m_mbeRate = DSDMBERate3600x2450;
                 return (int) DSDSyncProVoiceP; // done
             }
-            else if (syncEngine.isMatching(DSDSync::SyncProVoiceInv) || syncEngine.isMatching(DSDSync::SyncProVoiceEAInv))
+            else if (m_syncEngine.isMatching(DSDSync::SyncProVoiceInv) || m_syncEngine.isMatching(DSDSync::SyncProVoiceEAInv))
             {
                 m_state.carrier = 1;
                 m_state.offset = m_synctest_pos;
@@ -893,7 +1421,7 @@ int DSDDecoder::getFrameSync()
         }
         if ((m_opts.frame_nxdn96 == 1) || (m_opts.frame_nxdn48 == 1))
         {
-            if (syncEngine.isMatching(DSDSync::SyncNXDNRDCHFull)) // long sync (with preamble)
+            if (m_syncEngine.isMatching(DSDSync::SyncNXDNRDCHFull)) // long sync (with preamble)
             {
                 m_nxdnInterSyncCount = 0;
 				m_state.carrier = 1;
@@ -922,7 +1450,7 @@ int DSDDecoder::getFrameSync()
 				m_mbeRate = DSDMBERate3600x2450;
 				return (int) DSDSyncNXDNP; // done
             }
-            else if (syncEngine.isMatching(DSDSync::SyncNXDNRDCHFullInv)) // long sync (with preamble) inverted
+            else if (m_syncEngine.isMatching(DSDSync::SyncNXDNRDCHFullInv)) // long sync (with preamble) inverted
             {
                 m_nxdnInterSyncCount = 0;
 				m_state.carrier = 1;
@@ -951,7 +1479,7 @@ int DSDDecoder::getFrameSync()
 				m_mbeRate = DSDMBERate3600x2450;
 				return (int) DSDSyncNXDNN; // done
             }
-            else if (syncEngine.isMatching(DSDSync::SyncNXDNRDCHFSW)) // short sync
+            else if (m_syncEngine.isMatching(DSDSync::SyncNXDNRDCHFSW)) // short sync
             {
                 if ((m_nxdnInterSyncCount > 0) && (m_nxdnInterSyncCount % 192 == 0))
                 {
@@ -985,7 +1513,7 @@ int DSDDecoder::getFrameSync()
                     m_nxdnInterSyncCount = 0;
                 }
             }
-            else if (syncEngine.isMatching(DSDSync::SyncNXDNRDCHFSWInv)) // short sync inverted
+            else if (m_syncEngine.isMatching(DSDSync::SyncNXDNRDCHFSWInv)) // short sync inverted
             {
                 if ((m_nxdnInterSyncCount > 0) && (m_nxdnInterSyncCount % 192 == 0))
                 {
@@ -1022,7 +1550,7 @@ int DSDDecoder::getFrameSync()
         }
         if (m_opts.frame_dpmr == 1)
         {
-            if (syncEngine.isMatching(DSDSync::SyncDPMRFS1)) // dPMR classic (not packet)
+            if (m_syncEngine.isMatching(DSDSync::SyncDPMRFS1)) // dPMR classic (not packet)
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(4);
@@ -1041,7 +1569,7 @@ int DSDDecoder::getFrameSync()
         }
         if (m_opts.frame_dstar == 1)
         {
-            if (syncEngine.isMatching(DSDSync::SyncDStar))
+            if (m_syncEngine.isMatching(DSDSync::SyncDStar))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(2);
@@ -1057,7 +1585,7 @@ int DSDDecoder::getFrameSync()
                 m_mbeRate = DSDMBERate3600x2400;
                 return (int) DSDSyncDStarP;
             }
-            if (syncEngine.isMatching(DSDSync::SyncDStarInv))
+            if (m_syncEngine.isMatching(DSDSync::SyncDStarInv))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(2, true);
@@ -1073,7 +1601,7 @@ int DSDDecoder::getFrameSync()
                 m_mbeRate = DSDMBERate3600x2400;
                 return (int) DSDSyncDStarN; // done
             }
-            if (syncEngine.isMatching(DSDSync::SyncDStarHeader))
+            if (m_syncEngine.isMatching(DSDSync::SyncDStarHeader))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(2);
@@ -1089,7 +1617,7 @@ int DSDDecoder::getFrameSync()
                 m_mbeRate = DSDMBERate3600x2400;
                 return (int) DSDSyncDStarHeaderP; // done
             }
-            if (syncEngine.isMatching(DSDSync::SyncDStarHeaderInv))
+            if (m_syncEngine.isMatching(DSDSync::SyncDStarHeaderInv))
             {
                 m_state.carrier = 1;
                 m_dsdSymbol.setFSK(2, true);
@@ -17,10 +17,14 @@
 #ifndef DSDCC_DSD_DECODER_H_
 #define DSDCC_DSD_DECODER_H_
 
+#include <cstddef>
+
 #include "dsd_opts.h"
 #include "dsd_state.h"
 #include "dsd_logger.h"
 #include "dsd_symbol.h"
+#include "dsd_sync.h"
+#include "dsd_stats.h"
 #include "dsd_mbe.h"
 #include "dmr.h"
 #include "ysf.h"
@@ -153,6 +157,14 @@ public:
     ~DSDDecoder();
 
     void run(short sample);
+    /**
+     * Push a block of samples. This is equivalent to calling run() for each sample but saves the per sample call overhead.
+     * Processing stops right after a new DVSI frame has been made ready so that the caller can fetch it
+     * before it gets overwritten thus the number of samples consumed may be less than nbSamples.
+     * nbSymbols returns the number of symbols retrieved and nbAudioFrames the number of audio frames produced
+     * by both MBE decoders. Returns the number of samples consumed.
+     */
+    std::size_t runBlock(const short *samples, std::size_t nbSamples, int& nbSymbols, int& nbAudioFrames);
     short getFilteredSample() const { return m_dsdSymbol.getFilteredSample(); }
     short getSymbolSyncSample() const { return m_dsdSymbol.getSymbolSyncSample(); }
 
@@ -204,6 +216,20 @@ public:
         m_mbeDecoder2.resetAudio();
     }
 
+    /** Zero copy audio ring access. May be used from another thread than the one running the decoder */
+    const short *getAudioView1(int& nbSamples) const { return m_mbeDecoder1.getAudioView(nbSamples); }
+    void releaseAudio1(int nbSamples) { m_mbeDecoder1.releaseAudio(nbSamples); }
+    const short *getAudioView2(int& nbSamples) const { return m_mbeDecoder2.getAudioView(nbSamples); }
+    void releaseAudio2(int nbSamples) { m_mbeDecoder2.releaseAudio(nbSamples); }
+    unsigned int getAudioOverruns1() const { return m_mbeDecoder1.getAudioOverruns(); }
+    unsigned int getAudioOverruns2() const { return m_mbeDecoder2.getAudioOverruns(); }
+    /** Audio ring capacity of each slot in S16 items. Default is 1s of 48 kS/s stereo. Call before decoding */
+    void setAudioRingSize(unsigned int nbShorts)
+    {
+        m_mbeDecoder1.setAudioRingSize(nbShorts);
+        m_mbeDecoder2.setAudioRingSize(nbShorts);
+    }
+
     //DSDOpts *getOpts() { return &m_opts; }
     //DSDState *getState() { return &m_state; }
 
@@ -225,18 +251,25 @@ public:
     int getSymbolSyncQuality() const { return m_dsdSymbol.getSymbolSyncQuality(); }
     int getSamplesPerSymbol() const { return m_dsdSymbol.getSamplesPerSymbol(); }
     DSDRate getDataRate() const { return m_dataRate; };
+    const DSDSync::SyncPattern *getSyncPatterns(int& nbPatterns) const { nbPatterns = m_nbSyncPatterns; return m_syncPatterns; } //!< Patterns currently searched for
     bool getVoice1On() const { return m_voice1On; }
     bool getVoice2On() const { return m_voice2On; }
     void setTDMAStereo(bool tdmaStereo);
     void formatStatusText(char *statusText);
     bool getSymbolPLLLocked() const { return m_dsdSymbol.getPLLLocked(); }
 
-    const DSDDMR& getDMRDecoder() const { return m_dsdDMR; }
-    const DSDDstar& getDStarDecoder() const { return m_dsdDstar; }
-    const DSDdPMR& getDPMRDecoder() const { return m_dsdDPMR; }
-    const DSDYSF& getYSFDecoder() const { return m_dsdYSF; }
-    const DSDNXDN& getNXDNDecoder() const { return m_dsdNXDN; }
+    // Protocol decoders are allocated when their mode is enabled. Modes never enabled get a shared idle decoder
+    const DSDDMR& getDMRDecoder() const;
+    const DSDDstar& getDStarDecoder() const;
+    const DSDdPMR& getDPMRDecoder() const;
+    const DSDYSF& getYSFDecoder() const;
+    const DSDNXDN& getNXDNDecoder() const;
     void enableMbelib(bool enable) { m_mbelibEnable = enable; }
+    void setAsyncVocoder(bool async); //!< run mbelib synthesis of both slots in their own threads
+    bool getAsyncVocoder() const { return m_mbeDecoder1.getAsync(); }
+    unsigned int getVocoderPendingFrames() const { return m_mbeDecoder1.getNbPendingFrames() + m_mbeDecoder2.getNbPendingFrames(); }
+    unsigned int getVocoderDroppedFrames() const { return m_mbeDecoder1.getNbDroppedFrames() + m_mbeDecoder2.getNbDroppedFrames(); }
+    void getStats(DSDStatsSnapshot& snapshot) const { m_stats.getSnapshot(snapshot); } //!< per stage cycles (needs DSD_INSTRUMENTATION)
 
     // Initializations:
     void setQuiet();
@@ -246,6 +279,7 @@ public:
     void setP25DisplayOptions(DSDShowP25 mode, bool on);
     void muteEncryptedP25(bool on);
     void setDecodeMode(DSDDecodeMode mode, bool on);
+    void setSoftDecision(DSDDecodeMode mode, bool on); //!< soft decision Viterbi decoding for D-Star, YSF or NXDN
     void setAudioGain(float gain);
     void setUvQuality(int uvquality);
     void setUpsampling(int upsampling);
@@ -255,14 +289,23 @@ public:
     void enableAudioOut(bool on);
     void enableScanResumeAfterTDULCFrames(int nbFrames);
     void setDataRate(DSDRate dataRate);
+    /**
+     * Hunt for sync at 2400, 4800 and 9600 baud at the same time while no frame is being processed.
+     * The first rate at which a sync of an enabled mode is found becomes the current data rate.
+     * With DSDDecodeAuto the modes of all data rates are enabled.
+     */
+    void setMultiRateSync(bool on);
     void setMyPoint(float lat, float lon) { m_myPoint.setLatLon(lat, lon); }
     void setSymbolPLLLock(bool pllLock) { m_dsdSymbol.setPLLLock(pllLock); }
+    void setSymbolFixedPoint(bool fixedPoint) { m_dsdSymbol.setFixedPoint(fixedPoint); } //!< Q15 symbol timing recovery for targets without a fast FPU
     void setDMRBasicPrivacyKey(unsigned char key);
 
     // parameter getters:
 
     int upsampling() const { return m_mbeDecoder1.getUpsamplingFactor(); }
+    bool stereo() const { return m_mbeDecoder1.getStereo(); }
 
+    bool getMultiRateSync() const { return m_multiRateSync; }
     DSDMBERate getMbeRate() const { return m_mbeRate; }
     void setMbeRate(DSDMBERate mbeRate) { m_mbeRate = mbeRate; }
 
@@ -282,8 +325,29 @@ private:
         signalFormatNXDN
     } SignalFormat;
 
+    struct RateBranch //!< symbol recovery hunting for sync at another data rate than the current one
+    {
+        DSDRate m_rate;
+        DSDSymbol *m_symbol;
+        DSDSync::SyncPattern m_syncPatterns[DSDSync::m_patterns];
+        int m_nbSyncPatterns;
+        int m_nbSymbols; //!< symbols retrieved since the hunt started
+    };
+
+    bool runSample(short sample); //!< returns true if a symbol was retrieved
+    bool runMultiRateSample(short sample); //!< push the sample to the symbol recovery of all rates. Returns true if a symbol was retrieved at the current rate
+    void processSymbol(); //!< run the state machine on the symbol just retrieved
+    bool commitRate(const RateBranch& branch); //!< returns true if the rate was changed and the sample history replayed
+    bool confirmSync(DSDRate dataRate); //!< look for a sync at the end of the sample history with a fresh symbol recovery at this rate without decoding
+    void replaySamples(); //!< run the sample history through the symbol recovery and the state machine at the current rate
     int getFrameSync();
     void resetFrameSync();
+    DSDStatsSnapshot::Stage getStatsStage() const;
+    void updateSyncPatterns();
+    int getSyncPatterns(DSDRate dataRate, DSDSync::SyncPattern *syncPatterns) const;
+    void allocateDecoders(); //!< allocate the frame decoders of the enabled modes
+    static const DSDDecoder& idleDecoder(); //!< never runs. Holds the frame decoders given for the modes never enabled
+    static DSDDecoder *createIdleDecoder();
     void printFrameSync(const char *frametype, int offset);
     void noCarrier();
     void printFrameInfo();
@@ -299,6 +363,9 @@ private:
     DSDDMR::DSDDMRBurstType m_dmrBurstType;
     // sync engine:
     int m_sync; //!< The current internal sync type
+    DSDSync m_syncEngine;
+    DSDSync::SyncPattern m_syncPatterns[DSDSync::m_patterns]; //!< Sync patterns searched for with the current modes and data rate
+    int m_nbSyncPatterns;
     int m_dibit, m_synctest_pos;
     int m_lsum;
     char m_spectrum[64];
@@ -307,6 +374,17 @@ private:
     int m_nxdnInterSyncCount;
     // Symbol extraction and operations
     DSDSymbol m_dsdSymbol;
+    // Multiple rate sync hunting
+    bool m_multiRateSync;
+    bool m_autoDecode;
+    RateBranch m_rateBranches[3];
+    DSDSymbol *m_confirmSymbol;     //!< symbol recovery of the sync confirmation dry run
+    DSDFilters *m_frontEndFilters;  //!< matched filters shared by the current rate and the hunting branches
+    short *m_sampleHistory;         //!< last input samples replayed at the new rate when a branch finds sync
+    unsigned int m_sampleHistoryIndex;
+    static const unsigned int m_sampleHistorySize = 8192; //!< power of two
+    // Per stage instrumentation
+    DSDStats m_stats;
     // MBE decoder
     char ambe_fr[4][24];
     char imbe_fr[8][23];
@@ -322,12 +400,12 @@ private:
     // Voice announcements
     bool m_voice1On;
     bool m_voice2On;
-    // Frame decoders
-    DSDDMR m_dsdDMR;
-    DSDDstar m_dsdDstar;
-    DSDYSF m_dsdYSF;
-    DSDdPMR m_dsdDPMR;
-    DSDNXDN m_dsdNXDN;
+    // Frame decoders. Allocated when the mode is first enabled and kept until destruction
+    DSDDMR *m_dsdDMR;
+    DSDDstar *m_dsdDstar;
+    DSDYSF *m_dsdYSF;
+    DSDdPMR *m_dsdDPMR;
+    DSDNXDN *m_dsdNXDN;
     DSDRate m_dataRate;
     DSDSyncType m_syncType;
     DSDSyncType m_lastSyncType;
@@ -0,0 +1,278 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "dsd_decoder_pool.h"
+
+namespace DSDcc
+{
+
+DSDDecoderPool::Channel::Channel(unsigned int sampleQueueSize, unsigned int audioQueueSize) :
+        m_samples(sampleQueueSize),
+        m_audio1(audioQueueSize),
+        m_audio2(audioQueueSize),
+        m_status(64),
+        m_busy(false),
+        m_droppedSamples(0),
+        m_droppedAudio(0),
+        m_stolen(0)
+{
+    m_lastStatus.m_syncType = DSDDecoder::DSDSyncNone;
+    m_lastStatus.m_stationType = DSDDecoder::DSDStationTypeNotApplicable;
+    m_lastStatus.m_voice1On = false;
+    m_lastStatus.m_voice2On = false;
+    // audio is moved to the channel queues after each block so the decoder rings only need a few frames
+    m_decoder.setAudioRingSize(m_decoderAudioRingSize);
+}
+
+DSDDecoderPool::DSDDecoderPool(unsigned int nbChannels,
+        unsigned int nbWorkers,
+        unsigned int sampleQueueSize,
+        unsigned int audioQueueSize) :
+    m_nbWorkers(nbWorkers),
+    m_running(false),
+    m_affinity(false)
+{
+    if (m_nbWorkers == 0) {
+        m_nbWorkers = std::thread::hardware_concurrency();
+    }
+
+    if (m_nbWorkers == 0) { // unknown
+        m_nbWorkers = 1;
+    }
+
+    if (m_nbWorkers > nbChannels) {
+        m_nbWorkers = nbChannels;
+    }
+
+    for (unsigned int i = 0; i < nbChannels; i++) {
+        m_channels.push_back(new Channel(sampleQueueSize, audioQueueSize));
+    }
+}
+
+DSDDecoderPool::~DSDDecoderPool()
+{
+    stop();
+
+    for (unsigned int i = 0; i < m_channels.size(); i++) {
+        delete m_channels[i];
+    }
+}
+
+void DSDDecoderPool::start()
+{
+    if (m_running.load()) {
+        return;
+    }
+
+    m_running.store(true);
+
+    for (unsigned int i = 0; i < m_nbWorkers; i++)
+    {
+        m_workers.push_back(std::thread(&DSDDecoderPool::work, this, i));
+#if defined(__linux__)
+        if (m_affinity)
+        {
+            unsigned int nbCores = std::thread::hardware_concurrency();
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(nbCores > 0 ? i % nbCores : 0, &cpuset);
+            pthread_setaffinity_np(m_workers.back().native_handle(), sizeof(cpu_set_t), &cpuset);
+        }
+#endif
+    }
+}
+
+void DSDDecoderPool::stop()
+{
+    m_running.store(false);
+
+    for (unsigned int i = 0; i < m_workers.size(); i++) {
+        m_workers[i].join();
+    }
+
+    m_workers.clear();
+}
+
+unsigned int DSDDecoderPool::pushSamples(unsigned int channel, const short *samples, unsigned int nbSamples)
+{
+    Channel& c = *m_channels[channel];
+    unsigned int written = c.m_samples.write(samples, nbSamples);
+
+    if (written < nbSamples) {
+        c.m_droppedSamples.fetch_add(nbSamples - written, std::memory_order_relaxed);
+    }
+
+    return written;
+}
+
+unsigned int DSDDecoderPool::readAudio1(unsigned int channel, short *audio, unsigned int nbShorts)
+{
+    return m_channels[channel]->m_audio1.read(audio, nbShorts);
+}
+
+unsigned int DSDDecoderPool::readAudio2(unsigned int channel, short *audio, unsigned int nbShorts)
+{
+    return m_channels[channel]->m_audio2.read(audio, nbShorts);
+}
+
+bool DSDDecoderPool::readStatus(unsigned int channel, ChannelStatus& status)
+{
+    return m_channels[channel]->m_status.pop(status);
+}
+
+void DSDDecoderPool::work(unsigned int workerIndex)
+{
+    short *block = new short[m_blockSize];
+    unsigned int nbChannels = m_channels.size();
+
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        bool done = false;
+
+        // home channels first
+        for (unsigned int i = workerIndex; i < nbChannels; i += m_nbWorkers) {
+            done = tryRun(*m_channels[i], block) || done;
+        }
+
+        // then help with the backlog of other workers
+        if (!done)
+        {
+            for (unsigned int i = 0; i < nbChannels; i++)
+            {
+                if ((i % m_nbWorkers == workerIndex) || (m_channels[i]->m_samples.readable() < m_stealThreshold)) {
+                    continue;
+                }
+
+                if (tryRun(*m_channels[i], block))
+                {
+                    m_channels[i]->m_stolen.fetch_add(1, std::memory_order_relaxed);
+                    done = true;
+                }
+            }
+        }
+
+        if (!done) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+
+    delete[] block;
+}
+
+bool DSDDecoderPool::tryRun(Channel& channel, short *block)
+{
+    bool idle = channel.m_samples.readable() == 0;
+
+    if (idle && !channel.m_decoder.getAsyncVocoder()) {
+        return false;
+    }
+
+    bool expected = false;
+
+    if (!channel.m_busy.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        return false; // run by another worker
+    }
+
+    if (idle) // the vocoder threads may still produce audio
+    {
+        drainAudio(channel);
+        channel.m_busy.store(false, std::memory_order_release);
+        return false;
+    }
+
+    unsigned int nbSamples = channel.m_samples.read(block, m_blockSize);
+    runChannel(channel, block, nbSamples);
+    channel.m_busy.store(false, std::memory_order_release);
+
+    return nbSamples > 0;
+}
+
+void DSDDecoderPool::runChannel(Channel& channel, short *block, unsigned int nbSamples)
+{
+    DSDDecoder& decoder = channel.m_decoder;
+    std::size_t consumed = 0;
+    int nbSymbols, nbAudioFrames;
+
+    while (consumed < nbSamples)
+    {
+        consumed += decoder.runBlock(&block[consumed], nbSamples - consumed, nbSymbols, nbAudioFrames);
+        drainAudio(channel); // not only when nbAudioFrames > 0 as the asynchronous vocoder delivers audio later
+    }
+
+    pushStatus(channel);
+}
+
+void DSDDecoderPool::drainAudio(Channel& channel)
+{
+    DSDDecoder& decoder = channel.m_decoder;
+    int nbAudioSamples;
+    const short *audio;
+    unsigned int shortsPerSample = decoder.stereo() ? 2 : 1;
+
+    audio = decoder.getAudioView1(nbAudioSamples);
+
+    while (nbAudioSamples > 0) // twice when the ring wraps around
+    {
+        pushAudio(channel, channel.m_audio1, audio, nbAudioSamples * shortsPerSample);
+        decoder.releaseAudio1(nbAudioSamples);
+        audio = decoder.getAudioView1(nbAudioSamples);
+    }
+
+    audio = decoder.getAudioView2(nbAudioSamples);
+
+    while (nbAudioSamples > 0) // twice when the ring wraps around
+    {
+        pushAudio(channel, channel.m_audio2, audio, nbAudioSamples * shortsPerSample);
+        decoder.releaseAudio2(nbAudioSamples);
+        audio = decoder.getAudioView2(nbAudioSamples);
+    }
+}
+
+void DSDDecoderPool::pushAudio(Channel& channel, SPSCQueue<short>& queue, const short *audio, unsigned int nbShorts)
+{
+    unsigned int written = queue.write(audio, nbShorts);
+
+    if (written < nbShorts) {
+        channel.m_droppedAudio.fetch_add(nbShorts - written, std::memory_order_relaxed);
+    }
+}
+
+void DSDDecoderPool::pushStatus(Channel& channel)
+{
+    const DSDDecoder& decoder = channel.m_decoder;
+    ChannelStatus& status = channel.m_lastStatus;
+
+    if ((status.m_syncType != decoder.getSyncType())
+     || (status.m_stationType != decoder.getStationType())
+     || (status.m_voice1On != decoder.getVoice1On())
+     || (status.m_voice2On != decoder.getVoice2On()))
+    {
+        status.m_syncType = decoder.getSyncType();
+        status.m_stationType = decoder.getStationType();
+        status.m_voice1On = decoder.getVoice1On();
+        status.m_voice2On = decoder.getVoice2On();
+        channel.m_status.push(status); // dropped if the consumer does not keep up
+    }
+}
+
+} // namespace DSDcc
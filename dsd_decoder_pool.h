@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_DECODER_POOL_H_
+#define DSDCC_DSD_DECODER_POOL_H_
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "dsd_decoder.h"
+#include "spscqueue.h"
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Runs a number of independent decoder channels on a set of worker threads.
+ *
+ * Each channel has a home worker but an idle worker takes over channels with pending samples
+ * of a busy worker (work stealing). A channel is only ever run by one worker at a time.
+ * Samples are pushed and audio and status are read through lock free SPSC queues so there must be
+ * only one producer thread and one consumer thread per channel.
+ * Decoders should be configured with getDecoder() only while the pool is stopped.
+ * Channels share no mutable decoding state except mbelib which is not known to be reentrant:
+ * its calls are serialized across all decoders so the vocoder stage does not scale with the workers.
+ */
+class DSDCC_API DSDDecoderPool
+{
+public:
+    struct ChannelStatus //!< Pushed to the status queue each time it changes
+    {
+        DSDDecoder::DSDSyncType m_syncType;
+        DSDDecoder::DSDStationType m_stationType;
+        bool m_voice1On;
+        bool m_voice2On;
+    };
+
+    DSDDecoderPool(unsigned int nbChannels,
+            unsigned int nbWorkers = 0,          //!< 0 for one per hardware thread
+            unsigned int sampleQueueSize = 1<<16,
+            unsigned int audioQueueSize = 1<<15);
+    ~DSDDecoderPool();
+
+    unsigned int getNbChannels() const { return m_channels.size(); }
+    unsigned int getNbWorkers() const { return m_nbWorkers; }
+    DSDDecoder& getDecoder(unsigned int channel) { return m_channels[channel]->m_decoder; }
+    void setAffinity(bool affinity) { m_affinity = affinity; } //!< pin worker threads to cores (Linux only) on next start
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    /** Producer side. Returns the number of samples queued. Samples that do not fit are dropped and counted */
+    unsigned int pushSamples(unsigned int channel, const short *samples, unsigned int nbSamples);
+    /** Consumer side. Audio is S16 (L+R interleaved when stereo). Returns the number of shorts read */
+    unsigned int readAudio1(unsigned int channel, short *audio, unsigned int nbShorts);
+    unsigned int readAudio2(unsigned int channel, short *audio, unsigned int nbShorts);
+    bool readStatus(unsigned int channel, ChannelStatus& status);
+
+    unsigned int getPendingSamples(unsigned int channel) const { return m_channels[channel]->m_samples.readable(); }
+    unsigned int getDroppedSamples(unsigned int channel) const { return m_channels[channel]->m_droppedSamples.load(); }
+    unsigned int getDroppedAudio(unsigned int channel) const { return m_channels[channel]->m_droppedAudio.load(); }
+    unsigned int getStolen(unsigned int channel) const { return m_channels[channel]->m_stolen.load(); } //!< times run by another worker than home
+
+private:
+    struct Channel
+    {
+        Channel(unsigned int sampleQueueSize, unsigned int audioQueueSize);
+
+        DSDDecoder m_decoder;
+        SPSCQueue<short> m_samples;
+        SPSCQueue<short> m_audio1;
+        SPSCQueue<short> m_audio2;
+        SPSCQueue<ChannelStatus> m_status;
+        ChannelStatus m_lastStatus;
+        std::atomic<bool> m_busy;  //!< owned by a worker
+        std::atomic<unsigned int> m_droppedSamples;
+        std::atomic<unsigned int> m_droppedAudio;
+        std::atomic<unsigned int> m_stolen;
+    };
+
+    static const unsigned int m_blockSize = 960; //!< samples processed per channel turn (20ms at 48 kS/s)
+    static const unsigned int m_stealThreshold = 2*m_blockSize; //!< minimum backlog for a channel to be stolen
+    static const unsigned int m_decoderAudioRingSize = 8192;    //!< audio ring of each decoder slot in S16 items (3 stereo 48 kS/s frames)
+
+    void work(unsigned int workerIndex);
+    bool tryRun(Channel& channel, short *block);
+    void runChannel(Channel& channel, short *block, unsigned int nbSamples);
+    void drainAudio(Channel& channel);
+    void pushAudio(Channel& channel, SPSCQueue<short>& queue, const short *audio, unsigned int nbShorts);
+    void pushStatus(Channel& channel);
+
+    std::vector<Channel*> m_channels;
+    std::vector<std::thread> m_workers;
+    unsigned int m_nbWorkers;
+    std::atomic<bool> m_running;
+    bool m_affinity;
+};
+
+} // namespace DSDcc
+
+#endif /* DSDCC_DSD_DECODER_POOL_H_ */
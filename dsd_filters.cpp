@@ -16,6 +16,15 @@
 
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__AVX__) || defined(__SSE__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "dsd_filters.h"
 
 namespace DSDcc
@@ -123,82 +132,150 @@ const float DSDFilters::dpmrcoeffs[] =
         0.0275919612, 0.0232592816, 0.0179185547, 0.0119748846,
         0.0058388841, -0.0000983004};
 
-DSDFilters::DSDFilters()
+static void padCoefficients(float *padded, int paddedSize, const float *coeffs, int nbTaps, float gain)
 {
-    for (int i=0; i < NZEROS+1; i++) {
-        xv[i] = 0.0f;
+    int pad = paddedSize - nbTaps;
+
+    for (int i = 0; i < pad; i++) {
+        padded[i] = 0.0f; // applies to samples older than the filter length
     }
 
-    for (int i=0; i < NXZEROS+1; i++) {
-        nxv[i] = 0.0f;
+    for (int i = 0; i < nbTaps; i++) {
+        padded[pad + i] = coeffs[i] / gain;
     }
 }
 
+DSDFilters::SIMDCoefficients::SIMDCoefficients()
+{
+    padCoefficients(m_x, NZEROS_SIMD, xcoeffs, NZEROS+1, ngain);
+    padCoefficients(m_nx, NXZEROS_SIMD, nxcoeffs, NXZEROS+1, nxgain);
+    padCoefficients(m_dmr, NZEROS_SIMD, dmrcoeffs, NZEROS+1, dmrgain);
+    padCoefficients(m_dpmr, NXZEROS_SIMD, dpmrcoeffs, NXZEROS+1, dpmrgain);
+}
+
+const DSDFilters::SIMDCoefficients& DSDFilters::getSIMDCoefficients()
+{
+    static const SIMDCoefficients simdCoeffs;
+    return simdCoeffs;
+}
+
+float DSDFIRKernel::dotProduct(const float *a, const float *b, int n)
+{
+#if defined(__AVX__)
+    __m256 acc0 = _mm256_setzero_ps();
+
+    for (int i = 0; i < n; i += 8) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(&a[i]), _mm256_loadu_ps(&b[i])));
+    }
+
+    __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc);
+#elif defined(__SSE__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    for (int i = 0; i < n; i += 8)
+    {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&a[i]), _mm_loadu_ps(&b[i])));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&a[i+4]), _mm_loadu_ps(&b[i+4])));
+    }
+
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc);
+#elif defined(__ARM_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+
+    for (int i = 0; i < n; i += 8)
+    {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(&a[i]), vld1q_f32(&b[i]));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(&a[i+4]), vld1q_f32(&b[i+4]));
+    }
+
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t acc2 = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    return vget_lane_f32(vpadd_f32(acc2, acc2), 0);
+#else
+    float sum = 0.0f;
+
+    for (int i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+#endif
+}
+
+DSDFilters::DSDFilters() :
+        m_simdCoeffs(&getSIMDCoefficients())
+{
+}
+
 DSDFilters::~DSDFilters()
 {
 }
 
 short DSDFilters::dmr_filter(short sample) // all 4800 baud filters for now
 {
-    return dsd_input_filter(sample, 3);
+    return (short) xv.run(sample, m_simdCoeffs->m_dmr);
 }
 
 short DSDFilters::nxdn_filter(short sample) // all 2400 baud filters for now
 {
-    return dsd_input_filter(sample, 4);
+    return (short) nxv.run(sample, m_simdCoeffs->m_dpmr);
 }
 
-short DSDFilters::dsd_input_filter(short sample, int mode)
+void DSDFilters::dmr_filter(const short *in, short *out, int nbSamples)
+{
+    for (int i = 0; i < nbSamples; i++) {
+        out[i] = (short) xv.run(in[i], m_simdCoeffs->m_dmr);
+    }
+}
+
+void DSDFilters::nxdn_filter(const short *in, short *out, int nbSamples)
 {
-    float sum;
-    int i;
-    float gain;
-    int zeros;
-    float *v;
-    const float *coeffs;
+    for (int i = 0; i < nbSamples; i++) {
+        out[i] = (short) nxv.run(in[i], m_simdCoeffs->m_dpmr);
+    }
+}
 
+short DSDFilters::dsd_input_filter(short sample, int mode)
+{
     switch (mode)
     {
     case 1:
-        gain = ngain;
-        v = xv;
-        coeffs = xcoeffs;
-        zeros = NZEROS;
-        break;
+        return (short) xv.run(sample, m_simdCoeffs->m_x);
     case 2:
-        gain = nxgain;
-        v = nxv;
-        coeffs = nxcoeffs;
-        zeros = NXZEROS;
-        break;
+        return (short) nxv.run(sample, m_simdCoeffs->m_nx);
     case 3:
-        gain = dmrgain;
-        v = xv;
-        coeffs = dmrcoeffs;
-        zeros = NZEROS;
-        break;
+        return (short) xv.run(sample, m_simdCoeffs->m_dmr);
     case 4:
-        gain = dpmrgain;
-        v = nxv;
-        coeffs = dpmrcoeffs;
-        zeros = NXZEROS;
-        break;
+        return (short) nxv.run(sample, m_simdCoeffs->m_dpmr);
     default:
         return sample;
     }
+}
 
-    for (i = 0; i < zeros; i++) {
-        v[i] = v[i + 1];
-    }
-
-    v[zeros] = sample; // unfiltered sample in
-    sum = 0.0f;
-
-    for (i = 0; i <= zeros; i++) {
-        sum += (coeffs[i] * v[i]);
+void DSDFilters::dsd_input_filter(const short *in, short *out, int nbSamples, int mode)
+{
+    switch (mode)
+    {
+    case 3:
+        dmr_filter(in, out, nbSamples);
+        break;
+    case 4:
+        nxdn_filter(in, out, nbSamples);
+        break;
+    default:
+        for (int i = 0; i < nbSamples; i++) {
+            out[i] = dsd_input_filter(in[i], mode);
+        }
+        break;
     }
-
-    return (short) (sum / gain); // filtered sample out
 }
 
 // ====================================================================
@@ -227,7 +304,7 @@ void DSDSecondOrderRecursiveFilter::setR(float r)
 
 short DSDSecondOrderRecursiveFilter::run(short sample)
 {
-	m_v[0] = ((1.0f - m_r) * (float) sample) + (2.0f * m_r * cos(2.0*M_PI*m_frequencyRatio) * m_v[1]) - (m_r * m_r * m_v[2]);
+	m_v[0] = (m_a0 * (float) sample) + (m_a1 * m_v[1]) - (m_a2 * m_v[2]);
 	float y = m_v[0] - m_v[2];
 	m_v[2] = m_v[1];
 	m_v[1] = m_v[0];
@@ -235,11 +312,32 @@ short DSDSecondOrderRecursiveFilter::run(short sample)
 	return (short) y;
 }
 
+short DSDSecondOrderRecursiveFilter::runQ15(short sample)
+{
+	int64_t acc = (int64_t) m_a0Q30 * (((int32_t) sample) << 8)
+		+ (int64_t) m_a1Q30 * m_vQ8[1]
+		- (int64_t) m_a2Q30 * m_vQ8[2];
+	m_vQ8[0] = (int32_t) ((acc + (1<<29)) >> 30);
+	int32_t y = (m_vQ8[0] - m_vQ8[2]) >> 8;
+	m_vQ8[2] = m_vQ8[1];
+	m_vQ8[1] = m_vQ8[0];
+
+	return y > 32767 ? 32767 : y < -32768 ? -32768 : (short) y;
+}
+
 void DSDSecondOrderRecursiveFilter::init()
 {
+	m_a0 = 1.0f - m_r;
+	m_a1 = 2.0f * m_r * cos(2.0*M_PI*m_frequencyRatio);
+	m_a2 = m_r * m_r;
+	m_a0Q30 = lrint(m_a0 * 1073741824.0);
+	m_a1Q30 = lrint(m_a1 * 1073741824.0);
+	m_a2Q30 = lrint(m_a2 * 1073741824.0);
+
 	for (int i = 0; i < 3; i++)
 	{
 		m_v[i] = 0.0f;
+		m_vQ8[i] = 0;
 	}
 }
 
@@ -276,4 +374,14 @@ float DSDMBEAudioInterpolatorFilter::runLP(const float& sample)
     return m_filterLP.run(sample);
 }
 
+void DSDMBEAudioInterpolatorFilter::runHP(const float *in, float *out, unsigned int nbSamples)
+{
+    m_filterHP.run(in, out, nbSamples);
+}
+
+void DSDMBEAudioInterpolatorFilter::runLP(const float *in, float *out, unsigned int nbSamples)
+{
+    m_filterLP.run(in, out, nbSamples);
+}
+
 } // namespace dsdcc
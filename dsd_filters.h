@@ -19,6 +19,10 @@
 
 #define NZEROS 60
 #define NXZEROS 134
+#define NZEROS_SIMD 64   //!< NZEROS+1 taps rounded up to a multiple of 8
+#define NXZEROS_SIMD 136 //!< NXZEROS+1 taps rounded up to a multiple of 8
+
+#include <stdint.h>
 
 #include "iirfilter.h"
 #include "export.h"
@@ -26,6 +30,48 @@
 namespace DSDcc
 {
 
+/**
+ * \Brief: Inner product kernel of FIR filters. It is vectorized with AVX, SSE or NEON when available.
+ */
+class DSDCC_API DSDFIRKernel
+{
+public:
+    static float dotProduct(const float *a, const float *b, int n); //!< n must be a multiple of 8
+};
+
+/**
+ * \Brief: Delay line of a FIR filter. Samples are stored twice in a circular buffer of twice the number of taps
+ * so that the last NbTaps samples always form a contiguous window starting with the oldest sample.
+ */
+template<int NbTaps>
+class DSDFIRDelayLine
+{
+public:
+    DSDFIRDelayLine() { reset(); }
+
+    void reset()
+    {
+        m_index = 0;
+
+        for (int i = 0; i < 2*NbTaps; i++) {
+            m_v[i] = 0.0f;
+        }
+    }
+
+    /** push a new sample and return its inner product with NbTaps coefficients ordered from the oldest sample */
+    float run(float sample, const float *coeffs)
+    {
+        m_v[m_index] = sample;
+        m_v[m_index + NbTaps] = sample;
+        m_index = (m_index + 1) < NbTaps ? m_index + 1 : 0;
+        return DSDFIRKernel::dotProduct(&m_v[m_index], coeffs, NbTaps);
+    }
+
+private:
+    int m_index;
+    float m_v[2*NbTaps];
+};
+
 class DSDCC_API DSDFilters
 {
 public:
@@ -44,10 +90,24 @@ public:
     short dsd_input_filter(short sample, int mode);
     short dmr_filter(short sample);
     short nxdn_filter(short sample);
+    void dsd_input_filter(const short *in, short *out, int nbSamples, int mode); //!< block version
+    void dmr_filter(const short *in, short *out, int nbSamples);
+    void nxdn_filter(const short *in, short *out, int nbSamples);
 
 private:
-    float xv[NZEROS+1];
-    float nxv[NXZEROS+1];
+    struct SIMDCoefficients
+    {
+        SIMDCoefficients();
+        float m_x[NZEROS_SIMD];     //!< xcoeffs
+        float m_nx[NXZEROS_SIMD];   //!< nxcoeffs
+        float m_dmr[NZEROS_SIMD];   //!< dmrcoeffs
+        float m_dpmr[NXZEROS_SIMD]; //!< dpmrcoeffs
+    };
+
+    static const SIMDCoefficients& getSIMDCoefficients(); //!< built on first use so that it does not depend on the static initialization order
+    const SIMDCoefficients *m_simdCoeffs; //!< coefficients zero padded at the oldest end and divided by gain
+    DSDFIRDelayLine<NZEROS_SIMD> xv;
+    DSDFIRDelayLine<NXZEROS_SIMD> nxv;
 };
 
 /**
@@ -63,13 +123,21 @@ public:
     void setFrequencies(float samplingFrequency, float centerFrequency);
     void setR(float r);
     short run(short sample);
+    short runQ15(short sample); //!< same on Q15 samples in fixed point arithmetic with Q30 coefficients
 
 private:
     void init();
 
     float m_r;
     float m_frequencyRatio;
+    float m_a0;       //!< 1 - r
+    double m_a1;      //!< 2r.cos(2.pi.f/fs) precomputed when the parameters change
+    float m_a2;       //!< r^2
     float m_v[3];
+    int32_t m_a0Q30;
+    int32_t m_a1Q30;
+    int32_t m_a2Q30;
+    int32_t m_vQ8[3]; //!< state of the fixed point version with 8 fractional bits
 };
 
 /**
@@ -101,6 +169,8 @@ public:
     float run(const float& sample);
     float runHP(const float& sample);
     float runLP(const float& sample);
+    void runHP(const float *in, float *out, unsigned int nbSamples); //!< high pass a block of samples
+    void runLP(const float *in, float *out, unsigned int nbSamples); //!< low pass a block of samples
 
 private:
     IIRFilter<float, 2> m_filterLP;
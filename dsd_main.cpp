@@ -19,8 +19,12 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <math.h>
+#include <algorithm>
+#include <thread>
+#include <chrono>
 
 #include "dsd_decoder.h"
 #include "dsd_upsample.h"
@@ -50,7 +54,7 @@ private:
 
 void Mixer::mix(unsigned int size1, unsigned int size2, short *channel1, short *channel2)
 {
-    unsigned int m_mixSize = std::max(size1, size2);
+    m_mixSize = std::max(size1, size2);
 
     if (m_mixSize > m_mixSizeMax)
     {
@@ -59,8 +63,8 @@ void Mixer::mix(unsigned int size1, unsigned int size2, short *channel1, short *
             delete[] m_mix;
         }
 
-        m_mix = new short[m_mixSizeMax];
         m_mixSizeMax = m_mixSize;
+        m_mix = new short[m_mixSizeMax];
     }
 
     for (unsigned int i = 0; i < m_mixSize; i++)
@@ -79,8 +83,160 @@ void Mixer::mix(unsigned int size1, unsigned int size2, short *channel1, short *
     }
 }
 
+/**
+ * Reads input samples by blocks. Regular files can be memory mapped in which case blocks point
+ * directly into the mapping and no copy is made.
+ */
+class SampleInput
+{
+public:
+    SampleInput(int fd, unsigned int blockSize, bool useMmap);
+    ~SampleInput();
+    const short *getBlock(unsigned int& nbSamples); //!< next block of samples or null at end of input
+    bool isMapped() const { return m_map != 0; }
+
+private:
+    int m_fd;
+    unsigned int m_blockSize;
+    short *m_buffer;
+    unsigned int m_remainder;  //!< leftover byte of an incomplete sample from the previous read
+    const short *m_map;
+    size_t m_mapSamples;
+    size_t m_mapIndex;
+};
+
+SampleInput::SampleInput(int fd, unsigned int blockSize, bool useMmap) :
+    m_fd(fd),
+    m_blockSize(blockSize),
+    m_buffer(0),
+    m_remainder(0),
+    m_map(0),
+    m_mapSamples(0),
+    m_mapIndex(0)
+{
+    struct stat st;
+
+    if (useMmap && (fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size >= (off_t) sizeof(short)))
+    {
+        void *map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (map != MAP_FAILED)
+        {
+            madvise(map, st.st_size, MADV_SEQUENTIAL);
+            m_map = (const short *) map;
+            m_mapSamples = st.st_size / sizeof(short);
+            return;
+        }
+    }
+
+    m_buffer = new short[m_blockSize];
+}
+
+SampleInput::~SampleInput()
+{
+    if (m_map) {
+        munmap((void *) m_map, m_mapSamples * sizeof(short));
+    }
+
+    delete[] m_buffer;
+}
+
+const short *SampleInput::getBlock(unsigned int& nbSamples)
+{
+    if (m_map)
+    {
+        nbSamples = std::min((size_t) m_blockSize, m_mapSamples - m_mapIndex);
+        const short *block = &m_map[m_mapIndex];
+        m_mapIndex += nbSamples;
+        return nbSamples > 0 ? block : 0;
+    }
+
+    unsigned char *bytes = (unsigned char *) m_buffer;
+    int result = read(m_fd, (void *) &bytes[m_remainder], m_blockSize * sizeof(short) - m_remainder);
+
+    if (result <= 0)
+    {
+        nbSamples = 0;
+        return 0;
+    }
+
+    unsigned int nbBytes = m_remainder + result;
+    nbSamples = nbBytes / sizeof(short);
+    m_remainder = nbBytes % sizeof(short);
+
+    if (nbSamples == 0) { // only one byte was read wait for the next one
+        return getBlock(nbSamples);
+    }
+
+    return m_buffer;
+}
+
+/**
+ * Coalesces audio samples in a large buffer so that they are written with as few write calls as possible
+ */
+class AudioOutput
+{
+public:
+    AudioOutput(int fd, unsigned int size) : m_fd(fd), m_size(size), m_nbSamples(0) {
+        m_buffer = new short[m_size];
+    }
+    ~AudioOutput() {
+        delete[] m_buffer;
+    }
+    void write(const short *samples, unsigned int nbSamples);
+    void flush();
+
+private:
+    int m_fd;
+    unsigned int m_size;
+    unsigned int m_nbSamples;
+    short *m_buffer;
+};
+
+void AudioOutput::write(const short *samples, unsigned int nbSamples)
+{
+    if (m_nbSamples + nbSamples > m_size) {
+        flush();
+    }
+
+    if (nbSamples > m_size) // too large to be buffered
+    {
+        int result = ::write(m_fd, (const void *) samples, sizeof(short) * nbSamples);
+
+        if (result < 0) {
+            fprintf(stderr, "Error writing to output\n");
+        }
+
+        return;
+    }
+
+    memcpy(&m_buffer[m_nbSamples], samples, nbSamples * sizeof(short));
+    m_nbSamples += nbSamples;
+}
+
+void AudioOutput::flush()
+{
+    if (m_nbSamples == 0) {
+        return;
+    }
+
+    int result = ::write(m_fd, (const void *) m_buffer, sizeof(short) * m_nbSamples);
+
+    if (result < 0)
+    {
+        fprintf(stderr, "Error writing to output\n");
+    }
+    else if ((unsigned int) result != sizeof(short) * m_nbSamples)
+    {
+        fprintf(stderr, "Written %d out of %d audio samples\n", result/2, m_nbSamples);
+    }
+
+    m_nbSamples = 0;
+}
+
 static void usage ();
 static void sigfun (int sig);
+static void outputAudio(DSDcc::DSDDecoder& dsdDecoder, int slots, Mixer& mixer, AudioOutput& audioOutput);
 
 void usage()
 {
@@ -114,6 +270,9 @@ void usage()
     fprintf(stderr, "                Formatted messages contain traffic information such as IDs and callsigns\n");
     fprintf(stderr, "                Fields and their column position depend on the frame type\n");
     fprintf(stderr, "  -m <float>    Formatted messages refresh rate in seconds. Default is 0.1\n");
+    fprintf(stderr, "  -B <num>      Number of input samples processed at once. Default is 4800 (100ms) max is 24000\n");
+    fprintf(stderr, "                Use 1 to process samples one by one as in previous versions\n");
+    fprintf(stderr, "  -w            Memory map the input when it is a regular file\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Scanner control options:\n");
     fprintf(stderr,
@@ -124,6 +283,8 @@ void usage()
     fprintf(stderr, "     0          2400 bauds\n");
     fprintf(stderr, "     1          4800 bauds (default)\n");
     fprintf(stderr, "     2          9800 bauds\n");
+    fprintf(stderr, "  -r            Hunt for sync at 2400, 4800 and 9600 bauds at once and switch to the rate found\n");
+    fprintf(stderr, "                With -fa frames of all rates are auto-detected\n");
     fprintf(stderr, "  -fa           Auto-detect frame type (default)\n");
     fprintf(stderr, "  -fr           Decode only DMR/MOTOTRBO\n");
     fprintf(stderr, "  -fd           Decode only D-STAR\n");
@@ -134,6 +295,10 @@ void usage()
     fprintf(stderr, "  -f1           Decode only P25 Phase 1 - not supported\n");
     fprintf(stderr, "  -fp           Decode only ProVoice - not supported\n");
     fprintf(stderr, "  -fx           Decode only X2-TDMA - not supported\n");
+    fprintf(stderr, "  -S <types>    Soft decision Viterbi decoding for any of these frame types:\n");
+    fprintf(stderr, "     d          D-STAR header\n");
+    fprintf(stderr, "     y          YSF\n");
+    fprintf(stderr, "     n          NXDN\n");
     fprintf(stderr, "  -T <num>      TDMA slots processed:\n");
     fprintf(stderr, "     0          none\n");
     fprintf(stderr, "     1          slot #1 (default) use this one for FDMA\n");
@@ -148,16 +313,65 @@ void usage()
     fprintf(stderr, "                Device name is the corresponding TTY USB device e.g /dev/ttyUSB0\n");
 #endif
     fprintf(stderr, "  -H            Use high-pass filter on audio when using mbelib\n");
+    fprintf(stderr, "  -A            Run mbelib speech synthesis in separate threads\n");
     fprintf(stderr, "  -P <float>    Own latitude in decimal degrees. Latitude is positive to the North. Default 0\n");
     fprintf(stderr, "  -Q <float>    Own longitude in decimal degrees. Longitude is positive to the East. Default 0\n");
     fprintf(stderr, "                This is useful when status messages (see -M option) contain geographical data\n");
     fprintf(stderr, "                Practically this is only applicable to D-Star\n");
     fprintf(stderr, "  -x            Disable symbol PLL lock\n");
+    fprintf(stderr, "  -F            Use fixed point (Q15) symbol timing recovery\n");
     fprintf(stderr, "  -k <num>      Number of Basic Privacy key for DMR [1..255]\n");
     fprintf(stderr, "\n");
     exit(0);
 }
 
+void outputAudio(DSDcc::DSDDecoder& dsdDecoder, int slots, Mixer& mixer, AudioOutput& audioOutput)
+{
+    int nbAudioSamples1, nbAudioSamples2;
+    short *audioSamples1, *audioSamples2;
+
+    do // the audio ring may wrap around
+    {
+        nbAudioSamples1 = 0;
+        nbAudioSamples2 = 0;
+
+        if (slots & 1)
+        {
+            audioSamples1 = dsdDecoder.getAudio1(nbAudioSamples1);
+        }
+
+        if (slots & 2)
+        {
+            audioSamples2 = dsdDecoder.getAudio2(nbAudioSamples2);
+        }
+
+        if ((nbAudioSamples1 > 0) && (nbAudioSamples2 == 0))
+        {
+            audioOutput.write(audioSamples1, nbAudioSamples1);
+            dsdDecoder.resetAudio1();
+        }
+
+        if ((nbAudioSamples2 > 0) && (nbAudioSamples1 == 0))
+        {
+            audioOutput.write(audioSamples2, nbAudioSamples2);
+            dsdDecoder.resetAudio2();
+        }
+
+        if ((nbAudioSamples1 > 0) && (nbAudioSamples2 > 0))
+        {
+            short *mix;
+            int mixSize;
+
+            mixer.mix(nbAudioSamples1, nbAudioSamples2, audioSamples1, audioSamples2);
+            mix = mixer.getMix(mixSize);
+            audioOutput.write(mix, mixSize);
+
+            dsdDecoder.resetAudio1();
+            dsdDecoder.resetAudio2();
+        }
+    } while ((nbAudioSamples1 > 0) || (nbAudioSamples2 > 0));
+}
+
 void sigfun(int sig __attribute__((unused)))
 {
     exitflag = 1;
@@ -190,9 +404,12 @@ int main(int argc, char **argv)
     std::string dvSerialDevice;
 #endif
     int slots = 1;
+    bool asyncVocoder = false;
     Mixer mixer;
     float lat = 0.0f;
     float lon = 0.0f;
+    int blockSize = 4800;
+    bool useMmap = false;
 
     fprintf(stderr, "Digital Speech Decoder DSDcc\n");
 
@@ -200,7 +417,7 @@ int main(int argc, char **argv)
     signal(SIGINT, sigfun);
 
     while ((c = getopt(argc, argv,
-            "hHep:qtv:i:o:g:nR:f:u:U:lL:D:d:T:M:m:P:Q:xk:")) != -1)
+            "hHAep:qtv:i:o:g:nR:f:u:U:lL:D:d:rT:M:m:P:Q:xFk:B:wS:")) != -1)
     {
         opterr = 0;
         switch (c)
@@ -211,6 +428,9 @@ int main(int argc, char **argv)
         case 'H':
             dsdDecoder.useHPMbelib(true);
             break;
+        case 'A':
+            asyncVocoder = true;
+            break;
         case 'e':
             dsdDecoder.showErrorBars();
             break;
@@ -262,6 +482,17 @@ int main(int argc, char **argv)
                 formattext_refresh = rate;
             }
             break;
+        case 'B':
+            int tmpBlockSize;
+            sscanf(optarg, "%d", &tmpBlockSize);
+            if ((tmpBlockSize > 0) && (tmpBlockSize <= 24000)) // audio output buffers hold 1s
+            {
+                blockSize = tmpBlockSize;
+            }
+            break;
+        case 'w':
+            useMmap = true;
+            break;
         case 'i':
             strncpy(in_file, (const char *) optarg, 1023);
             in_file[1022] = '\0';
@@ -376,6 +607,24 @@ int main(int argc, char **argv)
         case 'x':
             dsdDecoder.setSymbolPLLLock(false);
             break;
+        case 'F':
+            dsdDecoder.setSymbolFixedPoint(true);
+            break;
+        case 'r':
+            dsdDecoder.setMultiRateSync(true);
+            break;
+        case 'S':
+            for (const char *type = optarg; *type; type++)
+            {
+                if (*type == 'd') {
+                    dsdDecoder.setSoftDecision(DSDcc::DSDDecoder::DSDDecodeDStar, true);
+                } else if (*type == 'y') {
+                    dsdDecoder.setSoftDecision(DSDcc::DSDDecoder::DSDDecodeYSF, true);
+                } else if (*type == 'n') {
+                    dsdDecoder.setSoftDecision(DSDcc::DSDDecoder::DSDDecodeNXDN48, true);
+                }
+            }
+            break;
         case 'k':
             int key_number;
             sscanf(optarg, "%u", &key_number);
@@ -467,145 +716,124 @@ int main(int argc, char **argv)
     }
 
     int formattext_sample_count = 0;
+    if (asyncVocoder) {
+        dsdDecoder.setAsyncVocoder(true);
+    }
+
+    SampleInput sampleInput(in_file_fd, blockSize, useMmap);
+    AudioOutput audioOutput(out_file_fd, 2*48000); // up to 1s of L+R samples
+
+    if (sampleInput.isMapped()) {
+        fprintf(stderr, "Input is memory mapped\n");
+    }
 
     while (exitflag == 0)
     {
-        short sample;
-        int nbAudioSamples1 = 0, nbAudioSamples2 = 0;
-        short *audioSamples1, *audioSamples2;
-
-        int result = read(in_file_fd, (void *) &sample, sizeof(short));
+        unsigned int nbSamples;
+        const short *samples = sampleInput.getBlock(nbSamples);
 
-        if (result == 0)
+        if (samples == 0)
         {
             fprintf(stderr, "No more input\n");
             break;
         }
 
-        dsdDecoder.run(sample);
+        unsigned int sampleIndex = 0;
 
-#ifdef DSD_USE_SERIALDV
-        if (dvController.isOpen())
+        while (sampleIndex < nbSamples)
         {
-            if (dsdDecoder.mbeDVReady1())
-            {
-                dvController.decode(dvAudioSamples, (const unsigned char *) dsdDecoder.getMbeDVFrame1(), (SerialDV::DVRate) dsdDecoder.getMbeRate(), dvGain_dB);
-
-                if (dsdDecoder.upsampling())
-                {
-                    upsamplingEngine.upsample(dsdDecoder.upsampling(), dvAudioSamples, &dvAudioSamples[SerialDV::MBE_AUDIO_BLOCK_SIZE], SerialDV::MBE_AUDIO_BLOCK_SIZE);
-                    result = write(out_file_fd, (const void *) &dvAudioSamples[SerialDV::MBE_AUDIO_BLOCK_SIZE], SerialDV::MBE_AUDIO_BLOCK_BYTES * dsdDecoder.upsampling());
-                }
-                else
-                {
-                    result = write(out_file_fd, (const void *) dvAudioSamples, SerialDV::MBE_AUDIO_BLOCK_BYTES); // TODO: upsampling
-                }
-
-                dsdDecoder.resetMbeDV1();
-            }
-
-            if (dsdDecoder.mbeDVReady2())
-            {
-                dvController.decode(dvAudioSamples, (const unsigned char *) dsdDecoder.getMbeDVFrame2(), (SerialDV::DVRate) dsdDecoder.getMbeRate(), dvGain_dB);
-
-                if (dsdDecoder.upsampling())
-                {
-                    upsamplingEngine.upsample(dsdDecoder.upsampling(), dvAudioSamples, &dvAudioSamples[SerialDV::MBE_AUDIO_BLOCK_SIZE], SerialDV::MBE_AUDIO_BLOCK_SIZE);
-                    result = write(out_file_fd, (const void *) &dvAudioSamples[SerialDV::MBE_AUDIO_BLOCK_SIZE], SerialDV::MBE_AUDIO_BLOCK_BYTES * dsdDecoder.upsampling());
-                }
-                else
-                {
-                    result = write(out_file_fd, (const void *) dvAudioSamples, SerialDV::MBE_AUDIO_BLOCK_BYTES); // TODO: upsampling
-                }
+            int nbSymbols, nbAudioFrames;
+            unsigned int nbToProcess = nbSamples - sampleIndex;
 
-                dsdDecoder.resetMbeDV2();
-            }
-        }
-        else
-#endif
-        {
-            if (slots & 1)
-            {
-                audioSamples1 = dsdDecoder.getAudio1(nbAudioSamples1);
+            if (formattext_nsamples > 0) { // stop at the next formatted text refresh
+                nbToProcess = std::min(nbToProcess, (unsigned int) (formattext_nsamples - formattext_sample_count + 1));
             }
 
-            if (slots & 2)
-            {
-                audioSamples2 = dsdDecoder.getAudio2(nbAudioSamples2);
-            }
+            unsigned int nbProcessed = dsdDecoder.runBlock(&samples[sampleIndex], nbToProcess, nbSymbols, nbAudioFrames);
+            sampleIndex += nbProcessed;
 
-            if ((nbAudioSamples1 > 0) && (nbAudioSamples2 == 0))
+#ifdef DSD_USE_SERIALDV
+            if (dvController.isOpen())
             {
-                result = write(out_file_fd, (const void *) audioSamples1, sizeof(short) * nbAudioSamples1);
-
-                if (result < 0)
+                if (dsdDecoder.mbeDVReady1())
                 {
-                    fprintf(stderr, "Error writing to output\n");
+                    dvController.decode(dvAudioSamples, (const unsigned char *) dsdDecoder.getMbeDVFrame1(), (SerialDV::DVRate) dsdDecoder.getMbeRate(), dvGain_dB);
+
+                    if (dsdDecoder.upsampling())
+                    {
+                        upsamplingEngine.upsample(dsdDecoder.upsampling(), dvAudioSamples, &dvAudioSamples[SerialDV::MBE_AUDIO_BLOCK_SIZE], SerialDV::MBE_AUDIO_BLOCK_SIZE);
+                        audioOutput.write(&dvAudioSamples[SerialDV::MBE_AUDIO_BLOCK_SIZE], SerialDV::MBE_AUDIO_BLOCK_SIZE * dsdDecoder.upsampling());
+                    }
+                    else
+                    {
+                        audioOutput.write(dvAudioSamples, SerialDV::MBE_AUDIO_BLOCK_SIZE);
+                    }
+
+                    dsdDecoder.resetMbeDV1();
                 }
-                else if ((unsigned int) result != sizeof(short) * nbAudioSamples1)
+
+                if (dsdDecoder.mbeDVReady2())
                 {
-                    fprintf(stderr, "Written %d out of %d audio samples\n", result/2, nbAudioSamples1);
+                    dvController.decode(dvAudioSamples, (const unsigned char *) dsdDecoder.getMbeDVFrame2(), (SerialDV::DVRate) dsdDecoder.getMbeRate(), dvGain_dB);
+
+                    if (dsdDecoder.upsampling())
+                    {
+                        upsamplingEngine.upsample(dsdDecoder.upsampling(), dvAudioSamples, &dvAudioSamples[SerialDV::MBE_AUDIO_BLOCK_SIZE], SerialDV::MBE_AUDIO_BLOCK_SIZE);
+                        audioOutput.write(&dvAudioSamples[SerialDV::MBE_AUDIO_BLOCK_SIZE], SerialDV::MBE_AUDIO_BLOCK_SIZE * dsdDecoder.upsampling());
+                    }
+                    else
+                    {
+                        audioOutput.write(dvAudioSamples, SerialDV::MBE_AUDIO_BLOCK_SIZE);
+                    }
+
+                    dsdDecoder.resetMbeDV2();
                 }
-
-                dsdDecoder.resetAudio1();
             }
-
-            if ((nbAudioSamples2 > 0) && (nbAudioSamples1 == 0))
+            else
+#endif
             {
-                result = write(out_file_fd, (const void *) audioSamples2, sizeof(short) * nbAudioSamples2);
-
-                if (result < 0)
-                {
-                    fprintf(stderr, "Error writing to output\n");
-                }
-                else if ((unsigned int) result != sizeof(short) * nbAudioSamples2)
-                {
-                    fprintf(stderr, "Written %d out of %d audio samples\n", result/2, nbAudioSamples2);
-                }
-
-                dsdDecoder.resetAudio2();
+                // with the asynchronous vocoder audio comes after the frames so nbAudioFrames cannot be relied upon
+                outputAudio(dsdDecoder, slots, mixer, audioOutput);
             }
 
-            if ((nbAudioSamples1 > 0) && (nbAudioSamples2 > 0))
+            if (formattext_nsamples > 0)
             {
-                short *mix;
-                int mixSize;
-
-                mixer.mix(nbAudioSamples1, nbAudioSamples2, audioSamples1, audioSamples2);
-                mix = mixer.getMix(mixSize);
-
-                result = write(out_file_fd, (const void *) mix, sizeof(short) * mixSize);
-
-                if (result < 0)
+                if (formattext_sample_count + (int) nbProcessed <= formattext_nsamples)
                 {
-                    fprintf(stderr, "Error writing to output\n");
+                    formattext_sample_count += nbProcessed;
                 }
-                else if ((unsigned int) result != sizeof(short) * mixSize)
+                else
                 {
-                    fprintf(stderr, "Written %d out of %d audio samples\n", result/2, mixSize);
+                    dsdDecoder.formatStatusText(formattext);
+                    fputs(formattext, formattext_fp);
+                    putc('\n', formattext_fp);
+                    formattext_sample_count = 0;
                 }
-
-                dsdDecoder.resetAudio1();
-                dsdDecoder.resetAudio2();
             }
         }
 
-        if (formattext_nsamples > 0)
+        audioOutput.flush(); // one write per input block
+    }
+
+    if (asyncVocoder) // finish pending frames
+    {
+        while (dsdDecoder.getVocoderPendingFrames() > 0) // keep draining the audio rings while the vocoder catches up
         {
-            if (formattext_sample_count < formattext_nsamples)
-            {
-                formattext_sample_count++;
-            }
-            else
-            {
-                dsdDecoder.formatStatusText(formattext);
-                fputs(formattext, formattext_fp);
-                putc('\n', formattext_fp);
-                formattext_sample_count = 0;
-            }
+            outputAudio(dsdDecoder, slots, mixer, audioOutput);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
+
+        dsdDecoder.setAsyncVocoder(false);
+        outputAudio(dsdDecoder, slots, mixer, audioOutput);
+        fprintf(stderr, "Vocoder dropped %u frames\n", dsdDecoder.getVocoderDroppedFrames());
     }
 
+    if (dsdDecoder.getAudioOverruns1() + dsdDecoder.getAudioOverruns2() > 0) {
+        fprintf(stderr, "Audio output overruns: %u %u frames\n", dsdDecoder.getAudioOverruns1(), dsdDecoder.getAudioOverruns2());
+    }
+
+    audioOutput.flush();
+
     if (formattext_fp)
     {
         fclose(formattext_fp);
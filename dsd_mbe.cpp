@@ -16,6 +16,7 @@
 
 #include <string.h>
 #include <math.h>
+#include <algorithm>
 #include "dsd_mbe.h"
 #include "dsd_decoder.h"
 
@@ -26,34 +27,55 @@
 namespace DSDcc
 {
 
+const unsigned int DSDMBEDecoder::m_defaultAudioRingSize;
+const unsigned int DSDMBEDecoder::m_minAudioRingSize;
+
+// weights of the current and previous 8k samples for each output phase but the last of the triangle interpolation
+const float DSDMBEDecoder::m_upsamplingWeights[8][6][2] = {
+    {},
+    {},
+    {{0.5, 0.5}},
+    {{0.332, 0.668}, {0.668, 0.332}},
+    {{0.25, 0.75}, {0.5, 0.5}, {0.75, 0.25}},
+    {{0.2, 0.8}, {0.4, 0.6}, {0.6, 0.4}, {0.8, 0.2}},
+    {{0.166, 0.834}, {0.332, 0.668}, {0.5, 0.5}, {0.668, 0.332}, {0.834, 0.166}},
+    {{0.142, 0.857}, {0.286, 0.714}, {0.429, 0.571}, {0.571, 0.429}, {0.714, 0.286}, {0.857, 0.142}}
+};
+
 DSDMBEDecoder::DSDMBEDecoder(DSDDecoder *dsdDecoder) :
         m_dsdDecoder(dsdDecoder),
         m_upsamplerLastValue(0.0f),
-        m_mbelibParms(0)
+        m_mbelibParms(0),
+        m_audioRing(m_defaultAudioRingSize),
+        m_audioStereo(false)
 {
 #ifdef DSD_USE_MBELIB
     m_mbelibParms = new DSDmbelibParms();
 #endif
-    m_audio_out_temp_buf_p = m_audio_out_temp_buf;
     memset(m_audio_out_float_buf, 0, sizeof(float) * 1120);
-    m_audio_out_float_buf_p = m_audio_out_float_buf;
     memset(m_aout_max_buf, 0, sizeof(float) * 200);
     m_aout_max_buf_p = m_aout_max_buf;
     m_aout_max_buf_idx = 0;
 
-    memset(m_audio_out_buf, 0, sizeof(short) * 2 * 48000);
-    m_audio_out_buf_p = m_audio_out_buf;
-    m_audio_out_nb_samples = 0;
-    m_audio_out_buf_size = 48000; // given in number of unique samples
-    m_audio_out_idx = 0;
-    m_audio_out_idx2 = 0;
-
+    m_audioViewed = 0;
+    m_audioOverruns = 0;
+    m_nbAudioFrames = 0;
+    m_async = false;
+    m_jobs = 0;
+    m_vocoderRunning = false;
+    m_nbDroppedFrames = 0;
+    m_errorBars = 0;
+
+    m_settings.m_gain = 25;
+    m_settings.m_gainSerial = 0;
+    m_settings.m_volume = 1.0f;
+    m_settings.m_autoGain = true;
+    m_settings.m_stereo = false;
+    m_settings.m_channels = 3; // both channels by default if stereo is set
+    m_settings.m_upsample = 0;
+    m_settings.m_useHP = false;
     m_aout_gain = 25;
-    m_volume = 1.0f;
-    m_auto_gain = true;
-    m_stereo = false;
-    m_channels = 3; // both channels by default if stereo is set
-    m_upsample = 0;
+    m_aout_gain_serial = 0;
 
 	initMbeParms();
 
@@ -63,21 +85,51 @@ DSDMBEDecoder::DSDMBEDecoder(DSDDecoder *dsdDecoder) :
 
 DSDMBEDecoder::~DSDMBEDecoder()
 {
+    setAsync(false);
 #ifdef DSD_USE_MBELIB
     delete m_mbelibParms;
 #endif
 }
 
+void DSDMBEDecoder::setAudioRingSize(unsigned int nbShorts)
+{
+    m_audioRing.resize(nbShorts < m_minAudioRingSize ? m_minAudioRingSize : nbShorts);
+    m_audioViewed = 0;
+    m_audioStereo = m_settings.m_stereo;
+}
+
 void DSDMBEDecoder::initMbeParms()
+{
+    if (m_async)
+    {
+        MBEJob job;
+        job.m_type = MBEJob::JobInit;
+        queueJob(job);
+        return;
+    }
+
+    initMbelib(m_settings);
+}
+
+std::mutex& DSDMBEDecoder::getMbelibMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+void DSDMBEDecoder::initMbelib(const MBEAudioSettings& settings)
 {
 #ifdef DSD_USE_MBELIB
-	mbe_initMbeParms(m_mbelibParms->m_cur_mp, m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced);
+    {
+        std::lock_guard<std::mutex> lock(getMbelibMutex());
+        mbe_initMbeParms(m_mbelibParms->m_cur_mp, m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced);
+    }
 #endif
 	m_errs = 0;
 	m_errs2 = 0;
 	m_err_str[0] = 0;
 
-    if (m_auto_gain)
+    if (settings.m_autoGain)
     {
         m_aout_gain = 25;
     }
@@ -88,103 +140,297 @@ void DSDMBEDecoder::processFrame(char imbe_fr[8][23], char ambe_fr[4][24], char
     if (!m_dsdDecoder->m_mbelibEnable) {
         return;
     }
+
+    if (m_async)
+    {
+        MBEJob job;
+        job.m_type = MBEJob::JobFrame;
+        job.m_imbe = imbe_fr != 0;
+        job.m_ambe = ambe_fr != 0;
+        job.m_imbe7100 = imbe7100_fr != 0;
+        if (job.m_imbe) { memcpy(job.m_imbe_fr, imbe_fr, sizeof(job.m_imbe_fr)); }
+        if (job.m_ambe) { memcpy(job.m_ambe_fr, ambe_fr, sizeof(job.m_ambe_fr)); }
+        if (job.m_imbe7100) { memcpy(job.m_imbe7100_fr, imbe7100_fr, sizeof(job.m_imbe7100_fr)); }
+        queueJob(job);
+        return;
+    }
+#ifdef DSD_USE_MBELIB
+    decodeFrame(m_dsdDecoder->m_mbeRate, m_dsdDecoder->m_opts.uvquality, imbe_fr, ambe_fr, imbe7100_fr);
+
+    if (m_dsdDecoder->m_opts.errorbars == 1)
+    {
+        m_dsdDecoder->getLogger().log("%s", m_err_str);
+    }
+
+    processAudio(m_settings);
+#endif
+}
+
+void DSDMBEDecoder::processData(char imbe_data[88], char ambe_data[49])
+{
+    if (!m_dsdDecoder->m_mbelibEnable) {
+        return;
+    }
+
+    if (m_async)
+    {
+        MBEJob job;
+        job.m_type = MBEJob::JobData;
+        job.m_imbe = imbe_data != 0;
+        job.m_ambe = ambe_data != 0;
+        job.m_imbe7100 = false;
+        if (job.m_imbe) { memcpy(job.m_imbe_data, imbe_data, sizeof(job.m_imbe_data)); }
+        if (job.m_ambe) { memcpy(job.m_ambe_data, ambe_data, sizeof(job.m_ambe_data)); }
+        queueJob(job);
+        return;
+    }
+#ifdef DSD_USE_MBELIB
+    if (!decodeData(m_dsdDecoder->m_mbeRate, m_dsdDecoder->m_opts.uvquality, imbe_data, ambe_data)) {
+        return;
+    }
+
+    if (m_dsdDecoder->m_opts.errorbars == 1)
+    {
+        m_dsdDecoder->getLogger().log("%s", m_err_str);
+    }
+
+    processAudio(m_settings);
+#endif
+}
+
+void DSDMBEDecoder::decodeFrame(int mbeRate, int uvquality, char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24])
+{
 #ifdef DSD_USE_MBELIB
+    DSD_STATS_SCOPE(&m_dsdDecoder->m_stats, DSDStatsSnapshot::StageMbelib);
+    std::lock_guard<std::mutex> lock(getMbelibMutex());
     memset((void *) imbe_d, 0, 88);
 
-    if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate7200x4400)
+    if (mbeRate == DSDDecoder::DSDMBERate7200x4400)
     {
         mbe_processImbe7200x4400Framef(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, imbe_fr, imbe_d, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
-    else if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate7100x4400)
+    else if (mbeRate == DSDDecoder::DSDMBERate7100x4400)
     {
         mbe_processImbe7100x4400Framef(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, imbe7100_fr, imbe_d,
                 m_mbelibParms->m_cur_mp, m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced,
-                m_dsdDecoder->m_opts.uvquality);
+                uvquality);
     }
-    else if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate3600x2400)
+    else if (mbeRate == DSDDecoder::DSDMBERate3600x2400)
     {
         mbe_processAmbe3600x2400Framef(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, ambe_fr, ambe_d,m_mbelibParms-> m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
     else
     {
         mbe_processAmbe3600x2450Framef(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, ambe_fr, ambe_d, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
-    }
-
-    if (m_dsdDecoder->m_opts.errorbars == 1)
-    {
-        m_dsdDecoder->getLogger().log("%s", m_err_str);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
-
-    processAudio();
+#else
+    (void) mbeRate;
+    (void) uvquality;
+    (void) imbe_fr;
+    (void) ambe_fr;
+    (void) imbe7100_fr;
 #endif
 }
 
-void DSDMBEDecoder::processData(char imbe_data[88], char ambe_data[49])
+bool DSDMBEDecoder::decodeData(int mbeRate, int uvquality, char imbe_data[88], char ambe_data[49])
 {
-    if (!m_dsdDecoder->m_mbelibEnable) {
-        return;
-    }
 #ifdef DSD_USE_MBELIB
-    if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate4400)
+    DSD_STATS_SCOPE(&m_dsdDecoder->m_stats, DSDStatsSnapshot::StageMbelib);
+    std::lock_guard<std::mutex> lock(getMbelibMutex());
+
+    if (mbeRate == DSDDecoder::DSDMBERate4400)
     {
         mbe_processImbe4400Dataf(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, imbe_data, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
-    else if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate2400)
+    else if (mbeRate == DSDDecoder::DSDMBERate2400)
     {
         mbe_processAmbe2400Dataf(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, ambe_data, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
-    else if (m_dsdDecoder->m_mbeRate == DSDDecoder::DSDMBERate2450)
+    else if (mbeRate == DSDDecoder::DSDMBERate2450)
     {
         mbe_processAmbe2450Dataf(m_audio_out_temp_buf, &m_errs,
                 &m_errs2, m_err_str, ambe_data, m_mbelibParms->m_cur_mp,
-                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, m_dsdDecoder->m_opts.uvquality);
+                m_mbelibParms->m_prev_mp, m_mbelibParms->m_prev_mp_enhanced, uvquality);
     }
     else
     {
+        return false;
+    }
+
+    return true;
+#else
+    (void) mbeRate;
+    (void) uvquality;
+    (void) imbe_data;
+    (void) ambe_data;
+    return false;
+#endif
+}
+
+void DSDMBEDecoder::setAsync(bool async, unsigned int queueSize)
+{
+    if (async == m_async) {
         return;
     }
 
-    if (m_dsdDecoder->m_opts.errorbars == 1)
+    if (async)
     {
-        m_dsdDecoder->getLogger().log("%s", m_err_str);
+        // the vocoder thread may deliver the audio of all queued frames between two reads of the ring
+        if (m_audioRing.capacity() < (queueSize + 1) * m_minAudioRingSize) {
+            setAudioRingSize((queueSize + 1) * m_minAudioRingSize);
+        }
+
+        m_jobs = new SPSCQueue<MBEJob>(queueSize);
+        m_errorBars = new SPSCQueue<MBEErrorBars>(queueSize);
+        m_async = true;
+        m_vocoderRunning = true;
+        m_vocoderThread = std::thread(&DSDMBEDecoder::vocoderLoop, this);
     }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_vocoderMutex);
+            m_vocoderRunning = false;
+            m_vocoderWakeUp.notify_one();
+        }
 
-    processAudio();
+        m_vocoderThread.join();
+        m_async = false;
+        MBEJob job;
+
+        logErrorBars();
+
+        while (m_jobs->pop(job)) { // remaining frames are processed synchronously
+            runJob(job);
+        }
+
+        delete m_jobs;
+        m_jobs = 0;
+        delete m_errorBars;
+        m_errorBars = 0;
+    }
+}
+
+void DSDMBEDecoder::queueJob(MBEJob& job)
+{
+    job.m_mbeRate = (int) m_dsdDecoder->m_mbeRate;
+    job.m_uvquality = m_dsdDecoder->m_opts.uvquality;
+    job.m_errorbars = m_dsdDecoder->m_opts.errorbars == 1;
+    job.m_settings = m_settings;
+    logErrorBars();
+
+    if (m_jobs->push(job))
+    {
+        std::lock_guard<std::mutex> lock(m_vocoderMutex); // else the notification may be lost between the test and the wait
+        m_vocoderWakeUp.notify_one();
+    }
+    else
+    {
+        m_nbDroppedFrames++;
+    }
+}
+
+void DSDMBEDecoder::runJob(MBEJob& job)
+{
+    if (job.m_type == MBEJob::JobInit)
+    {
+        initMbelib(job.m_settings);
+        return;
+    }
+#ifdef DSD_USE_MBELIB
+    if (job.m_type == MBEJob::JobFrame)
+    {
+        decodeFrame(job.m_mbeRate, job.m_uvquality,
+                job.m_imbe ? job.m_imbe_fr : 0,
+                job.m_ambe ? job.m_ambe_fr : 0,
+                job.m_imbe7100 ? job.m_imbe7100_fr : 0);
+    }
+    else if (!decodeData(job.m_mbeRate, job.m_uvquality,
+            job.m_imbe ? job.m_imbe_data : 0,
+            job.m_ambe ? job.m_ambe_data : 0))
+    {
+        return;
+    }
+
+    if (job.m_errorbars)
+    {
+        if (m_async) // the logger belongs to the decoder thread
+        {
+            MBEErrorBars errorBars;
+            strncpy(errorBars.m_str, m_err_str, sizeof(errorBars.m_str));
+            errorBars.m_str[sizeof(errorBars.m_str) - 1] = 0;
+            m_errorBars->push(errorBars); // dropped if the decoder thread does not keep up
+        }
+        else
+        {
+            m_dsdDecoder->getLogger().log("%s", m_err_str);
+        }
+    }
+
+    processAudio(job.m_settings);
 #endif
 }
 
-void DSDMBEDecoder::processAudio()
+void DSDMBEDecoder::logErrorBars()
+{
+    MBEErrorBars errorBars;
+
+    while (m_errorBars->pop(errorBars)) {
+        m_dsdDecoder->getLogger().log("%s", errorBars.m_str);
+    }
+}
+
+void DSDMBEDecoder::vocoderLoop()
+{
+    MBEJob job;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_vocoderMutex);
+            m_vocoderWakeUp.wait(lock, [this] { return (m_jobs->readable() > 0) || !m_vocoderRunning.load(); });
+        }
+
+        if (!m_vocoderRunning.load()) { // remaining frames are processed by setAsync
+            break;
+        }
+
+        while (m_jobs->pop(job)) {
+            runJob(job);
+        }
+    }
+}
+
+void DSDMBEDecoder::processAudio(const MBEAudioSettings& settings)
 {
     int i, n;
-    float aout_abs, max, gainfactor, gaindelta, maxbuf;
+    float max, gainfactor, gaindelta, maxbuf;
+    float *audio = m_audio_out_temp_buf;
+
+    if (settings.m_gainSerial != m_aout_gain_serial) // gain was set since the last frame
+    {
+        m_aout_gain = settings.m_gain;
+        m_aout_gain_serial = settings.m_gainSerial;
+    }
 
-    if (m_auto_gain)
+    if (settings.m_autoGain)
     {
         // detect max level
         max = 0;
-        m_audio_out_temp_buf_p = m_audio_out_temp_buf;
-
-        for (n = 0; n < 160; n++)
-        {
-            aout_abs = fabsf(*m_audio_out_temp_buf_p);
-
-            if (aout_abs > max)
-            {
-                max = aout_abs;
-            }
 
-            m_audio_out_temp_buf_p++;
+        for (n = 0; n < 160; n++) {
+            max = std::max(max, fabsf(audio[n]));
         }
 
         *m_aout_max_buf_p = max;
@@ -241,13 +487,8 @@ void DSDMBEDecoder::processAudio()
         gaindelta /= (float) 160;
 
         // adjust output gain
-        m_audio_out_temp_buf_p = m_audio_out_temp_buf;
-
-        for (n = 0; n < 160; n++)
-        {
-            *m_audio_out_temp_buf_p = (m_aout_gain
-                    + ((float) n * gaindelta)) * (*m_audio_out_temp_buf_p);
-            m_audio_out_temp_buf_p++;
+        for (n = 0; n < 160; n++) {
+            audio[n] = (m_aout_gain + ((float) n * gaindelta)) * audio[n];
         }
 
         m_aout_gain += ((float) 160 * gaindelta);
@@ -258,232 +499,115 @@ void DSDMBEDecoder::processAudio()
     }
 
     // copy audio data to output buffer and upsample if necessary
-    m_audio_out_temp_buf_p = m_audio_out_temp_buf;
+    int upsample = settings.m_upsample;
+    bool stereo = settings.m_stereo;
+    unsigned int nbOutShorts = ((upsample >= 2) ? 160*upsample : 160) * (stereo ? 2 : 1);
 
-    //if ((m_upsample == 6) || (m_upsample == 7)) // upsampling to 48k
-    if (m_upsample >= 2)
+    if (stereo != m_audioStereo.load()) // the layout can only change once the consumer has read everything
     {
-        int upsampling = m_upsample;
-
-        if (m_audio_out_nb_samples + (160*upsampling) >= m_audio_out_buf_size)
+        if (m_audioRing.writable() != m_audioRing.capacity())
         {
-            resetAudio();
+            m_audioOverruns++;
+            return;
         }
 
-        m_audio_out_float_buf_p = m_audio_out_float_buf;
-
-        for (n = 0; n < 160; n++)
-        {
-            upsample(upsampling, *m_audio_out_temp_buf_p);
-            m_audio_out_temp_buf_p++;
-            m_audio_out_float_buf_p += upsampling;
-            m_audio_out_idx += upsampling;
-            m_audio_out_idx2 += upsampling;
-        }
+        m_audioStereo = stereo;
+    }
 
-        m_audio_out_float_buf_p = m_audio_out_float_buf;
+    unsigned int nbContiguous;
+    short *audio_out_start = m_audioRing.writeView(nbContiguous);
 
-        // copy to output (short) buffer
-        for (n = 0; n < (160*upsampling); n++)
-        {
-            if (*m_audio_out_float_buf_p > (float) 32760)
-            {
-                *m_audio_out_float_buf_p = (float) 32760;
-            }
-            else if (*m_audio_out_float_buf_p < (float) -32760)
-            {
-                *m_audio_out_float_buf_p = (float) -32760;
-            }
+    if (m_audioRing.writable() < nbOutShorts) // the consumer does not keep up
+    {
+        m_audioOverruns++;
+        return;
+    }
 
+    if (nbContiguous < nbOutShorts) { // frame wraps around the ring
+        audio_out_start = m_audio_frame_buf;
+    }
 
-            if (m_stereo) // produce two channels
-            {
-            	if (m_channels & 1) { // left channel
-                    *m_audio_out_buf_p = (short) *m_audio_out_float_buf_p;
-            	} else {
-            		*m_audio_out_buf_p = 0;
-            	}
+    unsigned int nbSamples = 160;
 
-                m_audio_out_buf_p++;
+    if (upsample >= 2) // upsampling to 48k
+    {
+        m_upsamplingFilter.useHP(settings.m_useHP);
+        upsampleFrame(upsample, settings.m_volume);
+        audio = m_audio_out_float_buf;
+        nbSamples = 160*upsample;
+    }
 
-                if ((m_channels>>1) & 1) { // right channel
-                    *m_audio_out_buf_p = (short) *m_audio_out_float_buf_p;
-            	} else {
-            		*m_audio_out_buf_p = 0;
-            	}
+    for (n = 0; n < (int) nbSamples; n++) {
+        audio[n] = std::min(std::max(audio[n], (float) -32760), (float) 32760);
+    }
 
-                m_audio_out_buf_p++;
-            }
-            else // single (mono) channel
-            {
-                *m_audio_out_buf_p = (short) *m_audio_out_float_buf_p;
-                m_audio_out_buf_p++;
-            }
+    // the upsampled audio goes to the selected channels only while 8k audio is doubled
+    bool left = (upsample < 2) || (settings.m_channels & 1);
+    bool right = (upsample < 2) || ((settings.m_channels>>1) & 1);
 
-            m_audio_out_nb_samples++;
-            m_audio_out_float_buf_p++;
+    if (!stereo) // single (mono) channel
+    {
+        for (n = 0; n < (int) nbSamples; n++) {
+            audio_out_start[n] = (short) audio[n];
         }
     }
-    else // leave at 8k
+    else // produce two channels
     {
-        if (m_audio_out_nb_samples + 160 >= m_audio_out_buf_size)
+        for (n = 0; n < (int) nbSamples; n++)
         {
-            resetAudio();
+            audio_out_start[2*n]     = left ? (short) audio[n] : 0;
+            audio_out_start[2*n + 1] = right ? (short) audio[n] : 0;
         }
+    }
 
-        m_audio_out_float_buf_p = m_audio_out_float_buf;
+    if (audio_out_start == m_audio_frame_buf) {
+        m_audioRing.write(m_audio_frame_buf, nbOutShorts);
+    } else {
+        m_audioRing.commit(nbOutShorts);
+    }
 
-        for (n = 0; n < 160; n++)
-        {
-            if (*m_audio_out_temp_buf_p > (float) 32760)
-            {
-                *m_audio_out_temp_buf_p = (float) 32760;
-            }
-            else if (*m_audio_out_temp_buf_p < (float) -32760)
-            {
-                *m_audio_out_temp_buf_p = (float) -32760;
-            }
+    m_nbAudioFrames++;
+}
+
+void DSDMBEDecoder::upsampleFrame(int upsampling, float volume)
+{
+    // high pass and volume at 8k over the whole frame with the last sample of the previous frame in front
+    float in[161];
+    in[0] = m_upsamplerLastValue;
+
+    if (m_upsamplingFilter.usesHP()) {
+        m_upsamplingFilter.runHP(m_audio_out_temp_buf, &in[1], 160);
+    } else {
+        memcpy(&in[1], m_audio_out_temp_buf, 160*sizeof(float));
+    }
 
-            *m_audio_out_buf_p = (short) *m_audio_out_temp_buf_p;
-            m_audio_out_buf_p++;
+    for (int n = 1; n <= 160; n++) {
+        in[n] *= volume;
+    }
 
-            if (m_stereo) // produce second channel
-            {
-                *m_audio_out_buf_p = (short) *m_audio_out_temp_buf_p;
-                m_audio_out_buf_p++;
-            }
+    // polyphase triangle interpolation: output phase k of each input sample is a fixed
+    // two tap combination of this sample and the previous one. The last phase is the sample itself.
+    const float (*weights)[2] = m_upsamplingWeights[upsampling];
+
+    for (int k = 0; k < upsampling - 1; k++)
+    {
+        float w = weights[k][0];
+        float wPrev = weights[k][1];
+        float *out = &m_audio_out_float_buf[k];
 
-            m_audio_out_nb_samples++;
-            m_audio_out_temp_buf_p++;
-            m_audio_out_idx++;
-            m_audio_out_idx2++;
+        for (int n = 0; n < 160; n++) {
+            out[upsampling*n] = (in[n+1] * w) + (in[n] * wPrev);
         }
     }
-}
 
-void DSDMBEDecoder::upsample(int upsampling, float invalue)
-{
-//    int sum;
-    float *outbuf1, c, d;
-
-    outbuf1 = m_audio_out_float_buf_p;
-//    outbuf1--;
-//    c = *outbuf1;
-    c = m_upsamplerLastValue;
-    d = (m_upsamplingFilter.usesHP() ? m_upsamplingFilter.runHP(invalue) : invalue)*m_volume;
-    // basic triangle interpolation
-//    outbuf1++;
-    if (upsampling == 2)
-    {
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.5) + (c * (float) 0.5));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP(d);
-        m_upsamplerLastValue = d;
-        outbuf1++;
-    }
-    else if (upsampling == 3)
-    {
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.332) + (c * (float) 0.668));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.668) + (c * (float) 0.332));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP(d);
-        m_upsamplerLastValue = d;
-        outbuf1++;
-    }
-    else if (upsampling == 4)
-    {
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.25) + (c * (float) 0.75));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.5) + (c * (float) 0.5));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.75) + (c * (float) 0.25));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP(d);
-        m_upsamplerLastValue = d;
-        outbuf1++;
-    }
-    else if (upsampling == 5)
-    {
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.2) + (c * (float) 0.8));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.4) + (c * (float) 0.6));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.6) + (c * (float) 0.4));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.8) + (c * (float) 0.2));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP(d);
-        m_upsamplerLastValue = d;
-        outbuf1++;
-    }
-    else if (upsampling == 6)
-    {
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.166) + (c * (float) 0.834));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.332) + (c * (float) 0.668));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.5) + (c * (float) 0.5));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.668) + (c * (float) 0.332));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.834) + (c * (float) 0.166));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP(d);
-        m_upsamplerLastValue = d;
-        outbuf1++;
-    }
-    else if (upsampling == 7)
-    {
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.142) + (c * (float) 0.857));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.286) + (c * (float) 0.714));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.429) + (c * (float) 0.571));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.571) + (c * (float) 0.429));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.714) + (c * (float) 0.286));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP((d * (float) 0.857) + (c * (float) 0.142));
-        outbuf1++;
-        *outbuf1 = m_upsamplingFilter.runLP(d);
-        m_upsamplerLastValue = d;
-        outbuf1++;
-    }
-    else // default is no upsampling (0)
-    {
-        outbuf1++;
-        *outbuf1 = d;
-        outbuf1++;
-    }
-
-    outbuf1 -= upsampling;
-
-    // FIXME: this is all wrong! Now at least it does not corrupt audio_out_float_buf
-
-//    if (m_dsdDecoder->m_state.audio_out_idx2 > 24)
-//    {
-//        // smoothing
-//        outbuf1 -= 16;
-//        for (j = 0; j < 4; j++)
-//        {
-//            for (i = 0; i < m_upsampling; i++)
-//            {
-//                sum = 0;
-//                outbuf1 -= 2;
-//                sum += *outbuf1;
-//                outbuf1 += 2;
-//                sum += *outbuf1;
-//                outbuf1 += 2;
-//                sum += *outbuf1;
-//                outbuf1 -= 2;
-//                *outbuf1 = (sum / (float) 3);
-//                outbuf1++;
-//            }
-//            outbuf1 -= m_upsampling + 2;
-//        }
-//    }
+    float *out = &m_audio_out_float_buf[upsampling - 1];
+
+    for (int n = 0; n < 160; n++) {
+        out[upsampling*n] = in[n+1];
+    }
+
+    m_upsamplerLastValue = in[160];
+    m_upsamplingFilter.runLP(m_audio_out_float_buf, m_audio_out_float_buf, 160*upsampling);
 }
 
 
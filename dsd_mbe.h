@@ -17,7 +17,13 @@
 #ifndef DSDCC_DSD_MBE_H_
 #define DSDCC_DSD_MBE_H_
 
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 #include "dsd_filters.h"
+#include "spscqueue.h"
 #include "export.h"
 
 namespace DSDcc
@@ -36,30 +42,118 @@ public:
     void processFrame(char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24]);
     void processData(char imbe_data[88], char ambe_data[49]);
 
+    /**
+     * Zero copy access to the audio ring. Gives the contiguous samples (L+R pairs in stereo) that can be
+     * less than the available samples at wrap around. The ring may be read from another thread than the
+     * one running the decoder.
+     */
+    const short *getAudioView(int& nbSamples) const
+    {
+        unsigned int nbShorts;
+        const short *audio = m_audioRing.readView(nbShorts);
+        nbSamples = nbShorts / (m_audioStereo.load() ? 2 : 1); // after the view so that it describes the samples seen
+        return audio;
+    }
+
+    void releaseAudio(int nbSamples)
+    {
+        m_audioRing.release(nbSamples * (m_audioStereo.load() ? 2 : 1));
+    }
+
+    /** Polling interface: samples obtained with getAudio are freed by resetAudio */
     short *getAudio(int& nbSamples)
     {
-        nbSamples = m_audio_out_nb_samples;
-        return m_audio_out_buf;
+        const short *audio = getAudioView(nbSamples);
+        m_audioViewed = nbSamples;
+        return (short *) audio;
     }
 
     void resetAudio()
     {
-        m_audio_out_nb_samples = 0;
-        m_audio_out_buf_p = m_audio_out_buf;
+        releaseAudio(m_audioViewed);
+        m_audioViewed = 0;
     }
 
-    void setAudioGain(float aout_gain) { m_aout_gain = aout_gain; }
-    void setAutoGain(bool auto_gain) { m_auto_gain = auto_gain; }
-    void setVolume(float volume) { m_volume = volume; }
-    void setStereo(bool stereo) { m_stereo = stereo; }
-    void setChannels(unsigned char channels) { m_channels = channels % 4; }
-    void setUpsamplingFactor(int upsample) { m_upsample = upsample; }
-    int getUpsamplingFactor() const { return m_upsample; }
-    void useHP(bool useHP) { m_upsamplingFilter.useHP(useHP); }
+    unsigned int getAudioOverruns() const { return m_audioOverruns.load(); } //!< frames dropped because the audio ring was full
+
+    /**
+     * Reallocates the audio ring with a capacity of nbShorts S16 items (an L+R pair counts for two) rounded up
+     * to a power of two and at least one frame upsampled 7 times in stereo. Pending audio is discarded so it must
+     * not be called while the ring is read from another thread.
+     */
+    void setAudioRingSize(unsigned int nbShorts);
+    unsigned int getAudioRingSize() const { return m_audioRing.capacity(); }
+
+    static const unsigned int m_defaultAudioRingSize = 2*48000; //!< 1s of 48 kS/s stereo audio
+    static const unsigned int m_minAudioRingSize = 2*1120;      //!< one frame of 160 samples upsampled 7 times in stereo
+
+    /** Audio settings are taken by each frame when it is queued so they are applied in order in asynchronous mode */
+    void setAudioGain(float aout_gain) { m_settings.m_gain = aout_gain; m_settings.m_gainSerial++; }
+    void setAutoGain(bool auto_gain) { m_settings.m_autoGain = auto_gain; }
+    void setVolume(float volume) { m_settings.m_volume = volume; }
+    void setStereo(bool stereo) { m_settings.m_stereo = stereo; }
+    bool getStereo() const { return m_settings.m_stereo; }
+    void setChannels(unsigned char channels) { m_settings.m_channels = channels % 4; }
+    void setUpsamplingFactor(int upsample) { m_settings.m_upsample = upsample; }
+    int getUpsamplingFactor() const { return m_settings.m_upsample; }
+    void useHP(bool useHP) { m_settings.m_useHP = useHP; }
+    unsigned int getNbAudioFrames() const { return m_nbAudioFrames.load(); } //!< number of audio frames produced so far (wraps around)
+
+    /**
+     * In asynchronous mode frames are queued to a vocoder thread and processFrame/processData never
+     * wait for the synthesis. Frames are dropped when the queue is full. Audio is collected by getAudio
+     * whether or not frames were produced by the last run. The audio ring is grown to hold the audio of a full queue.
+     */
+    void setAsync(bool async, unsigned int queueSize = 32);
+    bool getAsync() const { return m_async; }
+    unsigned int getNbDroppedFrames() const { return m_nbDroppedFrames.load(); }
+    unsigned int getNbPendingFrames() const { return m_async ? m_jobs->readable() : 0; } //!< frames queued to the vocoder thread
 
 private:
-    void processAudio();
-    void upsample(int upsampling, float invalue);
+    struct MBEAudioSettings //!< audio output settings written by the host
+    {
+        float m_gain;              //!< output gain applied when m_gainSerial changes. Start of auto gain.
+        unsigned int m_gainSerial; //!< incremented each time the gain is set
+        float m_volume;
+        bool m_autoGain;
+        int m_upsample;            //!< upsampling factor
+        bool m_stereo;             //!< double each audio sample to produce L+R channels
+        unsigned char m_channels;  //!< when in stereo output to none (0) or only left (1), right (2) or both (3) channels
+        bool m_useHP;              //!< high pass filter before upsampling
+    };
+
+    struct MBEJob //!< frame handed to the vocoder thread
+    {
+        enum { JobInit, JobFrame, JobData } m_type;
+        int m_mbeRate;
+        int m_uvquality;
+        bool m_errorbars;
+        MBEAudioSettings m_settings;
+        bool m_imbe;     //!< imbe_fr (frame) or imbe_data (data) is used
+        bool m_ambe;     //!< ambe_fr (frame) or ambe_data (data) is used
+        bool m_imbe7100; //!< imbe7100_fr is used
+        char m_imbe_fr[8][23];
+        char m_ambe_fr[4][24];
+        char m_imbe7100_fr[7][24];
+        char m_imbe_data[88];
+        char m_ambe_data[49];
+    };
+
+    struct MBEErrorBars //!< error bars text handed back to the decoder thread
+    {
+        char m_str[64];
+    };
+
+    static std::mutex& getMbelibMutex(); //!< mbelib is not known to be reentrant: its calls are serialized across decoders and vocoder threads
+    void initMbelib(const MBEAudioSettings& settings);
+    void decodeFrame(int mbeRate, int uvquality, char imbe_fr[8][23], char ambe_fr[4][24], char imbe7100_fr[7][24]);
+    bool decodeData(int mbeRate, int uvquality, char imbe_data[88], char ambe_data[49]);
+    void queueJob(MBEJob& job);
+    void runJob(MBEJob& job);
+    void vocoderLoop();
+    void logErrorBars(); //!< error bars of the frames processed by the vocoder thread
+    void processAudio(const MBEAudioSettings& settings);
+    void upsampleFrame(int upsampling, float volume); //!< from m_audio_out_temp_buf at 8k to m_audio_out_float_buf
 
     DSDDecoder *m_dsdDecoder;
     char imbe_d[88];
@@ -72,28 +166,32 @@ private:
     char m_err_str[64];
 
     float m_audio_out_temp_buf[160];   //!< output of decoder
-    float *m_audio_out_temp_buf_p;
-
     float m_audio_out_float_buf[1120]; //!< output of upsampler - 1 frame of 160 samples upampled up to 7 times
-    float *m_audio_out_float_buf_p;
+    static const float m_upsamplingWeights[8][6][2]; //!< interpolation weights of the current and previous sample by factor and phase
 
     float m_aout_max_buf[200];
     float *m_aout_max_buf_p;
     int m_aout_max_buf_idx;
 
-    short m_audio_out_buf[2*48000];    //!< final result - 1s of L+R S16LE samples
-    short *m_audio_out_buf_p;
-    int   m_audio_out_nb_samples;
-    int   m_audio_out_buf_size;
-    int   m_audio_out_idx;
-    int   m_audio_out_idx2;
-
-    float m_aout_gain;
-    float m_volume;
-    bool m_auto_gain;
-    int m_upsample;            //!< upsampling factor
-    bool m_stereo;             //!< double each audio sample to produce L+R channels
-    unsigned char m_channels;  //!< when in stereo output to none (0) or only left (1), right (2) or both (3) channels
+    SPSCQueue<short> m_audioRing;      //!< final result - at least 1s of L+R S16LE samples
+    std::atomic<bool> m_audioStereo;   //!< the ring holds L+R pairs. Only changes when the ring is empty.
+    int   m_audioViewed;               //!< samples given by getAudio
+    std::atomic<unsigned int> m_audioOverruns;
+    short m_audio_frame_buf[2*1120];   //!< one frame of audio when it does not fit before the ring wraps around
+    std::atomic<unsigned int> m_nbAudioFrames;
+
+    bool m_async;
+    SPSCQueue<MBEJob> *m_jobs;          //!< frames to vocoder thread
+    std::thread m_vocoderThread;
+    std::atomic<bool> m_vocoderRunning;
+    std::mutex m_vocoderMutex;          //!< guards the wake up condition of the vocoder thread
+    std::condition_variable m_vocoderWakeUp;
+    std::atomic<unsigned int> m_nbDroppedFrames;
+    SPSCQueue<MBEErrorBars> *m_errorBars; //!< from vocoder thread
+
+    MBEAudioSettings m_settings;      //!< host side
+    float m_aout_gain;                //!< gain applied to the frames (vocoder side)
+    unsigned int m_aout_gain_serial;  //!< serial of the last gain setting applied
 
     DSDMBEAudioInterpolatorFilter m_upsamplingFilter;
 };
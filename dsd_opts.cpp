@@ -49,6 +49,9 @@ DSDOpts::DSDOpts()
     delay = 0;
     use_cosine_filter = 1;
     unmute_encrypted_p25 = 0;
+    soft_dstar = 0;
+    soft_ysf = 0;
+    soft_nxdn = 0;
 }
 
 DSDOpts::~DSDOpts()
@@ -56,6 +56,9 @@ public:
     int delay;
     int use_cosine_filter;
     int unmute_encrypted_p25;
+    int soft_dstar; //!< soft decision Viterbi decoding of D-Star header
+    int soft_ysf;   //!< soft decision Viterbi decoding of YSF FICH and DCH
+    int soft_nxdn;  //!< soft decision (erasures) Viterbi decoding of NXDN channels
 };
 
 } // namespace dsdcc
@@ -24,18 +24,6 @@ DSDState::DSDState()
     int i, j;
 
     repeat = 0;
-
-    for (i = 0; i < 1024; i++)
-    {
-        maxbuf[i] = 15000;
-    }
-
-    for (i = 0; i < 1024; i++)
-    {
-        minbuf[i] = -15000;
-    }
-
-    midx = 0;
     sprintf(fsubtype, "              ");
     sprintf(ftype, "             ");
     symbolcnt = 0;
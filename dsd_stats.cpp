@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "dsd_stats.h"
+
+namespace DSDcc
+{
+
+thread_local DSDStats *DSDStats::m_current = 0;
+
+const char *DSDStatsSnapshot::getStageName(Stage stage)
+{
+    static const char *names[StageCount] = {
+        "filter", "symbol", "sync", "dmr", "dstar", "ysf", "dpmr", "nxdn", "fec", "mbelib"
+    };
+
+    return stage < StageCount ? names[stage] : "";
+}
+
+DSDStats::DSDStats()
+{
+    for (int i = 0; i < DSDStatsSnapshot::StageCount; i++)
+    {
+        m_cycles[i] = 0;
+        m_events[i] = 0;
+    }
+}
+
+void DSDStats::getSnapshot(DSDStatsSnapshot& snapshot) const
+{
+#ifdef DSD_INSTRUMENTATION
+    snapshot.m_enabled = true;
+#else
+    snapshot.m_enabled = false;
+#endif
+
+    for (int i = 0; i < DSDStatsSnapshot::StageCount; i++)
+    {
+        snapshot.m_cycles[i] = m_cycles[i].load(std::memory_order_relaxed);
+        snapshot.m_events[i] = m_events[i].load(std::memory_order_relaxed);
+    }
+}
+
+} // namespace DSDcc
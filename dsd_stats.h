@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSDCC_DSD_STATS_H_
+#define DSDCC_DSD_STATS_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#if defined(DSD_INSTRUMENTATION) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#elif defined(DSD_INSTRUMENTATION) && !defined(__aarch64__)
+#include <chrono>
+#endif
+
+#include "export.h"
+
+namespace DSDcc
+{
+
+/**
+ * Snapshot of the per stage counters. Cycles are inclusive: the symbol stage includes the filter stage
+ * and the protocol stages include the FEC stage. Cycles are TSC ticks on x86, virtual counter ticks on
+ * ARM64 and nanoseconds elsewhere.
+ */
+struct DSDCC_API DSDStatsSnapshot
+{
+    typedef enum
+    {
+        StageFilter,   //!< matched filter
+        StageSymbol,   //!< symbol recovery (DSDSymbol::pushSample)
+        StageSync,     //!< sync search and frame init
+        StageDMR,
+        StageDStar,
+        StageYSF,
+        StageDPMR,
+        StageNXDN,
+        StageFEC,      //!< FEC decoders
+        StageMbelib,   //!< speech synthesis
+        StageCount
+    } Stage;
+
+    bool m_enabled;                  //!< false when the library is built without DSD_INSTRUMENTATION
+    uint64_t m_cycles[StageCount];
+    uint64_t m_events[StageCount];   //!< number of times the stage was run
+
+    static const char *getStageName(Stage stage);
+};
+
+/**
+ * Per decoder stage counters. They may be updated from the vocoder threads and are read without locking.
+ * Instrumentation is compiled in with the DSD_INSTRUMENTATION definition only (cmake -DINSTRUMENTATION=ON).
+ */
+class DSDCC_API DSDStats
+{
+public:
+    DSDStats();
+
+    void add(DSDStatsSnapshot::Stage stage, uint64_t cycles)
+    {
+        m_cycles[stage].fetch_add(cycles, std::memory_order_relaxed);
+        m_events[stage].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void getSnapshot(DSDStatsSnapshot& snapshot) const;
+
+    static uint64_t cycles()
+    {
+#if defined(DSD_INSTRUMENTATION) && (defined(__x86_64__) || defined(__i386__))
+        return __rdtsc();
+#elif defined(DSD_INSTRUMENTATION) && defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r" (ticks));
+        return ticks;
+#elif defined(DSD_INSTRUMENTATION)
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+        return 0;
+#endif
+    }
+
+    /** Counters used by code that does not know its decoder (FEC) on the calling thread */
+    static DSDStats *current() { return m_current; }
+    static void setCurrent(DSDStats *stats) { m_current = stats; }
+
+private:
+    std::atomic<uint64_t> m_cycles[DSDStatsSnapshot::StageCount];
+    std::atomic<uint64_t> m_events[DSDStatsSnapshot::StageCount];
+    static thread_local DSDStats *m_current;
+};
+
+class DSDStatsScope
+{
+public:
+    DSDStatsScope(DSDStats *stats, DSDStatsSnapshot::Stage stage) :
+        m_stats(stats),
+        m_stage(stage),
+        m_start(DSDStats::cycles())
+    {}
+
+    ~DSDStatsScope()
+    {
+        if (m_stats) {
+            m_stats->add(m_stage, DSDStats::cycles() - m_start);
+        }
+    }
+
+private:
+    DSDStats *m_stats;
+    DSDStatsSnapshot::Stage m_stage;
+    uint64_t m_start;
+};
+
+/** Makes the counters current on the calling thread for the lifetime of the scope then restores the previous ones */
+class DSDStatsCurrentScope
+{
+public:
+    explicit DSDStatsCurrentScope(DSDStats *stats) :
+        m_previous(DSDStats::current())
+    {
+        DSDStats::setCurrent(stats);
+    }
+
+    ~DSDStatsCurrentScope()
+    {
+        DSDStats::setCurrent(m_previous);
+    }
+
+private:
+    DSDStats *m_previous;
+};
+
+} // namespace DSDcc
+
+#ifdef DSD_INSTRUMENTATION
+#define DSD_STATS_SCOPE(stats, stage) DSDcc::DSDStatsScope dsdStatsScope((stats), (stage))
+#define DSD_STATS_FEC_SCOPE() DSDcc::DSDStatsScope dsdStatsScope(DSDcc::DSDStats::current(), DSDcc::DSDStatsSnapshot::StageFEC)
+#define DSD_STATS_CURRENT_SCOPE(stats) DSDcc::DSDStatsCurrentScope dsdStatsCurrentScope((stats))
+#else
+#define DSD_STATS_SCOPE(stats, stage)
+#define DSD_STATS_FEC_SCOPE()
+#define DSD_STATS_CURRENT_SCOPE(stats)
+#endif
+
+#endif /* DSDCC_DSD_STATS_H_ */
@@ -17,8 +17,10 @@
 #include <iostream>
 #include <stdlib.h>
 #include <assert.h>
+#include <algorithm>
 
 #include "dsd_symbol.h"
+#include "dsd_sync.h"
 #include "dsd_decoder.h"
 
 namespace DSDcc
@@ -37,12 +39,17 @@ DSDSymbol::DSDSymbol(DSDDecoder *dsdDecoder) :
         m_zeroCrossingSlopeDivisor(232), // for 10 samples per symbol
         m_lmmidx(0),
         m_pllLock(true),
+        m_fixedPoint(false),
         m_lmmSamples(10*24),
         m_ringingFilter(48000.0, 4800.0, 0.99),
         m_pll(0.1, 0.003, 0.25),
+        m_pllQ15(0.1, 0.003, 0.25),
         m_binSymbolBuffer(1024),
+        m_softSymbolBuffer(1024),
         m_syncSymbolBuffer(64),
-		m_nonInvertedSyncSymbolBuffer(64)
+		m_nonInvertedSyncSymbolBuffer(64),
+        m_syncDibitRegister(0),
+        m_nonInvertedSyncDibitRegister(0)
 {
     noCarrier();
     m_umid = 0;
@@ -98,10 +105,14 @@ void DSDSymbol::resetZeroCrossing()
  */
 bool DSDSymbol::pushSample(short sample)
 {
+    DSD_STATS_SCOPE(&m_dsdDecoder->m_stats, DSDStatsSnapshot::StageSymbol);
+
     // matched filter
 
     if (m_dsdDecoder->m_opts.use_cosine_filter)
     {
+        DSD_STATS_SCOPE(&m_dsdDecoder->m_stats, DSDStatsSnapshot::StageFilter);
+
         if (m_samplesPerSymbol == 20) {
             sample = m_dsdFilters.nxdn_filter(sample); // 6.25 kHz for 2400 baud
         } else {
@@ -109,6 +120,11 @@ bool DSDSymbol::pushSample(short sample)
         }
     }
 
+    return pushFilteredSample(sample);
+}
+
+bool DSDSymbol::pushFilteredSample(short sample)
+{
     m_filteredSample = sample;
 
     if (!m_noSignal)
@@ -117,14 +133,23 @@ bool DSDSymbol::pushSample(short sample)
 
         // ringing filter
         short sampleSq = ((((int) sample)- m_center) * (((int) sample)- m_center)) >> 15;
-        short sampleRinging = m_ringingFilter.run(sampleSq);
+        short sampleRinging = m_fixedPoint ? m_ringingFilter.runQ15(sampleSq) : m_ringingFilter.run(sampleSq);
 
         if (m_pllLock)
         {
-            float pllOut[2];
-            float pllIn = sampleRinging / 32768.0f;
-            m_pll.process(pllIn, pllOut);
-            m_symbolSyncSample = pllOut[0] * 16384.0f;
+            if (m_fixedPoint)
+            {
+                int16_t pllOut[2];
+                m_pllQ15.process(sampleRinging, pllOut);
+                m_symbolSyncSample = pllOut[0] >> 1;
+            }
+            else
+            {
+                float psin, pcos;
+                float pllIn = sampleRinging / 32768.0f;
+                m_pll.process(pllIn, psin, pcos);
+                m_symbolSyncSample = psin * 16384.0f;
+            }
 
             // process with PLL
             if ((m_symbolSyncSample > 0) && (m_lastsample < 0))
@@ -269,7 +294,6 @@ bool DSDSymbol::pushSample(short sample)
         }
 
         m_symbol = m_sum / m_count;
-        m_dsdDecoder->m_state.symbolcnt++;
 
         digitizeIntoBinaryBuffer();
         resetSymbol();
@@ -291,6 +315,8 @@ bool DSDSymbol::pushSample(short sample)
 
         // min/max calculation
 
+        m_lmmSymbols.update(m_symbol);
+
         if (m_lmmidx < 24)
         {
             m_lmmidx++;
@@ -299,6 +325,7 @@ bool DSDSymbol::pushSample(short sample)
         {
             m_lmmidx = 0;
             snapMinMax();
+            m_lmmSymbols.reset();
         }
 
         return true; // new symbol available
@@ -312,11 +339,12 @@ bool DSDSymbol::pushSample(short sample)
 
 void DSDSymbol::snapLevels(int nbSymbols)
 {
-    memcpy(m_lbuf2, &m_lbuf[32 + m_lmmidx - nbSymbols], nbSymbols * sizeof(int)); // copy to working buffer
-    qsort(m_lbuf2, nbSymbols, sizeof(int), comp);
+    if (m_lmmSymbols.count() < (unsigned int) std::max(nbSymbols, 5)) {
+        return;
+    }
 
-    int lmin = (m_lbuf2[2] + m_lbuf2[3] + m_lbuf2[4]) / 3;
-    int lmax = (m_lbuf2[nbSymbols-3] + m_lbuf2[nbSymbols-4] + m_lbuf2[nbSymbols-5]) / 3;
+    int lmin = (m_lmmSymbols.lowest(2) + m_lmmSymbols.lowest(3) + m_lmmSymbols.lowest(4)) / 3;
+    int lmax = (m_lmmSymbols.highest(2) + m_lmmSymbols.highest(3) + m_lmmSymbols.highest(4)) / 3;
 
     m_max = m_max + (lmax - m_max) / 4; // alpha = 0.25
     m_min = m_min + (lmin - m_min) / 4; // alpha = 0.25
@@ -357,6 +385,8 @@ void DSDSymbol::setFSK(unsigned int nbSymbols, bool inverted)
 void DSDSymbol::setSamplesPerSymbol(int samplesPerSymbol)
 {
     m_samplesPerSymbol = samplesPerSymbol;
+    resetSymbol(); // the sample index of the previous rate may be past the conclusion of a symbol at the new rate
+    resetZeroCrossing();
 
     if (m_samplesPerSymbol == 5)
     {
@@ -366,6 +396,7 @@ void DSDSymbol::setSamplesPerSymbol(int samplesPerSymbol)
         m_ringingFilter.setFrequencies(48000.0, 9600.0);
         m_ringingFilter.setR(0.99);
         m_pll.configure(0.2, 0.003, 0.25);
+        m_pllQ15.configure(0.2, 0.003, 0.25);
     }
     else if (m_samplesPerSymbol == 10)
     {
@@ -375,6 +406,7 @@ void DSDSymbol::setSamplesPerSymbol(int samplesPerSymbol)
         m_ringingFilter.setFrequencies(48000.0, 4800.0);
         m_ringingFilter.setR(0.99);
         m_pll.configure(0.1, 0.003, 0.25);
+        m_pllQ15.configure(0.1, 0.003, 0.25);
     }
     else if (m_samplesPerSymbol == 20)
     {
@@ -384,6 +416,7 @@ void DSDSymbol::setSamplesPerSymbol(int samplesPerSymbol)
         m_ringingFilter.setFrequencies(48000.0, 2400.0);
         m_ringingFilter.setR(0.996);
         m_pll.configure(0.05, 0.003, 0.25);
+        m_pllQ15.configure(0.05, 0.003, 0.25);
     }
     else
     {
@@ -393,6 +426,7 @@ void DSDSymbol::setSamplesPerSymbol(int samplesPerSymbol)
         m_ringingFilter.setFrequencies(48000.0, 4800.0);
         m_ringingFilter.setR(0.99);
         m_pll.configure(0.1, 0.003, 0.25);
+        m_pllQ15.configure(0.1, 0.003, 0.25);
     }
 }
 
@@ -455,13 +489,63 @@ unsigned char DSDSymbol::digitize(int symbol)
 	}
 }
 
+DSDSoftDibit DSDSymbol::softDigitize(int symbol, unsigned char dibit) const
+{
+    DSDSoftDibit soft;
+    int upperScale = m_umid - m_center; // distance from the center to the outer symbols threshold
+    int lowerScale = m_center - m_lmid;
+
+    if (m_nbFSKSymbols == 2)
+    {
+        soft.m_bit1 = 0;
+        soft.m_bit0 = softBit(m_invertedFSK ? symbol - m_center : m_center - symbol, upperScale, dibit & 1);
+    }
+    else if (m_nbFSKSymbols == 4)
+    {
+        soft.m_bit1 = softBit(m_invertedFSK ? symbol - m_center : m_center - symbol, upperScale, dibit & 2);
+
+        if (symbol > m_center) {
+            soft.m_bit0 = softBit(symbol - m_umid, upperScale, dibit & 1);
+        } else {
+            soft.m_bit0 = softBit(m_lmid - symbol, lowerScale, dibit & 1);
+        }
+    }
+    else
+    {
+        soft.m_bit1 = 0;
+        soft.m_bit0 = 0;
+    }
+
+    return soft;
+}
+
+unsigned char DSDSymbol::softBit(int distance, int scale, bool hardBit)
+{
+    if (scale <= 0) { // levels not acquired yet
+        return hardBit ? 255 : 0;
+    }
+
+    int soft = 128 + (distance * 128) / scale;
+
+    if (hardBit) {
+        return soft < 128 ? 128 : soft > 255 ? 255 : soft; // keep on the side of the hard decision at the threshold
+    } else {
+        return soft > 127 ? 127 : soft < 0 ? 0 : soft;
+    }
+}
+
 void DSDSymbol::digitizeIntoBinaryBuffer()
 {
     // determine dibit state
     unsigned char binSymbol = digitize(m_symbol);
+    m_softSymbolBuffer.push(softDigitize(m_symbol, binSymbol));
+    unsigned char syncSymbol = m_symbol > 0 ? 1 : 3;
+    unsigned char nonInvertedSyncSymbol = (m_invertedFSK ? (m_symbol <= 0) : (m_symbol > 0)) ? 1 : 3;
     m_binSymbolBuffer.push(binSymbol);
-    m_syncSymbolBuffer.push(m_symbol > 0 ? 1 : 3);
-    m_nonInvertedSyncSymbolBuffer.push((m_invertedFSK ? (m_symbol <= 0) : (m_symbol > 0)) ? 1 : 3);
+    m_syncSymbolBuffer.push(syncSymbol);
+    m_nonInvertedSyncSymbolBuffer.push(nonInvertedSyncSymbol);
+    DSDSync::pushDibit(m_syncDibitRegister, syncSymbol);
+    DSDSync::pushDibit(m_nonInvertedSyncDibitRegister, nonInvertedSyncSymbol);
 }
 
 int DSDSymbol::invert_dibit(int dibit)
@@ -488,16 +572,6 @@ int DSDSymbol::getDibit()
     return get_dibit();
 }
 
-int DSDSymbol::comp(const void *a, const void *b)
-{
-    if (*((const int *) a) == *((const int *) b))
-        return 0;
-    else if (*((const int *) a) < *((const int *) b))
-        return -1;
-    else
-        return 1;
-}
-
 int DSDSymbol::compShort(const void *a, const void *b)
 {
     if (*((const short *) a) == *((const short *) b))
@@ -17,6 +17,8 @@
 #ifndef DSD_SYMBOL_H_
 #define DSD_SYMBOL_H_
 
+#include <stdint.h>
+
 #include "dsd_filters.h"
 #include "doublebuffer.h"
 #include "runningmaxmin.h"
@@ -28,6 +30,15 @@ namespace DSDcc
 
 class DSDDecoder;
 
+/** Soft decision on the bits of a symbol. Values range from 0 (surely 0) to 255 (surely 1) with the
+ *  hard decision threshold between 127 and 128. The magnitude grows with the distance of the symbol
+ *  to the decision threshold of the bit like a log-likelihood ratio. */
+struct DSDSoftDibit
+{
+    unsigned char m_bit1; //!< dibit MSB (always 0 for binary FSK)
+    unsigned char m_bit0; //!< dibit LSB or bit for binary FSK
+};
+
 class DSDCC_API DSDSymbol
 {
 public:
@@ -37,17 +48,22 @@ public:
     void noCarrier();
     void resetFrameSync();
 
-    void snapLevels(int nbSymbols); //!< take snapshot for min/max over a number of symbols
+    void snapLevels(int nbSymbols); //!< take snapshot for min/max over the symbols of the current 25 symbols window if there are at least nbSymbols
     void setSamplesPerSymbol(int samplesPerSymbol);
     void setFSK(unsigned int nbSymbols, bool inverted=false);
     void setNoSignal(bool noSignal) { m_noSignal = noSignal; }
     bool pushSample(short sample); //!< push a new sample into the decoder. Returns true if a new symbol is available
+    bool pushFilteredSample(short sample); //!< same as pushSample for a sample already through the matched filter
 
     int getSymbol() const { return m_symbol; }
     int getDibit(); //!< from the last retrieved symbol Returns either the bit (0,1) or the dibit value (0,1,2,3)
     unsigned char *getDibitBack(unsigned int shift) { return m_binSymbolBuffer.getBack(shift); }
+    const DSDSoftDibit& getSoftDibit() { return m_softSymbolBuffer.getLatest(); } //!< soft bits of the last retrieved symbol
+    DSDSoftDibit *getSoftDibitBack(unsigned int shift) { return m_softSymbolBuffer.getBack(shift); }
     unsigned char *getSyncDibitBack(unsigned int shift) { return m_syncSymbolBuffer.getBack(shift); }
     unsigned char *getNonInvertedSyncDibitBack(unsigned int shift) { return m_nonInvertedSyncSymbolBuffer.getBack(shift); }
+    uint64_t getSyncDibitRegister() const { return m_syncDibitRegister; } //!< last 32 sync dibits packed for DSDSync
+    uint64_t getNonInvertedSyncDibitRegister() const { return m_nonInvertedSyncDibitRegister; }
 
     static int invert_dibit(int dibit);
     int getLevel() const { return (m_max - m_min) / 328; }
@@ -57,8 +73,10 @@ public:
     short getFilteredSample() const { return m_filteredSample; }
     short getSymbolSyncSample() const { return m_symbolSyncSample; }
     int getSamplesPerSymbol() const { return m_samplesPerSymbol; }
-    bool getPLLLocked() const { return m_pllLock && m_pll.locked(); }
+    bool getPLLLocked() const { return m_pllLock && (m_fixedPoint ? m_pllQ15.locked() : m_pll.locked()); }
     void setPLLLock(bool pllLock) { m_pllLock = pllLock; }
+    void setFixedPoint(bool fixedPoint) { m_fixedPoint = fixedPoint; } //!< run symbol timing recovery in Q15 fixed point
+    bool getFixedPoint() const { return m_fixedPoint; }
 
     static void compressBits(const char *bitArray, unsigned char *byteArray, int nbBytes)
     {
@@ -81,9 +99,10 @@ private:
     int get_dibit();
 //    void use_symbol(int symbol);
     unsigned char digitize(int symbol);
+    DSDSoftDibit softDigitize(int symbol, unsigned char dibit) const;
+    static unsigned char softBit(int distance, int scale, bool hardBit);
     void digitizeIntoBinaryBuffer();
     void snapMinMax();
-    static int comp(const void *a, const void *b);
     static int compShort(const void *a, const void *b);
 
     DSDDecoder *m_dsdDecoder;
@@ -101,8 +120,7 @@ private:
     int m_zeroCrossingCorrectionProfile[11];
     int m_zeroCrossingSlopeDivisor;
 
-    int m_lbuf[32*2], m_lbuf2[32]; //!< symbol buffers for min/max
-    int m_lmmidx;                  //!< index in min/max symbol buffer
+    int m_lmmidx;                  //!< index in min/max symbol window
     int m_min, m_max;
     int m_center;
     int m_umid, m_lmid;
@@ -116,12 +134,18 @@ private:
     bool m_invertedFSK;
     int  m_samplesPerSymbol;
     bool m_pllLock;
+    bool m_fixedPoint; //!< ringing filter and PLL in Q15 fixed point
     lemiremaxmintruestreaming<short> m_lmmSamples;    //!< running min/max calculator
+    runningextremes<int, 5> m_lmmSymbols;             //!< 5 smallest and largest symbols of the min/max window
     DSDSecondOrderRecursiveFilter m_ringingFilter;
     SimplePhaseLock m_pll;
+    PhaseLockQ15 m_pllQ15;
     DoubleBuffer<unsigned char> m_binSymbolBuffer;    //!< digitized symbol
+    DoubleBuffer<DSDSoftDibit> m_softSymbolBuffer;    //!< soft bits of the digitized symbol
     DoubleBuffer<unsigned char> m_syncSymbolBuffer;   //!< symbol digitized for synchronization: positive is 1, negative is 3
     DoubleBuffer<unsigned char> m_nonInvertedSyncSymbolBuffer; //!< same but resetting to positive sync
+    uint64_t m_syncDibitRegister;            //!< sync symbols packed 2 bits per dibit latest in LSBs
+    uint64_t m_nonInvertedSyncDibitRegister; //!< same for non inverted sync symbols
 
     static const int m_zeroCrossingCorrectionProfile2400[11];
     static const int m_zeroCrossingCorrectionProfile4800[11];
@@ -88,6 +88,23 @@ const unsigned int DSDSync::m_syncLenTol[27][2] = {
     {32, 2}, // 26: SyncProVoiceEAInv
 };
 
+DSDSync::PackedPatterns::PackedPatterns()
+{
+    for (int p = 0; p < m_patterns; p++)
+    {
+        m_words[p] = 0;
+        m_masks[p] = 0;
+
+        for (int i = 0; i < m_history; i++) // oldest first
+        {
+            pushDibit(m_words[p], m_syncPatterns[p][i]);
+            m_masks[p] = (m_masks[p] << 2) | (m_syncPatterns[p][i] != 0 ? 1 : 0);
+        }
+    }
+}
+
+const DSDSync::PackedPatterns DSDSync::m_packedPatterns;
+
 const unsigned char *DSDSync::getPattern(SyncPattern pattern, int& length)
 {
     length = m_syncLenTol[(int) pattern][0];
@@ -137,6 +154,22 @@ void DSDSync::matchSome(const unsigned char *start, int maxHistory, const SyncPa
     }
 }
 
+void DSDSync::matchAll(uint64_t history)
+{
+    for (int p = 0; p < m_patterns; p++) {
+        m_syncErrors[p] = countErrors(history, p);
+    }
+}
+
+void DSDSync::matchSome(uint64_t history, const SyncPattern *patterns, int nbPatterns)
+{
+    std::fill(m_syncErrors, m_syncErrors + m_patterns, (unsigned int) m_history); // patterns not evaluated never match
+
+    for (int ip = 0; ip < nbPatterns; ip++) {
+        m_syncErrors[(int) patterns[ip]] = countErrors(history, (int) patterns[ip]);
+    }
+}
+
 bool DSDSync::isMatching(SyncPattern pattern)
 {
     return m_syncErrors[pattern] <= m_syncLenTol[pattern][1];
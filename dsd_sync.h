@@ -17,6 +17,8 @@
 #ifndef DSD_SYNC_H_
 #define DSD_SYNC_H_
 
+#include <stdint.h>
+
 #include "export.h"
 
 namespace DSDcc
@@ -65,8 +67,45 @@ public:
     static const unsigned char *getPattern(SyncPattern pattern, int& length);
     void matchAll(const unsigned char *start);
     void matchSome(const unsigned char *start, int maxHistory, const SyncPattern *patterns, int nbPatterns);
+    /**
+     * Bit parallel versions working on the last m_history dibits packed 2 bits per dibit in a 64 bit
+     * shift register with the most recent dibit in the least significant bits (see pushDibit).
+     * Errors are counted for all symbols of the patterns and are not capped at tolerance + 1
+     */
+    void matchAll(uint64_t history);
+    void matchSome(uint64_t history, const SyncPattern *patterns, int nbPatterns);
     bool isMatching(SyncPattern pattern);
     unsigned int getErrors(SyncPattern pattern);
+
+    static void pushDibit(uint64_t& history, unsigned char dibit) { history = (history << 2) | (dibit & 3); }
+
+private:
+    struct PackedPatterns
+    {
+        PackedPatterns();
+        uint64_t m_words[m_patterns];    //!< dibits packed like in the history register
+        uint64_t m_masks[m_patterns];    //!< LSB of each significant dibit position set
+    };
+
+    static const PackedPatterns m_packedPatterns;
+
+    static unsigned int countErrors(uint64_t history, int pattern)
+    {
+        uint64_t diff = history ^ m_packedPatterns.m_words[pattern];
+        return popcount64((diff | (diff >> 1)) & m_packedPatterns.m_masks[pattern]);
+    }
+
+    static unsigned int popcount64(uint64_t x)
+    {
+#if defined(__GNUC__) && (defined(__POPCNT__) || defined(__aarch64__)) // libgcc fallback is slower than SWAR
+        return __builtin_popcountll(x);
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (unsigned int) ((x * 0x0101010101010101ULL) >> 56);
+#endif
+    }
 };
 
 } // namespace DSDcc
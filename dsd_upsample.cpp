@@ -70,9 +70,34 @@ void DSDUpsampler::upsampleOne(int upsampling, short inValue, short *outValues)
 
 void DSDUpsampler::upsample(int upsampling, short *in, short *out, int nbSamplesIn)
 {
-    for (int i = 0; i < nbSamplesIn; i++)
+    if (upsampling == 6) {
+        upsampleBlock<6>(in, out, nbSamplesIn);
+    } else if (upsampling == 7) {
+        upsampleBlock<7>(in, out, nbSamplesIn);
+    }
+}
+
+template <int Upsampling>
+void DSDUpsampler::upsampleBlock(const short *in, short *out, int nbSamplesIn)
+{
+    // polyphase form of upsampleOne: with the factor known at compile time the phases
+    // are unrolled and the divisions are by a constant
+    int prev = (int) m_upsamplerLastValue;
+
+    for (int i = 0; i < nbSamplesIn; i++, out += Upsampling)
     {
-        upsampleOne(upsampling, in[i], &out[upsampling*i]);
+        int cur = (int) in[i];
+
+        for (int k = 1; k < Upsampling; k++) {
+            out[k-1] = (cur*k + prev*(Upsampling-k)) / Upsampling;
+        }
+
+        out[Upsampling-1] = in[i];
+        prev = cur;
+    }
+
+    if (nbSamplesIn > 0) {
+        m_upsamplerLastValue = in[nbSamplesIn-1];
     }
 }
 
@@ -30,6 +30,8 @@ public:
     void upsample(int upsampling, short *in, short *out, int nbSamplesIn);
 
 private:
+    template <int Upsampling> void upsampleBlock(const short *in, short *out, int nbSamplesIn);
+
     short m_upsamplerLastValue;
 };
 
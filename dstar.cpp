@@ -143,8 +143,7 @@ DSDDstar::DSDDstar(DSDDecoder *dsdDecoder) :
         m_viterbi(2, Viterbi::Poly23a, false),
         m_crc(CRC::PolyDStar16, 16, 0xffff, 0xffff, 1, 0, 0),
 		slowdataIx(0),
-		w(0),
-		x(0)
+		m_voiceDeinterleaver(dW, dX, 24, 72, 96)
 {
     reset_header_strings();
     m_slowData.init();
@@ -184,9 +183,6 @@ void DSDDstar::initVoiceFrame()
 {
     memset(m_dsdDecoder->ambe_fr, 0, 96);
     memset((void *) m_dsdDecoder->m_mbeDVFrame1, 0, 9); // initialize DVSI frame
-    // voice frame
-    w = dW;
-    x = dX;
 }
 void DSDDstar::initDataFrame()
 {
@@ -222,9 +218,7 @@ void DSDDstar::processVoice()
         initVoiceFrame();
     }
 
-    m_dsdDecoder->ambe_fr[*w][*x] = (1 & bit);
-    w++;
-    x++;
+    m_voiceDeinterleaver.pushBit(m_symbolIndex, bit);
 
     storeSymbolDV(m_symbolIndex, (1 & bit)); // store bits in order in DVSI frame
 
@@ -236,6 +230,7 @@ void DSDDstar::processVoice()
             m_dsdDecoder->getLogger().log("\nMBE: ");
         }
 
+        m_voiceDeinterleaver.getBits((unsigned char *) m_dsdDecoder->ambe_fr);
         m_dsdDecoder->m_mbeDecoder1.processFrame(0, m_dsdDecoder->ambe_fr, 0);
         m_dsdDecoder->m_mbeDVReady1 = true; // Indicate that a DVSI frame is available
 
@@ -460,7 +455,7 @@ void DSDDstar::processSync()
     {
         DSDSync syncEngine;
         const DSDSync::SyncPattern patterns[1] = { DSDSync::SyncDStar };
-        syncEngine.matchSome(m_dsdDecoder->m_dsdSymbol.getNonInvertedSyncDibitBack(24), 24, patterns, 1);
+        syncEngine.matchSome(m_dsdDecoder->m_dsdSymbol.getNonInvertedSyncDibitRegister(), patterns, 1);
 
         if (syncEngine.isMatching(DSDSync::SyncDStar)) // sync
         {
@@ -516,10 +511,26 @@ void DSDDstar::dstar_header_decode()
     int octetcount, bitcount, loop;
     unsigned char bit2octet[] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
 
-    Descramble::scramble(m_dsdDecoder->m_dsdSymbol.getDibitBack(660), radioheaderbuffer2);
-    Descramble::deinterleave(radioheaderbuffer2, radioheaderbuffer3);
-//    Descramble::FECdecoder(radioheaderbuffer3, radioheaderbuffer2);
-    m_viterbi.decodeFromBits(radioheaderbuffer2, radioheaderbuffer3, 660, 0);
+    if (m_dsdDecoder->m_opts.soft_dstar)
+    {
+        const DSDSoftDibit *softDibits = m_dsdDecoder->m_dsdSymbol.getSoftDibitBack(660);
+
+        for (loop = 0; loop < 660; loop++) {
+            radioheaderbuffer3[loop] = softDibits[loop].m_bit0;
+        }
+
+        Descramble::scrambleSoft(radioheaderbuffer3, radioheaderbuffer2);
+        Descramble::deinterleave(radioheaderbuffer2, radioheaderbuffer3);
+        m_viterbi.decodeFromSoftBits(radioheaderbuffer2, radioheaderbuffer3, 660, 0);
+    }
+    else
+    {
+        Descramble::scramble(m_dsdDecoder->m_dsdSymbol.getDibitBack(660), radioheaderbuffer2);
+        Descramble::deinterleave(radioheaderbuffer2, radioheaderbuffer3);
+//        Descramble::FECdecoder(radioheaderbuffer3, radioheaderbuffer2);
+        m_viterbi.decodeFromBits(radioheaderbuffer2, radioheaderbuffer3, 660, 0);
+    }
+
     memset(radioheader, 0, 41);
 
     // note we receive 330 bits, but we only use 328 of them (41 octets)
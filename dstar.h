@@ -20,6 +20,7 @@
 #include <string>
 #include "viterbi3.h"
 #include "crc.h"
+#include "deinterleave.h"
 #include "locator.h"
 #include "export.h"
 
@@ -210,7 +211,7 @@ private:
    unsigned char nullBytes[4];
    unsigned char slowdata[4];
    unsigned int slowdataIx;
-   const int *w, *x;
+   Deinterleaver m_voiceDeinterleaver;
 
    // DSTAR-HD
    DStarHeader m_header;
@@ -16,11 +16,206 @@
 
 #include <iostream>
 #include <string.h>
+#include <mutex>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "fec.h"
+#include "dsd_stats.h"
 
 namespace DSDcc
 {
 
+// Packed codewords hold the first bit of the bit array in their most significant bit (bit n-1)
+
+static inline unsigned int parity(uint32_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_parity(x);
+#else
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return x & 1;
+#endif
+}
+
+static inline uint32_t packBits(const unsigned char *bits, int nbBits)
+{
+    uint32_t word = 0;
+
+    for (int i = 0; i < nbBits; i++) {
+        word = (word << 1) | (bits[i] & 1);
+    }
+
+    return word;
+}
+
+static inline void flipBits(unsigned char *bits, int nbBits, uint32_t mask)
+{
+    if (mask == 0) {
+        return;
+    }
+
+    for (int i = 0; i < nbBits; i++) {
+        bits[i] ^= (mask >> (nbBits - 1 - i)) & 1;
+    }
+}
+
+static inline unsigned int syndrome(uint32_t codeword, const uint32_t *Hwords, int nbRows)
+{
+    unsigned int syndromeI = 0;
+
+    for (int is = 0; is < nbRows; is++) {
+        syndromeI = (syndromeI << 1) | parity(codeword & Hwords[is]);
+    }
+
+    return syndromeI;
+}
+
+static void packRows(const unsigned char *H, int nbBits, int nbRows, uint32_t *Hwords)
+{
+    for (int is = 0; is < nbRows; is++) {
+        Hwords[is] = packBits(&H[nbBits*is], nbBits);
+    }
+}
+
+// Syndromes of a series of codewords computed 4 at a time with the parity bits folded by shifts
+static void syndromes(const uint32_t *codewords, uint32_t *syndromesI, int nbCodewords, const uint32_t *Hwords, int nbRows)
+{
+    int ic = 0;
+#if defined(__SSE2__)
+    for (; ic + 4 <= nbCodewords; ic += 4)
+    {
+        __m128i cw = _mm_loadu_si128((const __m128i *) &codewords[ic]);
+        __m128i syndromeI = _mm_setzero_si128();
+
+        for (int is = 0; is < nbRows; is++)
+        {
+            __m128i v = _mm_and_si128(cw, _mm_set1_epi32(Hwords[is]));
+            v = _mm_xor_si128(v, _mm_srli_epi32(v, 16));
+            v = _mm_xor_si128(v, _mm_srli_epi32(v, 8));
+            v = _mm_xor_si128(v, _mm_srli_epi32(v, 4));
+            v = _mm_xor_si128(v, _mm_srli_epi32(v, 2));
+            v = _mm_xor_si128(v, _mm_srli_epi32(v, 1));
+            syndromeI = _mm_or_si128(_mm_slli_epi32(syndromeI, 1), _mm_and_si128(v, _mm_set1_epi32(1)));
+        }
+
+        _mm_storeu_si128((__m128i *) &syndromesI[ic], syndromeI);
+    }
+#elif defined(__ARM_NEON)
+    for (; ic + 4 <= nbCodewords; ic += 4)
+    {
+        uint32x4_t cw = vld1q_u32(&codewords[ic]);
+        uint32x4_t syndromeI = vdupq_n_u32(0);
+
+        for (int is = 0; is < nbRows; is++)
+        {
+            uint32x4_t v = vandq_u32(cw, vdupq_n_u32(Hwords[is]));
+            v = veorq_u32(v, vshrq_n_u32(v, 16));
+            v = veorq_u32(v, vshrq_n_u32(v, 8));
+            v = veorq_u32(v, vshrq_n_u32(v, 4));
+            v = veorq_u32(v, vshrq_n_u32(v, 2));
+            v = veorq_u32(v, vshrq_n_u32(v, 1));
+            syndromeI = vorrq_u32(vshlq_n_u32(syndromeI, 1), vandq_u32(v, vdupq_n_u32(1)));
+        }
+
+        vst1q_u32(&syndromesI[ic], syndromeI);
+    }
+#endif
+    for (; ic < nbCodewords; ic++) {
+        syndromesI[ic] = syndrome(codewords[ic], Hwords, nbRows);
+    }
+}
+
+// Batch decoding by blocks of 32 codewords that is one error map word. The information bits are the first
+// nbRows bits (parity bits) shifted out.
+template<typename CorrectSyndrome>
+static bool decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap,
+        const uint32_t *Hwords, int nbRows, CorrectSyndrome correctSyndrome)
+{
+    uint32_t syndromesI[32];
+    bool correctable = true;
+
+    for (int ic0 = 0; ic0 < nbCodewords; ic0 += 32)
+    {
+        int nbBlock = nbCodewords - ic0 < 32 ? nbCodewords - ic0 : 32;
+        uint32_t errors = 0;
+        syndromes(&codewords[ic0], syndromesI, nbBlock, Hwords, nbRows);
+
+        for (int ic = 0; ic < nbBlock; ic++)
+        {
+            if (!correctSyndrome(codewords[ic0 + ic], syndromesI[ic])) {
+                errors |= 1U << ic;
+            }
+
+            if (data) {
+                data[ic0 + ic] = codewords[ic0 + ic] >> nbRows;
+            }
+        }
+
+        if (errorMap) {
+            errorMap[ic0 / 32] = errors;
+        }
+
+        correctable = correctable && (errors == 0);
+    }
+
+    return correctable;
+}
+
+// Bit array adapter for codecs that take several codewords. Codewords after an uncorrectable one are left
+// untouched when stopOnError is set.
+template<class Codec>
+static bool decodeBitCodewords(Codec& codec, unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords,
+        int nbBits, int nbInfoBits, bool stopOnError)
+{
+    uint32_t codewords[32], corrected[32];
+    uint32_t errors;
+    bool correctable = true;
+
+    for (int ic0 = 0; ic0 < nbCodewords; ic0 += 32)
+    {
+        int nbBlock = nbCodewords - ic0 < 32 ? nbCodewords - ic0 : 32;
+
+        for (int ic = 0; ic < nbBlock; ic++) {
+            codewords[ic] = corrected[ic] = packBits(&rxBits[nbBits*(ic0 + ic)], nbBits);
+        }
+
+        codec.decodeBatch(corrected, 0, nbBlock, &errors);
+
+        for (int ic = 0; ic < nbBlock; ic++)
+        {
+            if ((errors >> ic) & 1)
+            {
+                correctable = false;
+
+                if (stopOnError) {
+                    return false;
+                }
+            }
+
+            flipBits(&rxBits[nbBits*(ic0 + ic)], nbBits, codewords[ic] ^ corrected[ic]);
+
+            // move information bits
+            if (decodedBits) {
+                memcpy(&decodedBits[nbInfoBits*(ic0 + ic)], &rxBits[nbBits*(ic0 + ic)], nbInfoBits);
+            }
+        }
+    }
+
+    return correctable;
+}
+
+unsigned char Hamming_7_4::m_corr[8];
+uint32_t Hamming_7_4::m_Hwords[3];
+
 const unsigned char Hamming_7_4::m_G[7*4] = {
         1, 0, 0, 0,   1, 0, 1,
         0, 1, 0, 0,   1, 1, 1,
@@ -37,6 +232,9 @@ const unsigned char Hamming_7_4::m_H[7*3] = {
 
 // ========================================================================================
 
+unsigned char Hamming_12_8::m_corr[16];
+uint32_t Hamming_12_8::m_Hwords[4];
+
 const unsigned char Hamming_12_8::m_G[12*8] = {
         1, 0, 0, 0, 0, 0, 0, 0,   1, 1, 1, 0,
         0, 1, 0, 0, 0, 0, 0, 0,   0, 1, 1, 1,
@@ -58,6 +256,9 @@ const unsigned char Hamming_12_8::m_H[12*4] = {
 
 // ========================================================================================
 
+unsigned char Hamming_15_11::m_corr[16];
+uint32_t Hamming_15_11::m_Hwords[4];
+
 const unsigned char Hamming_15_11::m_G[15*11] = {
         1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   1, 0, 0, 1,
         0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,   1, 1, 0, 1,
@@ -83,6 +284,9 @@ const unsigned char Hamming_15_11::m_H[15*4] = {
 
 // ========================================================================================
 
+unsigned char Hamming_16_11_4::m_corr[32];
+uint32_t Hamming_16_11_4::m_Hwords[5];
+
 const unsigned char Hamming_16_11_4::m_G[16*11] = {
         1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   1, 0, 0, 1, 1,
         0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,   1, 1, 0, 1, 0,
@@ -107,6 +311,9 @@ const unsigned char Hamming_16_11_4::m_H[16*5] = {
 
 // ========================================================================================
 
+unsigned char Golay_20_8::m_corr[4096][3];
+uint32_t Golay_20_8::m_Hwords[12];
+
 const unsigned char Golay_20_8::m_G[20*8] = {
         1, 0, 0, 0, 0, 0, 0, 0,    0, 0, 1, 1,  1, 1, 0, 1,  1, 0, 1, 0,
         0, 1, 0, 0, 0, 0, 0, 0,    1, 1, 0, 1,  1, 0, 0, 1,  1, 0, 0, 1,
@@ -135,6 +342,9 @@ const unsigned char Golay_20_8::m_H[20*12] = {
 
 // ========================================================================================
 
+unsigned char Golay_23_12::m_corr[2048][3];
+uint32_t Golay_23_12::m_Hwords[11];
+
 const unsigned char Golay_23_12::m_G[23*12] = {
         1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   1, 1, 0, 0, 0, 1, 1, 1, 0, 1, 0,
         0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 1, 1, 0, 0, 0, 1, 1, 1, 0, 1,
@@ -166,6 +376,9 @@ const unsigned char Golay_23_12::m_H[23*11] = {
 
 // ========================================================================================
 
+unsigned char Golay_24_12::m_corr[4096][3];
+uint32_t Golay_24_12::m_Hwords[12];
+
 const unsigned char Golay_24_12::m_G[24*12] = {
         1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   1, 1, 0, 0, 0, 1, 1, 1, 0, 1, 0, 1,
         0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 1, 1, 0, 0, 0, 1, 1, 1, 0, 1, 1,
@@ -198,6 +411,9 @@ const unsigned char Golay_24_12::m_H[24*12] = {
 
 // ========================================================================================
 
+unsigned char QR_16_7_6::m_corr[512][2];
+uint32_t QR_16_7_6::m_Hwords[9];
+
 const unsigned char QR_16_7_6::m_G[16*7] = {
         1, 0, 0, 0, 0, 0, 0,    0, 0, 1, 0, 0, 1, 1, 1, 1,
         0, 1, 0, 0, 0, 0, 0,    1, 0, 0, 0, 1, 1, 1, 1, 0,
@@ -232,6 +448,14 @@ Hamming_7_4::~Hamming_7_4()
 
 void Hamming_7_4::init()
 {
+    static std::once_flag tablesBuilt;
+    std::call_once(tablesBuilt, buildTables);
+}
+
+void Hamming_7_4::buildTables()
+{
+    packRows(m_H, 7, 3, m_Hwords);
+
     // correctable bit positions given syndrome bits as index (see above)
     memset(m_corr, 0xFF, 8); // initialize with all invalid positions
     m_corr[0b101] = 0;
@@ -264,34 +488,48 @@ void Hamming_7_4::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Hamming_7_4::decode(unsigned char *rxBits) // corrects in place
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = packBits(rxBits, 7);
+    uint32_t corrected = codeword;
+    bool correctable = correct(corrected);
+    flipBits(rxBits, 7, codeword ^ corrected);
+    return correctable;
+}
 
-    for (int is = 0; is < 3; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[7*is + 0])
-                    + (rxBits[1] * m_H[7*is + 1])
-                    + (rxBits[2] * m_H[7*is + 2])
-                    + (rxBits[3] * m_H[7*is + 3])
-                    + (rxBits[4] * m_H[7*is + 4])
-                    + (rxBits[5] * m_H[7*is + 5])
-                    + (rxBits[6] * m_H[7*is + 6])) % 2) << (2-is);
+bool Hamming_7_4::correct(uint32_t& codeword)
+{
+    DSD_STATS_FEC_SCOPE();
+    return correctSyndrome(codeword, syndrome(codeword, m_Hwords, 3));
+}
+
+bool Hamming_7_4::decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap)
+{
+    DSD_STATS_FEC_SCOPE();
+    return DSDcc::decodeBatch(codewords, data, nbCodewords, errorMap, m_Hwords, 3,
+            [this](uint32_t& codeword, unsigned int syndromeI) { return correctSyndrome(codeword, syndromeI); });
+}
+
+bool Hamming_7_4::correctSyndrome(uint32_t& codeword, unsigned int syndromeI)
+{
+    if (syndromeI == 0) {
+        return true;
     }
 
-    if (syndromeI > 0)
-    {
-        if (m_corr[syndromeI] == 0xFF)
-        {
-            return false;
-        }
-        else
-        {
-            rxBits[m_corr[syndromeI]] ^= 1; // flip bit
-        }
+    if (m_corr[syndromeI] == 0xFF) { // uncorrectable error
+        return false;
     }
 
+    codeword ^= 1U << (6 - m_corr[syndromeI]); // flip bit
+
     return true;
 }
 
+bool Hamming_7_4::decode(uint32_t codeword, uint16_t& data)
+{
+    bool correctable = correct(codeword);
+    data = codeword >> 3;
+    return correctable;
+}
+
 // ========================================================================================
 
 Hamming_12_8::Hamming_12_8()
@@ -305,6 +543,14 @@ Hamming_12_8::~Hamming_12_8()
 
 void Hamming_12_8::init()
 {
+    static std::once_flag tablesBuilt;
+    std::call_once(tablesBuilt, buildTables);
+}
+
+void Hamming_12_8::buildTables()
+{
+    packRows(m_H, 12, 4, m_Hwords);
+
     // correctable bit positions given syndrome bits as index (see above)
     memset(m_corr, 0xFF, 16); // initialize with all invalid positions
     m_corr[0b1110] = 0;
@@ -342,48 +588,41 @@ void Hamming_12_8::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Hamming_12_8::decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords)
 {
-    bool correctable = true;
+    return decodeBitCodewords(*this, rxBits, decodedBits, nbCodewords, 12, 8, false);
+}
 
-    for (int ic = 0; ic < nbCodewords; ic++)
-    {
-        // calculate syndrome
+bool Hamming_12_8::correct(uint32_t& codeword)
+{
+    DSD_STATS_FEC_SCOPE();
+    return correctSyndrome(codeword, syndrome(codeword, m_Hwords, 4));
+}
 
-        int syndromeI = 0; // syndrome index
+bool Hamming_12_8::decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap)
+{
+    DSD_STATS_FEC_SCOPE();
+    return DSDcc::decodeBatch(codewords, data, nbCodewords, errorMap, m_Hwords, 4,
+            [this](uint32_t& codeword, unsigned int syndromeI) { return correctSyndrome(codeword, syndromeI); });
+}
 
-        for (int is = 0; is < 4; is++)
-        {
-            syndromeI += (((rxBits[12*ic +  0] * m_H[12*is +  0])
-                         + (rxBits[12*ic +  1] * m_H[12*is +  1])
-                         + (rxBits[12*ic +  2] * m_H[12*is +  2])
-                         + (rxBits[12*ic +  3] * m_H[12*is +  3])
-                         + (rxBits[12*ic +  4] * m_H[12*is +  4])
-                         + (rxBits[12*ic +  5] * m_H[12*is +  5])
-                         + (rxBits[12*ic +  6] * m_H[12*is +  6])
-                         + (rxBits[12*ic +  7] * m_H[12*is +  7])
-                         + (rxBits[12*ic +  8] * m_H[12*is +  8])
-                         + (rxBits[12*ic +  9] * m_H[12*is +  9])
-                         + (rxBits[12*ic + 10] * m_H[12*is + 10])
-                         + (rxBits[12*ic + 11] * m_H[12*is + 11])) % 2) << (3-is);
-        }
+bool Hamming_12_8::correctSyndrome(uint32_t& codeword, unsigned int syndromeI)
+{
+    if (syndromeI == 0) {
+        return true;
+    }
 
-        // correct bit
+    if (m_corr[syndromeI] == 0xFF) { // uncorrectable error
+        return false;
+    }
 
-        if (syndromeI > 0) // single bit error correction
-        {
-            if (m_corr[syndromeI] == 0xFF) // uncorrectable error
-            {
-                correctable = false;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI]] ^= 1; // flip bit
-            }
-        }
+    codeword ^= 1U << (11 - m_corr[syndromeI]); // flip bit
 
-        // move information bits
-        memcpy(&decodedBits[8*ic], &rxBits[12*ic], 8);
-    }
+    return true;
+}
 
+bool Hamming_12_8::decode(uint32_t codeword, uint16_t& data)
+{
+    bool correctable = correct(codeword);
+    data = codeword >> 4;
     return correctable;
 }
 
@@ -400,6 +639,14 @@ Hamming_16_11_4::~Hamming_16_11_4()
 
 void Hamming_16_11_4::init()
 {
+    static std::once_flag tablesBuilt;
+    std::call_once(tablesBuilt, buildTables);
+}
+
+void Hamming_16_11_4::buildTables()
+{
+    packRows(m_H, 16, 5, m_Hwords);
+
     // correctable bit positions given syndrome bits as index (see above)
     memset(m_corr, 0xFF, 32); // initialize with all invalid positions
     m_corr[0b10011] = 0;
@@ -441,56 +688,41 @@ void Hamming_16_11_4::encode(unsigned char *origBits, unsigned char *encodedBits
 
 bool Hamming_16_11_4::decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords)
 {
-    bool correctable = true;
+    return decodeBitCodewords(*this, rxBits, decodedBits, nbCodewords, 16, 11, true);
+}
 
-    for (int ic = 0; ic < nbCodewords; ic++)
-    {
-        // calculate syndrome
+bool Hamming_16_11_4::correct(uint32_t& codeword)
+{
+    DSD_STATS_FEC_SCOPE();
+    return correctSyndrome(codeword, syndrome(codeword, m_Hwords, 5));
+}
 
-        int syndromeI = 0; // syndrome index
+bool Hamming_16_11_4::decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap)
+{
+    DSD_STATS_FEC_SCOPE();
+    return DSDcc::decodeBatch(codewords, data, nbCodewords, errorMap, m_Hwords, 5,
+            [this](uint32_t& codeword, unsigned int syndromeI) { return correctSyndrome(codeword, syndromeI); });
+}
 
-        for (int is = 0; is < 5; is++)
-        {
-            syndromeI += (((rxBits[16*ic +  0] * m_H[16*is +  0])
-                         + (rxBits[16*ic +  1] * m_H[16*is +  1])
-                         + (rxBits[16*ic +  2] * m_H[16*is +  2])
-                         + (rxBits[16*ic +  3] * m_H[16*is +  3])
-                         + (rxBits[16*ic +  4] * m_H[16*is +  4])
-                         + (rxBits[16*ic +  5] * m_H[16*is +  5])
-                         + (rxBits[16*ic +  6] * m_H[16*is +  6])
-                         + (rxBits[16*ic +  7] * m_H[16*is +  7])
-                         + (rxBits[16*ic +  8] * m_H[16*is +  8])
-                         + (rxBits[16*ic +  9] * m_H[16*is +  9])
-                         + (rxBits[16*ic + 10] * m_H[16*is + 10])
-                         + (rxBits[16*ic + 11] * m_H[16*is + 11])
-                         + (rxBits[16*ic + 12] * m_H[16*is + 12])
-                         + (rxBits[16*ic + 13] * m_H[16*is + 13])
-                         + (rxBits[16*ic + 14] * m_H[16*is + 14])
-                         + (rxBits[16*ic + 15] * m_H[16*is + 15])) % 2) << (4-is);
-        }
+bool Hamming_16_11_4::correctSyndrome(uint32_t& codeword, unsigned int syndromeI)
+{
+    if (syndromeI == 0) {
+        return true;
+    }
 
-        // correct bit
+    if (m_corr[syndromeI] == 0xFF) { // uncorrectable error
+        return false;
+    }
 
-        if (syndromeI > 0) // single bit error correction
-        {
-            if (m_corr[syndromeI] == 0xFF) // uncorrectable error
-            {
-                correctable = false;
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI]] ^= 1; // flip bit
-            }
-        }
+    codeword ^= 1U << (15 - m_corr[syndromeI]); // flip bit
 
-        // move information bits
-        if (decodedBits)
-        {
-            memcpy(&decodedBits[11*ic], &rxBits[16*ic], 11);
-        }
-    }
+    return true;
+}
 
+bool Hamming_16_11_4::decode(uint32_t codeword, uint16_t& data)
+{
+    bool correctable = correct(codeword);
+    data = codeword >> 5;
     return correctable;
 }
 
@@ -507,6 +739,14 @@ Hamming_15_11::~Hamming_15_11()
 
 void Hamming_15_11::init()
 {
+    static std::once_flag tablesBuilt;
+    std::call_once(tablesBuilt, buildTables);
+}
+
+void Hamming_15_11::buildTables()
+{
+    packRows(m_H, 15, 4, m_Hwords);
+
     // correctable bit positions given syndrome bits as index (see above)
     memset(m_corr, 0xFF, 16); // initialize with all invalid positions
     m_corr[0b1001] = 0;
@@ -547,55 +787,41 @@ void Hamming_15_11::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Hamming_15_11::decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords)
 {
-    bool correctable = true;
+    return decodeBitCodewords(*this, rxBits, decodedBits, nbCodewords, 15, 11, true);
+}
 
-    for (int ic = 0; ic < nbCodewords; ic++)
-    {
-        // calculate syndrome
+bool Hamming_15_11::correct(uint32_t& codeword)
+{
+    DSD_STATS_FEC_SCOPE();
+    return correctSyndrome(codeword, syndrome(codeword, m_Hwords, 4));
+}
 
-        int syndromeI = 0; // syndrome index
+bool Hamming_15_11::decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap)
+{
+    DSD_STATS_FEC_SCOPE();
+    return DSDcc::decodeBatch(codewords, data, nbCodewords, errorMap, m_Hwords, 4,
+            [this](uint32_t& codeword, unsigned int syndromeI) { return correctSyndrome(codeword, syndromeI); });
+}
 
-        for (int is = 0; is < 4; is++)
-        {
-            syndromeI += (((rxBits[15*ic +  0] * m_H[15*is +  0])
-                         + (rxBits[15*ic +  1] * m_H[15*is +  1])
-                         + (rxBits[15*ic +  2] * m_H[15*is +  2])
-                         + (rxBits[15*ic +  3] * m_H[15*is +  3])
-                         + (rxBits[15*ic +  4] * m_H[15*is +  4])
-                         + (rxBits[15*ic +  5] * m_H[15*is +  5])
-                         + (rxBits[15*ic +  6] * m_H[15*is +  6])
-                         + (rxBits[15*ic +  7] * m_H[15*is +  7])
-                         + (rxBits[15*ic +  8] * m_H[15*is +  8])
-                         + (rxBits[15*ic +  9] * m_H[15*is +  9])
-                         + (rxBits[15*ic + 10] * m_H[15*is + 10])
-                         + (rxBits[15*ic + 11] * m_H[15*is + 11])
-                         + (rxBits[15*ic + 12] * m_H[15*is + 12])
-                         + (rxBits[15*ic + 13] * m_H[15*is + 13])
-                         + (rxBits[15*ic + 14] * m_H[15*is + 14])) % 2) << (3-is);
-        }
+bool Hamming_15_11::correctSyndrome(uint32_t& codeword, unsigned int syndromeI)
+{
+    if (syndromeI == 0) {
+        return true;
+    }
 
-        // correct bit
+    if (m_corr[syndromeI] == 0xFF) { // uncorrectable error
+        return false;
+    }
 
-        if (syndromeI > 0) // single bit error correction
-        {
-            if (m_corr[syndromeI] == 0xFF) // uncorrectable error
-            {
-                correctable = false;
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI]] ^= 1; // flip bit
-            }
-        }
+    codeword ^= 1U << (14 - m_corr[syndromeI]); // flip bit
 
-        // move information bits
-        if (decodedBits)
-        {
-            memcpy(&decodedBits[11*ic], &rxBits[15*ic], 11);
-        }
-    }
+    return true;
+}
 
+bool Hamming_15_11::decode(uint32_t codeword, uint16_t& data)
+{
+    bool correctable = correct(codeword);
+    data = codeword >> 4;
     return correctable;
 }
 
@@ -612,6 +838,14 @@ Golay_20_8::~Golay_20_8()
 
 void Golay_20_8::init()
 {
+    static std::once_flag tablesBuilt;
+    std::call_once(tablesBuilt, buildTables);
+}
+
+void Golay_20_8::buildTables()
+{
+    packRows(m_H, 20, 12, m_Hwords);
+
     memset (m_corr, 0xFF, 3*4096);
 
     for (int i1 = 0; i1 < 8; i1++)
@@ -725,57 +959,54 @@ void Golay_20_8::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Golay_20_8::decode(unsigned char *rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = packBits(rxBits, 20);
+    uint32_t corrected = codeword;
+    bool correctable = correct(corrected);
+    flipBits(rxBits, 20, codeword ^ corrected);
+    return correctable;
+}
 
-    for (int is = 0; is < 12; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[20*is + 0])
-                    + (rxBits[1] * m_H[20*is + 1])
-                    + (rxBits[2] * m_H[20*is + 2])
-                    + (rxBits[3] * m_H[20*is + 3])
-                    + (rxBits[4] * m_H[20*is + 4])
-                    + (rxBits[5] * m_H[20*is + 5])
-                    + (rxBits[6] * m_H[20*is + 6])
-                    + (rxBits[7] * m_H[20*is + 7])
-                    + (rxBits[8] * m_H[20*is + 8])
-                    + (rxBits[9] * m_H[20*is + 9])
-                    + (rxBits[10] * m_H[20*is + 10])
-                    + (rxBits[11] * m_H[20*is + 11])
-                    + (rxBits[12] * m_H[20*is + 12])
-                    + (rxBits[13] * m_H[20*is + 13])
-                    + (rxBits[14] * m_H[20*is + 14])
-                    + (rxBits[15] * m_H[20*is + 15])
-                    + (rxBits[16] * m_H[20*is + 16])
-                    + (rxBits[17] * m_H[20*is + 17])
-                    + (rxBits[18] * m_H[20*is + 18])
-                    + (rxBits[19] * m_H[20*is + 19])) % 2) << (11-is);
+bool Golay_20_8::correct(uint32_t& codeword)
+{
+    DSD_STATS_FEC_SCOPE();
+    return correctSyndrome(codeword, syndrome(codeword, m_Hwords, 12));
+}
+
+bool Golay_20_8::decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap)
+{
+    DSD_STATS_FEC_SCOPE();
+    return DSDcc::decodeBatch(codewords, data, nbCodewords, errorMap, m_Hwords, 12,
+            [this](uint32_t& codeword, unsigned int syndromeI) { return correctSyndrome(codeword, syndromeI); });
+}
+
+bool Golay_20_8::correctSyndrome(uint32_t& codeword, unsigned int syndromeI)
+{
+    if (syndromeI == 0) {
+        return true;
     }
 
-    if (syndromeI > 0)
-    {
-        int i = 0;
+    uint32_t mask = 0;
 
-        for (; i < 3; i++)
-        {
-            if (m_corr[syndromeI][i] == 0xFF)
-            {
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI][i]] ^= 1; // flip bit
-            }
-        }
+    for (int i = 0; (i < 3) && (m_corr[syndromeI][i] != 0xFF); i++) {
+        mask |= 1U << (19 - m_corr[syndromeI][i]);
+    }
 
-        if (i == 0)
-        {
-            return false;
-        }
+    if (mask == 0) { // uncorrectable error
+        return false;
     }
 
+    codeword ^= mask; // flip bits
+
     return true;
 }
 
+bool Golay_20_8::decode(uint32_t codeword, uint16_t& data)
+{
+    bool correctable = correct(codeword);
+    data = codeword >> 12;
+    return correctable;
+}
+
 // ========================================================================================
 
 Golay_23_12::Golay_23_12()
@@ -789,6 +1020,14 @@ Golay_23_12::~Golay_23_12()
 
 void Golay_23_12::init()
 {
+    static std::once_flag tablesBuilt;
+    std::call_once(tablesBuilt, buildTables);
+}
+
+void Golay_23_12::buildTables()
+{
+    packRows(m_H, 23, 11, m_Hwords);
+
     memset (m_corr, 0xFF, 3*2048);
 
     for (int i1 = 0; i1 < 12; i1++)
@@ -898,60 +1137,54 @@ void Golay_23_12::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Golay_23_12::decode(unsigned char *rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = packBits(rxBits, 23);
+    uint32_t corrected = codeword;
+    bool correctable = correct(corrected);
+    flipBits(rxBits, 23, codeword ^ corrected);
+    return correctable;
+}
 
-    for (int is = 0; is < 11; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[23*is + 0])
-                    + (rxBits[1] * m_H[23*is + 1])
-                    + (rxBits[2] * m_H[23*is + 2])
-                    + (rxBits[3] * m_H[23*is + 3])
-                    + (rxBits[4] * m_H[23*is + 4])
-                    + (rxBits[5] * m_H[23*is + 5])
-                    + (rxBits[6] * m_H[23*is + 6])
-                    + (rxBits[7] * m_H[23*is + 7])
-                    + (rxBits[8] * m_H[23*is + 8])
-                    + (rxBits[9] * m_H[23*is + 9])
-                    + (rxBits[10] * m_H[23*is + 10])
-                    + (rxBits[11] * m_H[23*is + 11])
-                    + (rxBits[12] * m_H[23*is + 12])
-                    + (rxBits[13] * m_H[23*is + 13])
-                    + (rxBits[14] * m_H[23*is + 14])
-                    + (rxBits[15] * m_H[23*is + 15])
-                    + (rxBits[16] * m_H[23*is + 16])
-                    + (rxBits[17] * m_H[23*is + 17])
-                    + (rxBits[18] * m_H[23*is + 18])
-                    + (rxBits[19] * m_H[23*is + 19])
-                    + (rxBits[20] * m_H[23*is + 20])
-                    + (rxBits[21] * m_H[23*is + 21])
-                    + (rxBits[22] * m_H[23*is + 22])) % 2) << (10-is);
+bool Golay_23_12::correct(uint32_t& codeword)
+{
+    DSD_STATS_FEC_SCOPE();
+    return correctSyndrome(codeword, syndrome(codeword, m_Hwords, 11));
+}
+
+bool Golay_23_12::decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap)
+{
+    DSD_STATS_FEC_SCOPE();
+    return DSDcc::decodeBatch(codewords, data, nbCodewords, errorMap, m_Hwords, 11,
+            [this](uint32_t& codeword, unsigned int syndromeI) { return correctSyndrome(codeword, syndromeI); });
+}
+
+bool Golay_23_12::correctSyndrome(uint32_t& codeword, unsigned int syndromeI)
+{
+    if (syndromeI == 0) {
+        return true;
     }
 
-    if (syndromeI > 0)
-    {
-        int i = 0;
+    uint32_t mask = 0;
 
-        for (; i < 3; i++)
-        {
-            if (m_corr[syndromeI][i] == 0xFF)
-            {
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI][i]] ^= 1; // flip bit
-            }
-        }
+    for (int i = 0; (i < 3) && (m_corr[syndromeI][i] != 0xFF); i++) {
+        mask |= 1U << (22 - m_corr[syndromeI][i]);
+    }
 
-        if (i == 0)
-        {
-            return false;
-        }
+    if (mask == 0) { // uncorrectable error
+        return false;
     }
 
+    codeword ^= mask; // flip bits
+
     return true;
 }
 
+bool Golay_23_12::decode(uint32_t codeword, uint16_t& data)
+{
+    bool correctable = correct(codeword);
+    data = codeword >> 11;
+    return correctable;
+}
+
 // ========================================================================================
 
 Golay_24_12::Golay_24_12()
@@ -965,6 +1198,14 @@ Golay_24_12::~Golay_24_12()
 
 void Golay_24_12::init()
 {
+    static std::once_flag tablesBuilt;
+    std::call_once(tablesBuilt, buildTables);
+}
+
+void Golay_24_12::buildTables()
+{
+    packRows(m_H, 24, 12, m_Hwords);
+
     memset (m_corr, 0xFF, 3*4096);
 
     for (int i1 = 0; i1 < 12; i1++)
@@ -1077,61 +1318,54 @@ void Golay_24_12::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool Golay_24_12::decode(unsigned char *rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = packBits(rxBits, 24);
+    uint32_t corrected = codeword;
+    bool correctable = correct(corrected);
+    flipBits(rxBits, 24, codeword ^ corrected);
+    return correctable;
+}
 
-    for (int is = 0; is < 12; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[24*is + 0])
-                    + (rxBits[1] * m_H[24*is + 1])
-                    + (rxBits[2] * m_H[24*is + 2])
-                    + (rxBits[3] * m_H[24*is + 3])
-                    + (rxBits[4] * m_H[24*is + 4])
-                    + (rxBits[5] * m_H[24*is + 5])
-                    + (rxBits[6] * m_H[24*is + 6])
-                    + (rxBits[7] * m_H[24*is + 7])
-                    + (rxBits[8] * m_H[24*is + 8])
-                    + (rxBits[9] * m_H[24*is + 9])
-                    + (rxBits[10] * m_H[24*is + 10])
-                    + (rxBits[11] * m_H[24*is + 11])
-                    + (rxBits[12] * m_H[24*is + 12])
-                    + (rxBits[13] * m_H[24*is + 13])
-                    + (rxBits[14] * m_H[24*is + 14])
-                    + (rxBits[15] * m_H[24*is + 15])
-                    + (rxBits[16] * m_H[24*is + 16])
-                    + (rxBits[17] * m_H[24*is + 17])
-                    + (rxBits[18] * m_H[24*is + 18])
-                    + (rxBits[19] * m_H[24*is + 19])
-                    + (rxBits[20] * m_H[24*is + 20])
-                    + (rxBits[21] * m_H[24*is + 21])
-                    + (rxBits[22] * m_H[24*is + 22])
-                    + (rxBits[23] * m_H[24*is + 23])) % 2) << (11-is);
+bool Golay_24_12::correct(uint32_t& codeword)
+{
+    DSD_STATS_FEC_SCOPE();
+    return correctSyndrome(codeword, syndrome(codeword, m_Hwords, 12));
+}
+
+bool Golay_24_12::decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap)
+{
+    DSD_STATS_FEC_SCOPE();
+    return DSDcc::decodeBatch(codewords, data, nbCodewords, errorMap, m_Hwords, 12,
+            [this](uint32_t& codeword, unsigned int syndromeI) { return correctSyndrome(codeword, syndromeI); });
+}
+
+bool Golay_24_12::correctSyndrome(uint32_t& codeword, unsigned int syndromeI)
+{
+    if (syndromeI == 0) {
+        return true;
     }
 
-    if (syndromeI > 0)
-    {
-        int i = 0;
+    uint32_t mask = 0;
 
-        for (; i < 3; i++)
-        {
-            if (m_corr[syndromeI][i] == 0xFF)
-            {
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI][i]] ^= 1; // flip bit
-            }
-        }
+    for (int i = 0; (i < 3) && (m_corr[syndromeI][i] != 0xFF); i++) {
+        mask |= 1U << (23 - m_corr[syndromeI][i]);
+    }
 
-        if (i == 0)
-        {
-            return false;
-        }
+    if (mask == 0) { // uncorrectable error
+        return false;
     }
 
+    codeword ^= mask; // flip bits
+
     return true;
 }
 
+bool Golay_24_12::decode(uint32_t codeword, uint16_t& data)
+{
+    bool correctable = correct(codeword);
+    data = codeword >> 12;
+    return correctable;
+}
+
 // ========================================================================================
 
 QR_16_7_6::QR_16_7_6()
@@ -1145,6 +1379,14 @@ QR_16_7_6::~QR_16_7_6()
 
 void QR_16_7_6::init()
 {
+    static std::once_flag tablesBuilt;
+    std::call_once(tablesBuilt, buildTables);
+}
+
+void QR_16_7_6::buildTables()
+{
+    packRows(m_H, 16, 9, m_Hwords);
+
     memset (m_corr, 0xFF, 2*512);
 
     for (int i1 = 0; i1 < 7; i1++)
@@ -1216,51 +1458,52 @@ void QR_16_7_6::encode(unsigned char *origBits, unsigned char *encodedBits)
 
 bool QR_16_7_6::decode(unsigned char *rxBits)
 {
-    unsigned int syndromeI = 0; // syndrome index
+    uint32_t codeword = packBits(rxBits, 16);
+    uint32_t corrected = codeword;
+    bool correctable = correct(corrected);
+    flipBits(rxBits, 16, codeword ^ corrected);
+    return correctable;
+}
+
+bool QR_16_7_6::correct(uint32_t& codeword)
+{
+    DSD_STATS_FEC_SCOPE();
+    return correctSyndrome(codeword, syndrome(codeword, m_Hwords, 9));
+}
 
-    for (int is = 0; is < 9; is++)
-    {
-        syndromeI += (((rxBits[0] * m_H[16*is + 0])
-                    + (rxBits[1] * m_H[16*is + 1])
-                    + (rxBits[2] * m_H[16*is + 2])
-                    + (rxBits[3] * m_H[16*is + 3])
-                    + (rxBits[4] * m_H[16*is + 4])
-                    + (rxBits[5] * m_H[16*is + 5])
-                    + (rxBits[6] * m_H[16*is + 6])
-                    + (rxBits[7] * m_H[16*is + 7])
-                    + (rxBits[8] * m_H[16*is + 8])
-                    + (rxBits[9] * m_H[16*is + 9])
-                    + (rxBits[10] * m_H[16*is + 10])
-                    + (rxBits[11] * m_H[16*is + 11])
-                    + (rxBits[12] * m_H[16*is + 12])
-                    + (rxBits[13] * m_H[16*is + 13])
-                    + (rxBits[14] * m_H[16*is + 14])
-                    + (rxBits[15] * m_H[16*is + 15])) % 2) << (8-is);
+bool QR_16_7_6::decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap)
+{
+    DSD_STATS_FEC_SCOPE();
+    return DSDcc::decodeBatch(codewords, data, nbCodewords, errorMap, m_Hwords, 9,
+            [this](uint32_t& codeword, unsigned int syndromeI) { return correctSyndrome(codeword, syndromeI); });
+}
+
+bool QR_16_7_6::correctSyndrome(uint32_t& codeword, unsigned int syndromeI)
+{
+    if (syndromeI == 0) {
+        return true;
     }
 
-    if (syndromeI > 0)
-    {
-        int i = 0;
+    uint32_t mask = 0;
 
-        for (; i < 2; i++)
-        {
-            if (m_corr[syndromeI][i] == 0xFF)
-            {
-                break;
-            }
-            else
-            {
-                rxBits[m_corr[syndromeI][i]] ^= 1; // flip bit
-            }
-        }
+    for (int i = 0; (i < 2) && (m_corr[syndromeI][i] != 0xFF); i++) {
+        mask |= 1U << (15 - m_corr[syndromeI][i]);
+    }
 
-        if (i == 0)
-        {
-            return false;
-        }
+    if (mask == 0) { // uncorrectable error
+        return false;
     }
 
+    codeword ^= mask; // flip bits
+
     return true;
 }
 
+bool QR_16_7_6::decode(uint32_t codeword, uint16_t& data)
+{
+    bool correctable = correct(codeword);
+    data = codeword >> 9;
+    return correctable;
+}
+
 } // namespace DSDcc
@@ -17,6 +17,7 @@
 #ifndef FEC_H_
 #define FEC_H_
 
+#include <stdint.h>
 #include "export.h"
 
 namespace DSDcc
@@ -28,14 +29,22 @@ public:
 	Hamming_7_4();
 	~Hamming_7_4();
 
-	void init();
+	static void init(); //!< builds the tables shared by all instances on first call
 	void encode(unsigned char *origBits, unsigned char *encodedBits);
 	bool decode(unsigned char *rxBits);
+	bool decode(uint32_t codeword, uint16_t& data); //!< packed codeword with its first bit as MSB to information bits
+	bool correct(uint32_t& codeword);               //!< corrects a packed codeword in place
+	bool decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap = 0); //!< codewords corrected in place, data may be null. errorMap has one bit per codeword set if uncorrectable
 
 private:
-	unsigned char m_corr[8];             //!< single bit error correction by syndrome index
+	static void buildTables();
+
+	static unsigned char m_corr[8];      //!< single bit error correction by syndrome index
     static const unsigned char m_G[7*4]; //!< Generator matrix of bits
 	static const unsigned char m_H[7*3]; //!< Parity check matrix of bits
+	static uint32_t m_Hwords[3];         //!< Parity check matrix rows as packed words
+
+	bool correctSyndrome(uint32_t& codeword, unsigned int syndromeI);
 };
 
 class DSDCC_API Hamming_12_8
@@ -44,14 +53,22 @@ public:
     Hamming_12_8();
     ~Hamming_12_8();
 
-    void init();
+    static void init(); //!< builds the tables shared by all instances on first call
 	void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords);
+    bool decode(uint32_t codeword, uint16_t& data); //!< packed codeword with its first bit as MSB to information bits
+    bool correct(uint32_t& codeword);               //!< corrects a packed codeword in place
+    bool decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap = 0); //!< codewords corrected in place, data may be null. errorMap has one bit per codeword set if uncorrectable
 
 private:
-    unsigned char m_corr[16];             //!< single bit error correction by syndrome index
+    static void buildTables();
+
+    static unsigned char m_corr[16];      //!< single bit error correction by syndrome index
     static const unsigned char m_G[12*8]; //!< Generator matrix of bits
     static const unsigned char m_H[12*4]; //!< Parity check matrix of bits
+    static uint32_t m_Hwords[4];          //!< Parity check matrix rows as packed words
+
+    bool correctSyndrome(uint32_t& codeword, unsigned int syndromeI);
 };
 
 class DSDCC_API Hamming_15_11
@@ -60,14 +77,22 @@ public:
     Hamming_15_11();
     ~Hamming_15_11();
 
-    void init();
+    static void init(); //!< builds the tables shared by all instances on first call
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords);
+    bool decode(uint32_t codeword, uint16_t& data); //!< packed codeword with its first bit as MSB to information bits
+    bool correct(uint32_t& codeword);               //!< corrects a packed codeword in place
+    bool decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap = 0); //!< codewords corrected in place, data may be null. errorMap has one bit per codeword set if uncorrectable
 
 private:
-    unsigned char m_corr[16];              //!< single bit error correction by syndrome index
+    static void buildTables();
+
+    static unsigned char m_corr[16];       //!< single bit error correction by syndrome index
     static const unsigned char m_G[15*11]; //!< Generator matrix of bits
     static const unsigned char m_H[15*4];  //!< Parity check matrix of bits
+    static uint32_t m_Hwords[4];           //!< Parity check matrix rows as packed words
+
+    bool correctSyndrome(uint32_t& codeword, unsigned int syndromeI);
 };
 
 class DSDCC_API Hamming_16_11_4
@@ -76,14 +101,22 @@ public:
     Hamming_16_11_4();
     ~Hamming_16_11_4();
 
-    void init();
+    static void init(); //!< builds the tables shared by all instances on first call
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits, unsigned char *decodedBits, int nbCodewords);
+    bool decode(uint32_t codeword, uint16_t& data); //!< packed codeword with its first bit as MSB to information bits
+    bool correct(uint32_t& codeword);               //!< corrects a packed codeword in place
+    bool decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap = 0); //!< codewords corrected in place, data may be null. errorMap has one bit per codeword set if uncorrectable
 
 private:
-    unsigned char m_corr[32];              //!< single bit error correction by syndrome index
+    static void buildTables();
+
+    static unsigned char m_corr[32];       //!< single bit error correction by syndrome index
     static const unsigned char m_G[16*11]; //!< Generator matrix of bits
     static const unsigned char m_H[16*5];  //!< Parity check matrix of bits
+    static uint32_t m_Hwords[5];           //!< Parity check matrix rows as packed words
+
+    bool correctSyndrome(uint32_t& codeword, unsigned int syndromeI);
 };
 
 class DSDCC_API Golay_20_8
@@ -92,14 +125,22 @@ public:
 	Golay_20_8();
 	~Golay_20_8();
 
-	void init();
+	static void init(); //!< builds the tables shared by all instances on first call
 	void encode(unsigned char *origBits, unsigned char *encodedBits);
 	bool decode(unsigned char *rxBits);
+	bool decode(uint32_t codeword, uint16_t& data); //!< packed codeword with its first bit as MSB to information bits
+	bool correct(uint32_t& codeword);               //!< corrects a packed codeword in place
+	bool decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap = 0); //!< codewords corrected in place, data may be null. errorMap has one bit per codeword set if uncorrectable
 
 private:
-	unsigned char m_corr[4096][3];         //!< up to 3 bit error correction by syndrome index
+	static void buildTables();
+
+	static unsigned char m_corr[4096][3];  //!< up to 3 bit error correction by syndrome index
     static const unsigned char m_G[20*8];  //!< Generator matrix of bits
     static const unsigned char m_H[20*12]; //!< Parity check matrix of bits
+    static uint32_t m_Hwords[12];          //!< Parity check matrix rows as packed words
+
+    bool correctSyndrome(uint32_t& codeword, unsigned int syndromeI);
 };
 
 class DSDCC_API Golay_23_12
@@ -108,14 +149,22 @@ public:
     Golay_23_12();
     ~Golay_23_12();
 
-    void init();
+    static void init(); //!< builds the tables shared by all instances on first call
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits);
+    bool decode(uint32_t codeword, uint16_t& data); //!< packed codeword with its first bit as MSB to information bits
+    bool correct(uint32_t& codeword);               //!< corrects a packed codeword in place
+    bool decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap = 0); //!< codewords corrected in place, data may be null. errorMap has one bit per codeword set if uncorrectable
 
 private:
-    unsigned char m_corr[2048][3];         //!< up to 3 bit error correction by syndrome index
+    static void buildTables();
+
+    static unsigned char m_corr[2048][3];  //!< up to 3 bit error correction by syndrome index
     static const unsigned char m_G[23*12]; //!< Generator matrix of bits
     static const unsigned char m_H[23*11]; //!< Parity check matrix of bits
+    static uint32_t m_Hwords[11];          //!< Parity check matrix rows as packed words
+
+    bool correctSyndrome(uint32_t& codeword, unsigned int syndromeI);
 };
 
 class DSDCC_API Golay_24_12
@@ -124,14 +173,22 @@ public:
     Golay_24_12();
     ~Golay_24_12();
 
-    void init();
+    static void init(); //!< builds the tables shared by all instances on first call
     void encode(unsigned char *origBits, unsigned char *encodedBits);
     bool decode(unsigned char *rxBits);
+    bool decode(uint32_t codeword, uint16_t& data); //!< packed codeword with its first bit as MSB to information bits
+    bool correct(uint32_t& codeword);               //!< corrects a packed codeword in place
+    bool decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap = 0); //!< codewords corrected in place, data may be null. errorMap has one bit per codeword set if uncorrectable
 
 private:
-    unsigned char m_corr[4096][3];         //!< up to 3 bit error correction by syndrome index
+    static void buildTables();
+
+    static unsigned char m_corr[4096][3];  //!< up to 3 bit error correction by syndrome index
     static const unsigned char m_G[24*12]; //!< Generator matrix of bits
     static const unsigned char m_H[24*12]; //!< Parity check matrix of bits
+    static uint32_t m_Hwords[12];          //!< Parity check matrix rows as packed words
+
+    bool correctSyndrome(uint32_t& codeword, unsigned int syndromeI);
 };
 
 class DSDCC_API QR_16_7_6
@@ -140,14 +197,22 @@ public:
 	QR_16_7_6();
 	~QR_16_7_6();
 
-	void init();
+	static void init(); //!< builds the tables shared by all instances on first call
 	void encode(unsigned char *origBits, unsigned char *encodedBits);
 	bool decode(unsigned char *rxBits);
+	bool decode(uint32_t codeword, uint16_t& data); //!< packed codeword with its first bit as MSB to information bits
+	bool correct(uint32_t& codeword);               //!< corrects a packed codeword in place
+	bool decodeBatch(uint32_t *codewords, uint16_t *data, int nbCodewords, uint32_t *errorMap = 0); //!< codewords corrected in place, data may be null. errorMap has one bit per codeword set if uncorrectable
 
 private:
-	unsigned char m_corr[512][2];          //!< up to 2 bit error correction by syndrome index
+	static void buildTables();
+
+	static unsigned char m_corr[512][2];   //!< up to 2 bit error correction by syndrome index
     static const unsigned char m_G[16*7];  //!< Generator matrix of bits
 	static const unsigned char m_H[16*9];  //!< Parity check matrix of bits
+	static uint32_t m_Hwords[9];           //!< Parity check matrix rows as packed words
+
+	bool correctSyndrome(uint32_t& codeword, unsigned int syndromeI);
 };
 
 } // namespace DSDcc
@@ -37,6 +37,7 @@ public:
     ~IIRFilter();
     void setCoeffs(const Type *a, const Type *b);
     Type run(const Type& sample);
+    void run(const Type *in, Type *out, uint32_t nbSamples); //!< filter a block of samples. in and out may be the same
 
 private:
     Type *m_a;
@@ -52,6 +53,7 @@ public:
     ~IIRFilter();
     void setCoeffs(const Type *a, const Type *b);
     Type run(const Type& sample);
+    void run(const Type *in, Type *out, uint32_t nbSamples); //!< filter a block of samples with the state kept in registers. in and out may be the same
 
 private:
     Type m_a[3];
@@ -119,6 +121,14 @@ Type IIRFilter<Type, Order>::run(const Type& sample)
     return y;
 }
 
+template <typename Type, uint32_t Order>
+void IIRFilter<Type, Order>::run(const Type *in, Type *out, uint32_t nbSamples)
+{
+    for (uint32_t i = 0; i < nbSamples; i++) {
+        out[i] = run(in[i]);
+    }
+}
+
 
 template <typename Type>
 IIRFilter<Type, 2>::IIRFilter(const Type *a, const Type *b)
@@ -160,6 +170,29 @@ Type IIRFilter<Type, 2>::run(const Type& sample)
     return y;
 }
 
+template <typename Type>
+void IIRFilter<Type, 2>::run(const Type *in, Type *out, uint32_t nbSamples)
+{
+    Type x0 = m_x[0], x1 = m_x[1];
+    Type y0 = m_y[0], y1 = m_y[1];
+
+    for (uint32_t i = 0; i < nbSamples; i++)
+    {
+        Type sample = in[i];
+        Type y = m_b[0]*sample + m_b[1]*x0 + m_b[2]*x1 + m_a[1]*y0 + m_a[2]*y1;
+        x1 = x0;
+        x0 = sample;
+        y1 = y0;
+        y0 = y;
+        out[i] = y;
+    }
+
+    m_x[0] = x0;
+    m_x[1] = x1;
+    m_y[0] = y0;
+    m_y[1] = y1;
+}
+
 } // namespace DSDcc
 
 #endif /* DSDCC_IIRFILTER_H_ */
@@ -17,6 +17,7 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include "mbefec.h"
+#include "dsd_stats.h"
 
 namespace DSDcc
 {
@@ -99,7 +100,7 @@ const int GolayMBE::golayMatrix[2048] = {
 
 void GolayMBE::mbe_checkGolayBlock(long int *block)
 {
-    static int i, syndrome, eccexpected, eccbits, databits;
+    int i, syndrome, eccexpected, eccbits, databits;
     long int mask, block_l;
 
     block_l = *block;
@@ -127,6 +128,7 @@ void GolayMBE::mbe_checkGolayBlock(long int *block)
 
 int GolayMBE::mbe_golay2312(unsigned char *in, unsigned char *out)
 {
+    DSD_STATS_FEC_SCOPE();
 
     int i, errs;
     long block;
@@ -179,6 +181,7 @@ const int HammingMBE::hammingMatrix[16] = {
 
 int HammingMBE::mbe_hamming1511(unsigned char *in, unsigned char *out)
 {
+    DSD_STATS_FEC_SCOPE();
     int i, j, errs, block, syndrome, stmp, stmp2;
 
     errs = 0;
@@ -225,6 +228,7 @@ int HammingMBE::mbe_hamming1511(unsigned char *in, unsigned char *out)
 
 int HammingMBE::mbe_7100x4400hamming1511(unsigned char *in, unsigned char *out)
 {
+    DSD_STATS_FEC_SCOPE();
     int i, j, errs, block, syndrome, stmp, stmp2;
 
     errs = 0;
@@ -24,47 +24,6 @@
 namespace DSDcc
 {
 
-/*
- * DMR AMBE interleave schedule
- */
-// bit 1
-const int DSDNXDN::rW[36] = {
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 2,
-  0, 2, 0, 2, 0, 2,
-  0, 2, 0, 2, 0, 2
-};
-
-const int DSDNXDN::rX[36] = {
-  23, 10, 22, 9, 21, 8,
-  20, 7, 19, 6, 18, 5,
-  17, 4, 16, 3, 15, 2,
-  14, 1, 13, 0, 12, 10,
-  11, 9, 10, 8, 9, 7,
-  8, 6, 7, 5, 6, 4
-};
-
-// bit 0
-const int DSDNXDN::rY[36] = {
-  0, 2, 0, 2, 0, 2,
-  0, 2, 0, 3, 0, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3
-};
-
-const int DSDNXDN::rZ[36] = {
-  5, 3, 4, 2, 3, 1,
-  2, 0, 1, 13, 0, 12,
-  22, 11, 21, 10, 20, 9,
-  19, 8, 18, 7, 17, 6,
-  16, 5, 15, 4, 14, 3,
-  13, 2, 12, 1, 11, 0
-};
-
 const char * DSDNXDN::nxdnRFChannelTypeText[5] = {
         "RC", //!< RCCH
         "RT", //!< RTCH
@@ -252,10 +211,7 @@ DSDNXDN::DSDNXDN(DSDDecoder *dsdDecoder) :
 		m_lichEvenParity(0),
 		m_symbolIndex(0),
 		m_swallowCount(0),
-        w(0),
-        x(0),
-        y(0),
-        z(0)
+        m_ambeDeinterleaver(Deinterleaver::AMBE3600x2450, 72, 96)
 {
     memset(m_syncBuffer, 0, 10);
     memset(m_lichBuffer, 0, 8);
@@ -272,6 +228,9 @@ DSDNXDN::DSDNXDN(DSDDecoder *dsdDecoder) :
     m_locationId = 0;
     m_services = 0;
     m_fullRate = false;
+    m_softDibit.m_bit1 = 0;
+    m_softDibit.m_bit0 = 0;
+    m_softInput = 0;
 
     m_rfChannelStr[0] = '\0';
 }
@@ -328,6 +287,21 @@ void DSDNXDN::processFrame()
     int dibitRaw = m_dsdDecoder->m_dsdSymbol.getDibit();
     int dibit = unscrambleDibit(dibitRaw);
 
+    if (m_dsdDecoder->m_opts.soft_nxdn)
+    {
+        m_softDibit = m_dsdDecoder->m_dsdSymbol.getSoftDibit();
+
+        if (m_pn.getBit(m_symbolIndex)) { // same PN scrambling as the hard dibit
+            m_softDibit.m_bit1 = 255 - m_softDibit.m_bit1;
+        }
+
+        m_softInput = &m_softDibit;
+    }
+    else
+    {
+        m_softInput = 0;
+    }
+
     // if (m_symbolIndex == 0) {
     //     std::cerr << "DSDNXDN::processFrame: start" << std::endl;
     // }
@@ -602,14 +576,14 @@ void DSDNXDN::processRCCH(int index, unsigned char dibit)
         }
 
         if (index < 150) {
-            m_cac.pushDibit(dibit);
+            m_cac.pushDibit(dibit, m_softInput);
         }
 
         if (index == 150)
         {
             m_cac.unpuncture();
 
-            if (m_cac.decode())
+            if (m_cac.decode(m_conv))
             {
                 m_ran = m_cac.getRAN();
                 m_currentMessage.setFromCAC(&m_cac.getData()[1]);
@@ -664,14 +638,14 @@ void DSDNXDN::processRCCH(int index, unsigned char dibit)
         }
 
         if (index < 126) {
-            m_cacShort.pushDibit(dibit);
+            m_cacShort.pushDibit(dibit, m_softInput);
         }
 
         if (index == 126)
         {
             m_cacShort.unpuncture();
 
-            if (m_cacShort.decode())
+            if (m_cacShort.decode(m_conv))
             {
                 m_ran = m_cacShort.getRAN();
                 m_currentMessage.setFromCACShort(&m_cacShort.getData()[1]);
@@ -696,14 +670,14 @@ void DSDNXDN::processRCCH(int index, unsigned char dibit)
         }
 
         if (index < 126) {
-            m_cacLong.pushDibit(dibit);
+            m_cacLong.pushDibit(dibit, m_softInput);
         }
 
         if (index == 126)
         {
             m_cacLong.unpuncture();
 
-            if (m_cacLong.decode())
+            if (m_cacLong.decode(m_conv))
             {
                 m_ran = m_cacLong.getRAN();
                 m_currentMessage.setFromCACLong(&m_cacLong.getData()[1]);
@@ -735,14 +709,14 @@ void DSDNXDN::processRTDCH(int index, unsigned char dibit)
         }
 
         if (index < 30) {
-            m_sacch.pushDibit(dibit);
+            m_sacch.pushDibit(dibit, m_softInput);
         }
 
         if (index == 30)
         {
             m_sacch.unpuncture();
 
-            if (m_sacch.decode())
+            if (m_sacch.decode(m_conv))
             {
                 m_ran = m_sacch.getRAN();
 
@@ -818,14 +792,14 @@ void DSDNXDN::processRTDCH(int index, unsigned char dibit)
         }
 
         if (index < 174) {
-            m_udch.pushDibit(dibit);
+            m_udch.pushDibit(dibit, m_softInput);
         }
 
         if (index == 174)
         {
             m_udch.unpuncture();
 
-            if (m_udch.decode())
+            if (m_udch.decode(m_conv))
             {
                 m_ran = m_udch.getRAN();
                 m_currentMessage.setFromFACCH2(&m_udch.getData()[1]);
@@ -857,14 +831,14 @@ void DSDNXDN::processFACCH1(int index, unsigned char dibit)
     }
 
     if (index < 72) {
-        m_facch1.pushDibit(dibit);
+        m_facch1.pushDibit(dibit, m_softInput);
     }
 
     if (index == 72-1)
     {
         m_facch1.unpuncture();
 
-        if (m_facch1.decode())
+        if (m_facch1.decode(m_conv))
         {
             m_currentMessage.setFromFACCH1(m_facch1.getData());
             m_messageType = m_currentMessage.getMessageType();
@@ -904,10 +878,23 @@ void DSDNXDN::FnChannel::reset()
     m_index = 0;
 }
 
-void DSDNXDN::FnChannel::pushDibit(unsigned char dibit)
+void DSDNXDN::FnChannel::pushDibit(unsigned char dibit, const DSDSoftDibit *softDibit)
+{
+    if (softDibit)
+    {
+        m_bufRaw[m_interleave[m_index++]] = softLevel(softDibit->m_bit1);
+        m_bufRaw[m_interleave[m_index++]] = softLevel(softDibit->m_bit0);
+    }
+    else
+    {
+        m_bufRaw[m_interleave[m_index++]] = dibit&2;       // 0->0, 1->2
+        m_bufRaw[m_interleave[m_index++]] = (dibit&1)<<1;
+    }
+}
+
+unsigned char DSDNXDN::FnChannel::softLevel(unsigned char softBit)
 {
-    m_bufRaw[m_interleave[m_index++]] = (dibit&2)>>1;
-    m_bufRaw[m_interleave[m_index++]] = dibit&1;
+    return softBit < 64 ? 0 : softBit > 191 ? 2 : 1; // bits close to the threshold are erased
 }
 
 void DSDNXDN::FnChannel::unpuncture()
@@ -926,7 +913,7 @@ void DSDNXDN::FnChannel::unpuncture()
             punctureIndex++;
         }
 
-        m_bufTmp[index++] = m_bufRaw[i]<<1; // 0->0, 1->2
+        m_bufTmp[index++] = m_bufRaw[i];
     }
 
     for (int i=0; i<8; i++) {
@@ -949,9 +936,9 @@ DSDNXDN::SACCH::SACCH()
 DSDNXDN::SACCH::~SACCH()
 {}
 
-bool DSDNXDN::SACCH::decode()
+bool DSDNXDN::SACCH::decode(CNXDNConvolution& conv)
 {
-    CNXDNConvolution conv;
+    DSD_STATS_FEC_SCOPE(); // the whole trellis: a scope per step would cost more than the step itself
     conv.start();
     int n = 0;
 
@@ -1012,9 +999,9 @@ DSDNXDN::CACOutbound::CACOutbound()
 DSDNXDN::CACOutbound::~CACOutbound()
 {}
 
-bool DSDNXDN::CACOutbound::decode()
+bool DSDNXDN::CACOutbound::decode(CNXDNConvolution& conv)
 {
-    CNXDNConvolution conv;
+    DSD_STATS_FEC_SCOPE();
     conv.start();
     int n = 0;
 
@@ -1072,9 +1059,9 @@ DSDNXDN::CACLong::CACLong()
 DSDNXDN::CACLong::~CACLong()
 {}
 
-bool DSDNXDN::CACLong::decode()
+bool DSDNXDN::CACLong::decode(CNXDNConvolution& conv)
 {
-    CNXDNConvolution conv;
+    DSD_STATS_FEC_SCOPE();
     conv.start();
     int n = 0;
 
@@ -1117,9 +1104,9 @@ DSDNXDN::CACShort::CACShort()
 DSDNXDN::CACShort::~CACShort()
 {}
 
-bool DSDNXDN::CACShort::decode()
+bool DSDNXDN::CACShort::decode(CNXDNConvolution& conv)
 {
-    CNXDNConvolution conv;
+    DSD_STATS_FEC_SCOPE();
     conv.start();
     int n = 0;
 
@@ -1163,9 +1150,9 @@ DSDNXDN::FACCH1::FACCH1()
 DSDNXDN::FACCH1::~FACCH1()
 {}
 
-bool DSDNXDN::FACCH1::decode()
+bool DSDNXDN::FACCH1::decode(CNXDNConvolution& conv)
 {
-    CNXDNConvolution conv;
+    DSD_STATS_FEC_SCOPE();
     conv.start();
     int n = 0;
 
@@ -1203,9 +1190,9 @@ DSDNXDN::UDCH::UDCH()
 DSDNXDN::UDCH::~UDCH()
 {}
 
-bool DSDNXDN::UDCH::decode()
+bool DSDNXDN::UDCH::decode(CNXDNConvolution& conv)
 {
-    CNXDNConvolution conv;
+    DSD_STATS_FEC_SCOPE();
     conv.start();
     int n = 0;
 
@@ -1258,24 +1245,16 @@ void DSDNXDN::processVoiceFrameEHR(int symbolIndex, int dibit)
 
     if (symbolIndex % 36 == 0)
     {
-        w = rW;
-        x = rX;
-        y = rY;
-        z = rZ;
         memset((void *) m_dsdDecoder->m_mbeDVFrame1, 0, 9); // initialize DVSI frame
     }
 
-    m_dsdDecoder->ambe_fr[*w][*x] = (1 & (dibit >> 1)); // bit 1
-    m_dsdDecoder->ambe_fr[*y][*z] = (1 & dibit);        // bit 0
-    w++;
-    x++;
-    y++;
-    z++;
+    m_ambeDeinterleaver.pushDibit(symbolIndex % 36, dibit);
 
     storeSymbolDV(symbolIndex % 36, dibit); // store dibit for DVSI hardware decoder
 
     if (symbolIndex % 36 == 35)
     {
+        m_ambeDeinterleaver.getBits((unsigned char *) m_dsdDecoder->ambe_fr);
         m_dsdDecoder->m_mbeDecoder1.processFrame(0, m_dsdDecoder->ambe_fr, 0);
         m_dsdDecoder->m_mbeDVReady1 = true; // Indicate that a DVSI frame is available
 
@@ -20,6 +20,9 @@
 #include "pn.h"
 #include "viterbi5.h"
 #include "nxdnmessage.h"
+#include "nxdnconvolution.h"
+#include "dsd_symbol.h"
+#include "deinterleave.h"
 #include "export.h"
 
 namespace DSDcc
@@ -111,14 +114,15 @@ private:
         FnChannel();
         virtual ~FnChannel();
         void reset();
-        void pushDibit(unsigned char dibit);
+        void pushDibit(unsigned char dibit, const DSDSoftDibit *softDibit = 0); //!< with soft bits a weak bit becomes an erasure
         void unpuncture();
-        virtual bool decode() = 0;
+        virtual bool decode(CNXDNConvolution& conv) = 0; //!< de-convolve with the decoder shared by all channels
     protected:
+        static unsigned char softLevel(unsigned char softBit);
         int m_index;
         int m_nbPuncture;
         int m_rawSize;
-        unsigned char *m_bufRaw;
+        unsigned char *m_bufRaw;            //!< de-interleaved bits as Viterbi input levels: 0, 1 (erasure) or 2
         unsigned char *m_bufTmp;
         const int *m_interleave;
         const int *m_punctureList;
@@ -129,7 +133,7 @@ private:
     public:
         SACCH();
         virtual ~SACCH();
-        virtual bool decode();
+        virtual bool decode(CNXDNConvolution& conv);
         unsigned char getRAN() const;
         unsigned char getCountdown() const;  //!< get SACCH block countdown in a superframe structure
         int getDecodeCount() const { return m_decodeCount; }
@@ -149,7 +153,7 @@ private:
     public:
         CACOutbound();
         virtual ~CACOutbound();
-        virtual bool decode();
+        virtual bool decode(CNXDNConvolution& conv);
         unsigned char getRAN() const;
         bool isHeadOfSuperframe() const;
         bool hasDualMessageFormat() const;
@@ -168,7 +172,7 @@ private:
     public:
         CACLong();
         virtual ~CACLong();
-        virtual bool decode();
+        virtual bool decode(CNXDNConvolution& conv);
         unsigned char getRAN() const;
         const unsigned char *getData() const { return m_data; }
         static const int m_Interleave[252];  //!< Long CAC bits interleaving matrix
@@ -184,7 +188,7 @@ private:
     public:
         CACShort();
         virtual ~CACShort();
-        virtual bool decode();
+        virtual bool decode(CNXDNConvolution& conv);
         unsigned char getRAN() const;
         const unsigned char *getData() const { return m_data; }
     private:
@@ -198,7 +202,7 @@ private:
     public:
         FACCH1();
         virtual ~FACCH1();
-        virtual bool decode();
+        virtual bool decode(CNXDNConvolution& conv);
         const unsigned char *getData() const { return m_data; }
         static const int m_Interleave[144];     //!< FACCH1 bits interleaving matrix
         static const int m_PunctureList[48];    //!< FACCH1 punctured bits indexes
@@ -213,7 +217,7 @@ private:
     public:
         UDCH();
         virtual ~UDCH();
-        virtual bool decode();
+        virtual bool decode(CNXDNConvolution& conv);
         unsigned char getRAN() const;
         unsigned char getStructure() const;     //!< get (super)frame structure information (2 bits)
         const unsigned char *getData() const { return m_data; }
@@ -272,16 +276,15 @@ private:
     SACCH m_sacch;
     FACCH1 m_facch1;
     UDCH m_udch;
+    CNXDNConvolution m_conv;        //!< Viterbi decoder reused by all functional channels
+    DSDSoftDibit m_softDibit;       //!< soft bits of the current unscrambled dibit
+    const DSDSoftDibit *m_softInput; //!< points to m_softDibit when soft decision is used else null
     Message m_currentMessage;
     AdjacentSiteInformation m_adjacentSites[16];
 
     char m_rfChannelStr[2+1];
+    Deinterleaver m_ambeDeinterleaver;
 
-    static const int rW[36];
-    static const int rX[36];
-    static const int rY[36];
-    static const int rZ[36];
-    const int *w, *x, *y, *z;
     static const unsigned char m_voiceTestPattern[36];
 };
 
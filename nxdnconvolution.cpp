@@ -28,6 +28,10 @@
 #include <stdlib.h>
 #include <cmath>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace DSDcc
 {
 
@@ -45,23 +49,16 @@ const uint32_t     CNXDNConvolution::M = 4U;
 const unsigned int CNXDNConvolution::K = 5U;
 
 CNXDNConvolution::CNXDNConvolution() :
-m_metrics1(0),
-m_metrics2(0),
-m_oldMetrics(0),
-m_newMetrics(0),
-m_decisions(0),
-m_dp(0)
+m_oldMetrics(m_metrics1),
+m_newMetrics(m_metrics2),
+m_dp(m_decisions),
+m_simd(true)
 {
-	m_metrics1  = new uint16_t[16U];
-	m_metrics2  = new uint16_t[16U];
-	m_decisions = new uint64_t[300U];
+	start();
 }
 
 CNXDNConvolution::~CNXDNConvolution()
 {
-	delete[] m_metrics1;
-	delete[] m_metrics2;
-	delete[] m_decisions;
 }
 
 void CNXDNConvolution::start()
@@ -76,30 +73,64 @@ void CNXDNConvolution::start()
 
 void CNXDNConvolution::decode(uint8_t s0, uint8_t s1)
 {
-  *m_dp = 0U;
+  assert((m_dp - m_decisions) < (int) MAX_DECISIONS);
+
+#if defined(__SSE2__)
+  if (m_simd)
+  {
+    // the 8 butterflies at once: states i and i+8 feed states 2i and 2i+1.
+    // Metrics never exceed M per step over at most MAX_DECISIONS steps so signed 16 bit compares are safe.
+    const __m128i branch1 = _mm_set_epi16(2, 2, 2, 2, 0, 0, 0, 0);
+    const __m128i branch2 = _mm_set_epi16(0, 2, 2, 0, 0, 2, 2, 0);
+    const __m128i v0 = _mm_set1_epi16(s0);
+    const __m128i v1 = _mm_set1_epi16(s1);
+    __m128i metric = _mm_add_epi16(
+        _mm_or_si128(_mm_subs_epu16(branch1, v0), _mm_subs_epu16(v0, branch1)),
+        _mm_or_si128(_mm_subs_epu16(branch2, v1), _mm_subs_epu16(v1, branch2)));
+    __m128i metricC = _mm_sub_epi16(_mm_set1_epi16(M), metric);
+    __m128i oldLo = _mm_loadu_si128((const __m128i*) &m_oldMetrics[0]);
+    __m128i oldHi = _mm_loadu_si128((const __m128i*) &m_oldMetrics[NUM_OF_STATES_D2]);
+
+    __m128i m00 = _mm_add_epi16(oldLo, metric);
+    __m128i m10 = _mm_add_epi16(oldHi, metricC);
+    __m128i m01 = _mm_add_epi16(oldLo, metricC);
+    __m128i m11 = _mm_add_epi16(oldHi, metric);
+    __m128i keep0 = _mm_cmpgt_epi16(m10, m00); // decision is 0 where m0 < m1
+    __m128i keep1 = _mm_cmpgt_epi16(m11, m01);
+    __m128i new0 = _mm_min_epi16(m00, m10);
+    __m128i new1 = _mm_min_epi16(m01, m11);
+
+    _mm_storeu_si128((__m128i*) &m_newMetrics[0], _mm_unpacklo_epi16(new0, new1));
+    _mm_storeu_si128((__m128i*) &m_newMetrics[NUM_OF_STATES_D2], _mm_unpackhi_epi16(new0, new1));
+    __m128i keep = _mm_packs_epi16(_mm_unpacklo_epi16(keep0, keep1), _mm_unpackhi_epi16(keep0, keep1));
+    *m_dp = (uint16_t) ~_mm_movemask_epi8(keep);
+  }
+  else
+#endif
+  {
+    *m_dp = 0U;
 
-  for (uint8_t i = 0U; i < NUM_OF_STATES_D2; i++) {
-    uint8_t j = i * 2U;
+    for (uint8_t i = 0U; i < NUM_OF_STATES_D2; i++) {
+      uint8_t j = i * 2U;
 
-    uint16_t metric = std::abs(BRANCH_TABLE1[i] - s0) + std::abs(BRANCH_TABLE2[i] - s1);
+      uint16_t metric = std::abs(BRANCH_TABLE1[i] - s0) + std::abs(BRANCH_TABLE2[i] - s1);
 
-    uint16_t m0 = m_oldMetrics[i] + metric;
-    uint16_t m1 = m_oldMetrics[i + NUM_OF_STATES_D2] + (M - metric);
-    uint8_t decision0 = (m0 >= m1) ? 1U : 0U;
-    m_newMetrics[j + 0U] = decision0 != 0U ? m1 : m0;
+      uint16_t m0 = m_oldMetrics[i] + metric;
+      uint16_t m1 = m_oldMetrics[i + NUM_OF_STATES_D2] + (M - metric);
+      uint8_t decision0 = (m0 >= m1) ? 1U : 0U;
+      m_newMetrics[j + 0U] = decision0 != 0U ? m1 : m0;
 
-    m0 = m_oldMetrics[i] + (M - metric);
-    m1 = m_oldMetrics[i + NUM_OF_STATES_D2] + metric;
-    uint8_t decision1 = (m0 >= m1) ? 1U : 0U;
-    m_newMetrics[j + 1U] = decision1 != 0U ? m1 : m0;
+      m0 = m_oldMetrics[i] + (M - metric);
+      m1 = m_oldMetrics[i + NUM_OF_STATES_D2] + metric;
+      uint8_t decision1 = (m0 >= m1) ? 1U : 0U;
+      m_newMetrics[j + 1U] = decision1 != 0U ? m1 : m0;
 
-    *m_dp |= (uint64_t(decision1) << (j + 1U)) | (uint64_t(decision0) << (j + 0U));
+      *m_dp |= (uint16_t(decision1) << (j + 1U)) | (uint16_t(decision0) << (j + 0U));
+    }
   }
 
   ++m_dp;
 
-  assert((m_dp - m_decisions) <= 300);
-
   uint16_t* tmp = m_oldMetrics;
   m_oldMetrics = m_newMetrics;
   m_newMetrics = tmp;
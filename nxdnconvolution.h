@@ -40,13 +40,19 @@ public:
 
 	void encode(const unsigned char* in, unsigned char* out, unsigned int nBits) const;
 
+	/** Use the SSE2 butterflies when compiled in (default) or force the scalar path */
+	void setSIMD(bool simd) { m_simd = simd; }
+
+	static const unsigned int MAX_DECISIONS = 207U; //!< trellis steps of the largest channel (UDCH 203 bits + 4 tail bits)
+
 private:
-	uint16_t* m_metrics1;
-	uint16_t* m_metrics2;
+	uint16_t  m_metrics1[16U];
+	uint16_t  m_metrics2[16U];
 	uint16_t* m_oldMetrics;
 	uint16_t* m_newMetrics;
-	uint64_t* m_decisions;
-	uint64_t* m_dp;
+	uint16_t  m_decisions[MAX_DECISIONS]; //!< one decision bit per state and step
+	uint16_t* m_dp;
+	bool      m_simd;
 	static const uint8_t BIT_MASK_TABLE[];
 	static const uint8_t BRANCH_TABLE1[];
 	static const uint8_t BRANCH_TABLE2[];
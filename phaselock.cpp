@@ -148,134 +148,274 @@ void PhaseLock::configure(float freq, float bandwidth, float minsignal)
 }
 
 
+// Sine and cosine of the phase. Reduction to [-pi/4, pi/4] then Taylor polynomials
+void PhaseLock::sinCos(float phase, float& psin, float& pcos)
+{
+    const float pi2Hi = 1.5707963705062866f;   // pi/2 rounded to float
+    const float pi2Lo = -4.371139000186243e-8f; // pi/2 - pi2Hi
+    int q = (int) floorf(phase * 0.63661977236758134f + 0.5f);
+    float r = (phase - q * pi2Hi) - q * pi2Lo;
+    float r2 = r * r;
+    float s = r * (1.0f + r2 * (-1.6666667163e-1f + r2 * (8.3333337680e-3f + r2 * (-1.9841270114e-4f + r2 * 2.7557314297e-6f))));
+    float c = 1.0f + r2 * (-0.5f + r2 * (4.1666667908e-2f + r2 * (-1.3888889225e-3f + r2 * 2.4801587642e-5f)));
+
+    switch (q & 3)
+    {
+    case 0:
+        psin = s;
+        pcos = c;
+        break;
+    case 1:
+        psin = c;
+        pcos = -s;
+        break;
+    case 2:
+        psin = -s;
+        pcos = -c;
+        break;
+    default:
+        psin = -c;
+        pcos = s;
+        break;
+    }
+}
+
+// Run the loop on one sample with the locked tone in m_psin and m_pcos
+void PhaseLock::loop(float sample_in)
+{
+    // Multiply locked tone with input.
+    float x = sample_in;
+    float phasor_i = m_psin * x;
+    float phasor_q = m_pcos * x;
+
+    // Run IQ phase error through low-pass filter.
+    phasor_i = m_phasor_b0 * phasor_i
+               - m_phasor_a1 * m_phasor_i1
+               - m_phasor_a2 * m_phasor_i2;
+    phasor_q = m_phasor_b0 * phasor_q
+               - m_phasor_a1 * m_phasor_q1
+               - m_phasor_a2 * m_phasor_q2;
+    m_phasor_i2 = m_phasor_i1;
+    m_phasor_i1 = phasor_i;
+    m_phasor_q2 = m_phasor_q1;
+    m_phasor_q1 = phasor_q;
+
+    // Convert I/Q ratio to estimate of phase error.
+    float phase_err;
+    if (phasor_i > std::abs(phasor_q)) {
+        // We are within +/- 45 degrees from lock.
+        // Use simple linear approximation of arctan.
+        phase_err = phasor_q / phasor_i;
+    } else if (phasor_q > 0) {
+        // We are lagging more than 45 degrees behind the input.
+        phase_err = 1;
+    } else {
+        // We are more than 45 degrees ahead of the input.
+        phase_err = -1;
+    }
+
+    // Update lock status.
+    if ((phase_err > -m_minsignal) && (phase_err < m_minsignal))
+    {
+        if (m_lock_cnt < 2*m_lock_delay)
+        {
+            m_lock_cnt += 1;
+        }
+    }
+    else
+    {
+        if (m_lock_cnt > 0)
+        {
+            m_lock_cnt -= 1;
+        }
+    }
+
+    // Run phase error through loop filter and update frequency estimate.
+    m_freq += m_loopfilter_b0 * phase_err
+              + m_loopfilter_b1 * m_loopfilter_x1;
+    m_loopfilter_x1 = phase_err;
+
+    // Limit frequency to allowable range.
+    m_freq = std::max(m_minfreq, std::min(m_maxfreq, m_freq));
+
+    // Update locked phase.
+    m_phase += m_freq;
+    if (m_phase > 2.0 * M_PI)
+    {
+        m_phase -= 2.0 * M_PI;
+    }
+}
+
 // Process samples. Bufferized version
 void PhaseLock::process(const std::vector<float>& samples_in, std::vector<float>& samples_out)
 {
     unsigned int n = samples_in.size();
-
     samples_out.resize(n);
-    float pilot_level = FLT_MAX;
-
-    for (unsigned int i = 0; i < n; i++) {
 
-        // Generate locked pilot tone.
-        float psin = sin(m_phase);
-        float pcos = cos(m_phase);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        sinCos(m_phase, m_psin, m_pcos);
 
         // Generate double-frequency output.
         // sin(2*x) = 2 * sin(x) * cos(x)
-        samples_out[i] = 2 * psin * pcos;
-
-        // Multiply locked tone with input.
-        float x = samples_in[i];
-        float phasor_i = psin * x;
-        float phasor_q = pcos * x;
-
-        // Run IQ phase error through low-pass filter.
-        phasor_i = m_phasor_b0 * phasor_i
-                   - m_phasor_a1 * m_phasor_i1
-                   - m_phasor_a2 * m_phasor_i2;
-        phasor_q = m_phasor_b0 * phasor_q
-                   - m_phasor_a1 * m_phasor_q1
-                   - m_phasor_a2 * m_phasor_q2;
-        m_phasor_i2 = m_phasor_i1;
-        m_phasor_i1 = phasor_i;
-        m_phasor_q2 = m_phasor_q1;
-        m_phasor_q1 = phasor_q;
-
-        // Convert I/Q ratio to estimate of phase error.
-        float phase_err;
-        if (phasor_i > std::abs(phasor_q)) {
-            // We are within +/- 45 degrees from lock.
-            // Use simple linear approximation of arctan.
-            phase_err = phasor_q / phasor_i;
-        } else if (phasor_q > 0) {
-            // We are lagging more than 45 degrees behind the input.
-            phase_err = 1;
-        } else {
-            // We are more than 45 degrees ahead of the input.
-            phase_err = -1;
-        }
+        samples_out[i] = 2 * m_psin * m_pcos;
+
+        loop(samples_in[i]);
+    }
+
+    // Update sample counter.
+    m_sample_cnt += n;
+}
 
-        // Detect pilot level (conservative).
-        pilot_level = (std::min)(pilot_level, phasor_i);
+// Process samples. Multiple output
+void PhaseLock::process(const float& sample_in, float *samples_out)
+{
+    // Generate locked pilot tone.
+    sinCos(m_phase, m_psin, m_pcos);
 
-        // Run phase error through loop filter and update frequency estimate.
-        m_freq += m_loopfilter_b0 * phase_err
-                  + m_loopfilter_b1 * m_loopfilter_x1;
-        m_loopfilter_x1 = phase_err;
+    // Generate output
+    processPhase(samples_out);
 
-        // Limit frequency to allowable range.
-        m_freq = std::max(m_minfreq, std::min(m_maxfreq, m_freq));
+    loop(sample_in);
 
-        // Update locked phase.
-        m_phase += m_freq;
-        if (m_phase > 2.0 * M_PI) {
-            m_phase -= 2.0 * M_PI;
-        }
+    // Update sample counter.
+    m_sample_cnt += 1; // n
+}
 
-        // Update lock status.
-        if ((phase_err > -m_minsignal) && (phase_err < m_minsignal))
-        {
-            if (m_lock_cnt < 2*m_lock_delay)
-            {
-                m_lock_cnt += 1;
-            }
+// Process one sample. Sine and cosine output
+void PhaseLock::process(float sample_in, float& psin, float& pcos)
+{
+    sinCos(m_phase, m_psin, m_pcos);
+    psin = m_psin;
+    pcos = m_pcos;
+    loop(sample_in);
+    m_sample_cnt += 1;
+}
+
+// Process samples. Block version
+void PhaseLock::process(const float *samples_in, float *sin_out, float *cos_out, unsigned int nbSamples)
+{
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        sinCos(m_phase, m_psin, m_pcos);
+
+        if (sin_out) {
+            sin_out[i] = m_psin;
         }
-        else
-        {
-            if (m_lock_cnt > 0)
-            {
-                m_lock_cnt -= 1;
-            }
+
+        if (cos_out) {
+            cos_out[i] = m_pcos;
         }
+
+        loop(samples_in[i]);
     }
 
-    // Update sample counter.
-    m_sample_cnt += n;
+    m_sample_cnt += nbSamples;
 }
 
+// ====================================================================
 
-// Process samples. Multiple output
-void PhaseLock::process(const float& sample_in, float *samples_out)
+PhaseLockQ15::SinTable::SinTable()
 {
-	// Generate locked pilot tone.
-	m_psin = sin(m_phase);
-	m_pcos = cos(m_phase);
-
-	// Generate output
-	processPhase(samples_out);
-
-	// Multiply locked tone with input.
-	float x = sample_in;
-	float phasor_i = m_psin * x;
-	float phasor_q = m_pcos * x;
-
-	// Run IQ phase error through low-pass filter.
-	phasor_i = m_phasor_b0 * phasor_i
-			   - m_phasor_a1 * m_phasor_i1
-			   - m_phasor_a2 * m_phasor_i2;
-	phasor_q = m_phasor_b0 * phasor_q
-			   - m_phasor_a1 * m_phasor_q1
-			   - m_phasor_a2 * m_phasor_q2;
-	m_phasor_i2 = m_phasor_i1;
-	m_phasor_i1 = phasor_i;
-	m_phasor_q2 = m_phasor_q1;
-	m_phasor_q1 = phasor_q;
-
-	// Convert I/Q ratio to estimate of phase error.
-	float phase_err;
-    if (phasor_i > std::abs(phasor_q)) {
-		// We are within +/- 45 degrees from lock.
-		// Use simple linear approximation of arctan.
-		phase_err = phasor_q / phasor_i;
-	} else if (phasor_q > 0) {
-		// We are lagging more than 45 degrees behind the input.
-		phase_err = 1;
-	} else {
-		// We are more than 45 degrees ahead of the input.
-		phase_err = -1;
-	}
+    // The phase is truncated to the table index so take the middle of each step. This also keeps the outputs away from zero.
+    for (int i = 0; i < (1<<10); i++) {
+        m_sin[i] = lrint(32767.0 * sin((2.0 * M_PI * (i + 0.5)) / (1<<10)));
+    }
+}
+
+const PhaseLockQ15::SinTable PhaseLockQ15::m_sinTable;
+
+PhaseLockQ15::PhaseLockQ15(float freq, float bandwidth, float minsignal)
+{
+    configure(freq, bandwidth, minsignal);
+}
+
+void PhaseLockQ15::configure(float freq, float bandwidth, float minsignal)
+{
+    // Same loop as PhaseLock with frequencies as phase increments where 2^32 is one turn
+    const double turn = 4294967296.0;
+
+    m_minfreq = lrint((freq - bandwidth) * turn);
+    m_maxfreq = lrint((freq + bandwidth) * turn);
+
+    m_minsignal  = lrint(minsignal * 32768.0);
+    m_lock_delay = int(1.0 / bandwidth);
+    m_lock_cnt   = 0;
+
+    double p1 = exp(-1.146 * bandwidth * 2.0 * M_PI);
+    double p2 = exp(-5.331 * bandwidth * 2.0 * M_PI);
+    double a1 = - p1 - p2;
+    double a2 = p1 * p2;
+    m_phasor_a1 = lrint(a1 * (1<<28));
+    m_phasor_a2 = lrint(a2 * (1<<28));
+    m_phasor_b0 = lrint((1 + a1 + a2) * (1<<28));
+
+    // The loop filter output in radians is converted to a phase increment
+    double q1 = exp(-0.1153 * bandwidth * 2.0 * M_PI);
+    double b0 = 0.62 * bandwidth * 2.0 * M_PI;
+    m_loopfilter_b0 = lrint((b0 * turn) / (2.0 * M_PI));
+    m_loopfilter_b1 = lrint((- b0 * q1 * turn) / (2.0 * M_PI));
+
+    m_freq  = lrint(freq * turn);
+    m_phase = 0;
+
+    m_phasor_i1 = 0;
+    m_phasor_i2 = 0;
+    m_phasor_q1 = 0;
+    m_phasor_q2 = 0;
+    m_loopfilter_x1 = 0;
+}
+
+void PhaseLockQ15::process(int16_t sample_in, int16_t *samples_out)
+{
+    // Generate locked pilot tone.
+    int32_t psin = m_sinTable.m_sin[m_phase >> m_tableShift];
+    int32_t pcos = m_sinTable.m_sin[(m_phase + (1U<<30)) >> m_tableShift];
+    samples_out[0] = psin;
+    samples_out[1] = pcos;
+
+    // Multiply locked tone with input. Q15 x Q15 to Q20.
+    int32_t phasor_i = (psin * sample_in) >> 10;
+    int32_t phasor_q = (pcos * sample_in) >> 10;
+
+    // Run IQ phase error through low-pass filter.
+    phasor_i = (int32_t) (((int64_t) m_phasor_b0 * phasor_i
+            - (int64_t) m_phasor_a1 * m_phasor_i1
+            - (int64_t) m_phasor_a2 * m_phasor_i2 + (1<<27)) >> 28);
+    phasor_q = (int32_t) (((int64_t) m_phasor_b0 * phasor_q
+            - (int64_t) m_phasor_a1 * m_phasor_q1
+            - (int64_t) m_phasor_a2 * m_phasor_q2 + (1<<27)) >> 28);
+    m_phasor_i2 = m_phasor_i1;
+    m_phasor_i1 = phasor_i;
+    m_phasor_q2 = m_phasor_q1;
+    m_phasor_q1 = phasor_q;
+
+    // Convert I/Q ratio to estimate of phase error in Q15.
+    int32_t phase_err;
+
+    if (phasor_i > std::abs(phasor_q))
+    {
+        // We are within +/- 45 degrees from lock.
+        // Use simple linear approximation of arctan. Scale down to keep the division in 32 bits.
+        while (phasor_i > 32767)
+        {
+            phasor_i >>= 1;
+            phasor_q >>= 1;
+        }
+
+        phase_err = (phasor_q * 32768) / phasor_i;
+        phase_err = std::max(-32768, std::min(32768, phase_err));
+    }
+    else if (phasor_q > 0)
+    {
+        // We are lagging more than 45 degrees behind the input.
+        phase_err = 32768;
+    }
+    else
+    {
+        // We are more than 45 degrees ahead of the input.
+        phase_err = -32768;
+    }
 
     // Update lock status.
     if ((phase_err > -m_minsignal) && (phase_err < m_minsignal))
@@ -293,23 +433,16 @@ void PhaseLock::process(const float& sample_in, float *samples_out)
         }
     }
 
-	// Run phase error through loop filter and update frequency estimate.
-	m_freq += m_loopfilter_b0 * phase_err
-			  + m_loopfilter_b1 * m_loopfilter_x1;
-	m_loopfilter_x1 = phase_err;
+    // Run phase error through loop filter and update frequency estimate.
+    m_freq += (int32_t) (((int64_t) m_loopfilter_b0 * phase_err
+            + (int64_t) m_loopfilter_b1 * m_loopfilter_x1) >> 15);
+    m_loopfilter_x1 = phase_err;
 
-	// Limit frequency to allowable range.
-	m_freq = std::max(m_minfreq, std::min(m_maxfreq, m_freq));
+    // Limit frequency to allowable range.
+    m_freq = std::max(m_minfreq, std::min(m_maxfreq, m_freq));
 
-	// Update locked phase.
-	m_phase += m_freq;
-	if (m_phase > 2.0 * M_PI)
-	{
-		m_phase -= 2.0 * M_PI;
-	}
-
-    // Update sample counter.
-    m_sample_cnt += 1; // n
+    // Update locked phase. Wraps around at one turn.
+    m_phase += (uint32_t) m_freq;
 }
 
 } // namespace DSDcc
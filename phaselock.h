@@ -58,6 +58,19 @@ public:
      */
     void process(const float& sample_in, float *samples_out);
 
+    /**
+     * Process one sample and return the sine and cosine of the locked phase like SimplePhaseLock
+     * without going through the processPhase virtual method. Sine and cosine are polynomial
+     * approximations to float precision.
+     */
+    void process(float sample_in, float& psin, float& pcos);
+
+    /**
+     * Process a block of samples. Writes the sine and cosine of the locked phase for each sample
+     * if sin_out and/or cos_out are not null.
+     */
+    void process(const float *samples_in, float *sin_out, float *cos_out, unsigned int nbSamples);
+
     /**
      * Process samples and extract 19 kHz pilot tone.
      * Generate phase-locked 38 kHz tone with unit amplitude.
@@ -82,6 +95,9 @@ protected:
     virtual void processPhase(float *samples_out) const = 0;
 
 private:
+    static void sinCos(float phase, float& psin, float& pcos);
+    void loop(float sample_in);
+
     float    m_minfreq, m_maxfreq;
     float    m_phasor_b0, m_phasor_a1, m_phasor_a2;
     float    m_phasor_i1, m_phasor_i2, m_phasor_q1, m_phasor_q2;
@@ -109,4 +125,49 @@ protected:
     }
 };
 
+/**
+ * Fixed point version of SimplePhaseLock for targets with a weak or no FPU. Input and outputs are Q15 samples.
+ * The phase is a 32 bit accumulator where 2^32 is one turn and sine and cosine are looked up in a table.
+ * Coefficients are computed in floating point only when the loop is configured.
+ */
+class DSDCC_API PhaseLockQ15
+{
+public:
+    PhaseLockQ15(float freq, float bandwidth, float minsignal);
+    ~PhaseLockQ15() {}
+
+    /** Change phase locked loop parameters. Same as PhaseLock::configure */
+    void configure(float freq, float bandwidth, float minsignal);
+
+    /** Process one Q15 sample. Outputs sine and cosine of the locked phase in Q15 like SimplePhaseLock */
+    void process(int16_t sample_in, int16_t *samples_out);
+
+    /** Return true if the phase-locked loop is locked. */
+    bool locked() const
+    {
+        return m_lock_cnt >= m_lock_delay;
+    }
+
+private:
+    struct SinTable
+    {
+        SinTable();
+        int16_t m_sin[1<<10]; //!< one turn of sine in Q15
+    };
+
+    static const SinTable m_sinTable;
+    static const int m_tableShift = 32 - 10; //!< phase to table index
+
+    uint32_t m_phase;
+    int32_t  m_minfreq, m_maxfreq;                              //!< phase increments per sample
+    int32_t  m_phasor_b0, m_phasor_a1, m_phasor_a2;             //!< Q28
+    int32_t  m_phasor_i1, m_phasor_i2, m_phasor_q1, m_phasor_q2; //!< Q20
+    int32_t  m_loopfilter_b0, m_loopfilter_b1;                  //!< phase increment for a phase error of 1
+    int32_t  m_loopfilter_x1;                                   //!< Q15
+    int32_t  m_freq;                                            //!< phase increment per sample
+    int32_t  m_minsignal;                                       //!< Q15
+    int      m_lock_delay;
+    int      m_lock_cnt;
+};
+
 } // namespace DSDCc
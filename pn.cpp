@@ -14,6 +14,9 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <vector>
+#include <mutex>
+
 #include "pn.h"
 
 namespace DSDcc
@@ -30,7 +33,29 @@ PN_9_5::~PN_9_5()
 
 void PN_9_5::init()
 {
-    unsigned char byte;
+    const Tables *tables = getTables();
+    m_byteTable = tables->m_byteTable;
+    m_bitTable = tables->m_bitTable;
+}
+
+const PN_9_5::Tables *PN_9_5::getTables()
+{
+    // sequences are built once per process for each seed and kept until exit
+
+    static std::mutex mutex;
+    static std::vector<Tables*> tablesList;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (std::vector<Tables*>::const_iterator it = tablesList.begin(); it != tablesList.end(); ++it)
+    {
+        if ((*it)->m_seed == m_seed) {
+            return *it;
+        }
+    }
+
+    Tables *tables = new Tables;
+    tables->m_seed = m_seed;
+    unsigned char byte = 0;
     unsigned int sr = m_seed;
 
     for (int i = 0; i < 512; i++)
@@ -45,15 +70,18 @@ void PN_9_5::init()
         sr >>= 1;
         sr |= (bit4 ^ bit0) << 8;
 
-        m_bitTable[i] = bit0;
+        tables->m_bitTable[i] = bit0;
         byte += bit0 << (7 - (i%8));
 
         if (i%8 == 7)
         {
-            m_byteTable[i/8] = byte;
+            tables->m_byteTable[i/8] = byte;
         }
     }
 
+    tablesList.push_back(tables);
+
+    return tables;
 }
 
 } // namespace DSDcc
@@ -44,11 +44,19 @@ public:
     }
 
 private:
+    struct Tables //!< sequence shared by the generators with the same seed
+    {
+        unsigned int m_seed;
+        unsigned char m_byteTable[64];
+        unsigned char m_bitTable[512];
+    };
+
     void init();
+    const Tables *getTables();
 
     unsigned int m_seed;
-    unsigned char m_byteTable[64];
-    unsigned char m_bitTable[512];
+    const unsigned char *m_byteTable;
+    const unsigned char *m_bitTable;
 };
 
 } // namespace DSDcc
@@ -188,6 +188,66 @@ private:
     uint32_t ww;
 };
 
+// K smallest and K largest values pushed since the last reset kept sorted on the fly
+
+template<typename valuetype, uint32_t K>
+class runningextremes
+{
+public:
+    runningextremes() : n(0)
+    {
+    }
+
+    void reset()
+    {
+        n = 0;
+    }
+
+    void update(valuetype value)
+    {
+        uint32_t nk = n < K ? n : K;
+        int i;
+
+        if ((nk < K) || (value < lo[K-1])) // insertion into the ascending smallest values
+        {
+            for (i = (nk < K ? nk : K-1); (i > 0) && (lo[i-1] > value); i--) {
+                lo[i] = lo[i-1];
+            }
+
+            lo[i] = value;
+        }
+
+        if ((nk < K) || (value > hi[K-1])) // insertion into the descending largest values
+        {
+            for (i = (nk < K ? nk : K-1); (i > 0) && (hi[i-1] < value); i--) {
+                hi[i] = hi[i-1];
+            }
+
+            hi[i] = value;
+        }
+
+        n++;
+    }
+
+    uint32_t count() const
+    {
+        return n;
+    }
+    valuetype lowest(uint32_t rank) const //!< rank 0 is the minimum
+    {
+        return lo[rank];
+    }
+    valuetype highest(uint32_t rank) const //!< rank 0 is the maximum
+    {
+        return hi[rank];
+    }
+
+private:
+    valuetype lo[K];
+    valuetype hi[K];
+    uint32_t n;
+};
+
 } // namespce DSDcc
 
 #endif /* RUNNINGMAXMIN_H_ */
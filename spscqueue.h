@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SPSCQUEUE_H_
+#define SPSCQUEUE_H_
+
+#include <atomic>
+#include <string.h>
+#include <assert.h>
+
+namespace DSDcc
+{
+
+/**
+ * Lock free single producer single consumer queue of trivially copyable items.
+ * The capacity is rounded up to a power of two. One thread may write while another reads.
+ */
+template<typename T>
+class SPSCQueue
+{
+public:
+    explicit SPSCQueue(unsigned int capacity) :
+        m_head(0),
+        m_tail(0)
+    {
+        assert(capacity > 0);
+        m_size = 1;
+
+        while (m_size < capacity) {
+            m_size <<= 1;
+        }
+
+        m_mask = m_size - 1;
+        m_buffer = new T[m_size];
+    }
+
+    ~SPSCQueue()
+    {
+        delete[] m_buffer;
+    }
+
+    unsigned int capacity() const { return m_size; }
+
+    /** Reallocates the queue empty with the new capacity rounded up to a power of two.
+     *  Neither the producer nor the consumer may be active. */
+    void resize(unsigned int capacity)
+    {
+        assert(capacity > 0);
+        delete[] m_buffer;
+        m_size = 1;
+
+        while (m_size < capacity) {
+            m_size <<= 1;
+        }
+
+        m_mask = m_size - 1;
+        m_buffer = new T[m_size];
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    /** Number of items that can be read (consumer side) */
+    unsigned int readable() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed);
+    }
+
+    /** Number of items that can be written (producer side) */
+    unsigned int writable() const
+    {
+        return m_size - (m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_acquire));
+    }
+
+    /** Write up to nbItems items. Returns the number of items written */
+    unsigned int write(const T *items, unsigned int nbItems)
+    {
+        unsigned int head = m_head.load(std::memory_order_relaxed);
+        unsigned int n = m_size - (head - m_tail.load(std::memory_order_acquire));
+        n = nbItems < n ? nbItems : n;
+        copyIn(head, items, n);
+        m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    bool push(const T& item)
+    {
+        return write(&item, 1) == 1;
+    }
+
+    /** Read up to nbItems items. Returns the number of items read */
+    unsigned int read(T *items, unsigned int nbItems)
+    {
+        unsigned int tail = m_tail.load(std::memory_order_relaxed);
+        unsigned int n = m_head.load(std::memory_order_acquire) - tail;
+        n = nbItems < n ? nbItems : n;
+        copyOut(tail, items, n);
+        m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    bool pop(T& item)
+    {
+        return read(&item, 1) == 1;
+    }
+
+    /** Zero copy read. Gives the contiguous readable items that can be less than readable() at wrap around */
+    const T *readView(unsigned int& nbItems) const
+    {
+        unsigned int tail = m_tail.load(std::memory_order_relaxed);
+        unsigned int n = m_head.load(std::memory_order_acquire) - tail;
+        unsigned int index = tail & m_mask;
+        nbItems = m_size - index < n ? m_size - index : n;
+        return &m_buffer[index];
+    }
+
+    /** Frees items obtained with readView */
+    void release(unsigned int nbItems)
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + nbItems, std::memory_order_release);
+    }
+
+    /** Zero copy write. Gives the contiguous writable space that can be less than writable() at wrap around */
+    T *writeView(unsigned int& nbItems)
+    {
+        unsigned int head = m_head.load(std::memory_order_relaxed);
+        unsigned int n = m_size - (head - m_tail.load(std::memory_order_acquire));
+        unsigned int index = head & m_mask;
+        nbItems = m_size - index < n ? m_size - index : n;
+        return &m_buffer[index];
+    }
+
+    /** Publishes items written in the space obtained with writeView */
+    void commit(unsigned int nbItems)
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + nbItems, std::memory_order_release);
+    }
+
+private:
+    SPSCQueue(const SPSCQueue&);
+    SPSCQueue& operator=(const SPSCQueue&);
+
+    void copyIn(unsigned int head, const T *items, unsigned int n)
+    {
+        unsigned int index = head & m_mask;
+        unsigned int first = m_size - index < n ? m_size - index : n;
+        memcpy(&m_buffer[index], items, first*sizeof(T));
+        memcpy(m_buffer, &items[first], (n - first)*sizeof(T));
+    }
+
+    void copyOut(unsigned int tail, T *items, unsigned int n)
+    {
+        unsigned int index = tail & m_mask;
+        unsigned int first = m_size - index < n ? m_size - index : n;
+        memcpy(items, &m_buffer[index], first*sizeof(T));
+        memcpy(&items[first], m_buffer, (n - first)*sizeof(T));
+    }
+
+    T *m_buffer;
+    unsigned int m_size;
+    unsigned int m_mask;
+    char m_pad1[64];                       //!< keep producer and consumer indexes on different cache lines
+    std::atomic<unsigned int> m_head;      //!< producer index (free running)
+    char m_pad2[64];
+    std::atomic<unsigned int> m_tail;      //!< consumer index (free running)
+};
+
+} // namespace DSDcc
+
+#endif /* SPSCQUEUE_H_ */
@@ -60,6 +60,78 @@ void testNXDN()
     std::cout << "NXDN CCITT16 for test (2): " << test << std::endl;
 }
 
+// Remainder of the division of the bits followed by order zeros by the polynomial like dPMR does it
+unsigned long divideBits(const unsigned char *bits, int nbBits, unsigned long poly, int order)
+{
+    unsigned char work[256+32];
+    unsigned long crc = 0;
+
+    memcpy(work, bits, nbBits);
+    memset(&work[nbBits], 0, order);
+
+    for (int i = 0; i < nbBits; i++)
+    {
+        if (work[i])
+        {
+            for (int j = 0; j < order; j++) {
+                work[i+1+j] ^= (poly >> (order-1-j)) & 1;
+            }
+        }
+    }
+
+    for (int j = 0; j < order; j++) {
+        crc = (crc << 1) | work[nbBits+j];
+    }
+
+    return crc;
+}
+
+// Slicing-by-8 tables against the bit by bit algorithm and bit arrays against packed bytes
+void testSlicing()
+{
+    struct { unsigned long poly; int order; unsigned long init; unsigned long xorout; int refin; int refout; } configs[] = {
+        {DSDcc::CRC::PolyCCITT16, 16, 0x0, 0xffff, 0, 0},
+        {DSDcc::CRC::PolyCCITT16, 16, 0xffff, 0xffff, 1, 1},
+        {0x09, 7, 0, 0, 0, 0},
+        {0x07, 8, 0, 0, 0, 0},
+        {0x04c11db7, 32, 0xffffffff, 0xffffffff, 1, 1},
+        {0x0805, 12, 0xfff, 0, 0, 0}
+    };
+    unsigned char bytes[32], bits[256];
+    unsigned int seed = 1;
+    int nbKO = 0;
+
+    for (unsigned int c = 0; c < sizeof(configs)/sizeof(configs[0]); c++)
+    {
+        DSDcc::CRC crc(configs[c].poly, configs[c].order, configs[c].init, configs[c].xorout, 1, configs[c].refin, configs[c].refout);
+        DSDcc::CRC crcRef(configs[c].poly, configs[c].order, 0, 0); // plain division
+
+        for (int len = 0; len <= 32; len++)
+        {
+            for (int i = 0; i < len; i++)
+            {
+                seed = seed * 1103515245 + 12345;
+                bytes[i] = seed >> 16;
+            }
+
+            for (int i = 0; i < 8*len; i++) { // transmission order
+                bits[i] = configs[c].refin ? (bytes[i/8] >> (i%8)) & 1 : (bytes[i/8] >> (7 - (i%8))) & 1;
+            }
+
+            unsigned long ref = crc.crcbitbybitfast(bytes, len);
+            nbKO += crc.crctablefast(bytes, len) != ref ? 1 : 0;
+            nbKO += crc.crcbits(bits, 8*len) != ref ? 1 : 0;
+
+            if ((len > 0) && !configs[c].refin) // odd number of bits
+            {
+                nbKO += crcRef.crcbits(bits, 8*len - 3) != divideBits(bits, 8*len - 3, configs[c].poly, configs[c].order) ? 1 : 0;
+            }
+        }
+    }
+
+    std::cout << std::endl << "Slicing-by-8 and bit arrays: " << (nbKO == 0 ? "OK" : "KO") << std::endl;
+}
+
 int main(int argc, char *argv[])
 {
     DSDcc::CRC crc(DSDcc::CRC::PolyCCITT16, 16, 0xffff, 0xffff, 1, 1, 1);
@@ -198,6 +270,8 @@ int main(int argc, char *argv[])
 
     std::cout << ((int) strlen(dstarCRCGPS_2) - 11) << std::endl;
 
+    testSlicing();
+
     testNXDN();
 
     return 0;
@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2026 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+// Checks the burst de-interleaver against the dibit by dibit AMBE frame de-interleave
+// with the row and column tables and checks the packed codewords against the output bits.
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include "../deinterleave.h"
+
+// AMBE interleave schedule as row and column of bit 1 (W, X) and bit 0 (Y, Z) of each dibit
+static const int rW[36] = {
+  0, 1, 0, 1, 0, 1,
+  0, 1, 0, 1, 0, 1,
+  0, 1, 0, 1, 0, 1,
+  0, 1, 0, 1, 0, 2,
+  0, 2, 0, 2, 0, 2,
+  0, 2, 0, 2, 0, 2
+};
+
+static const int rX[36] = {
+  23, 10, 22, 9, 21, 8,
+  20, 7, 19, 6, 18, 5,
+  17, 4, 16, 3, 15, 2,
+  14, 1, 13, 0, 12, 10,
+  11, 9, 10, 8, 9, 7,
+  8, 6, 7, 5, 6, 4
+};
+
+static const int rY[36] = {
+  0, 2, 0, 2, 0, 2,
+  0, 2, 0, 3, 0, 3,
+  1, 3, 1, 3, 1, 3,
+  1, 3, 1, 3, 1, 3,
+  1, 3, 1, 3, 1, 3,
+  1, 3, 1, 3, 1, 3
+};
+
+static const int rZ[36] = {
+  5, 3, 4, 2, 3, 1,
+  2, 0, 1, 13, 0, 12,
+  22, 11, 21, 10, 20, 9,
+  19, 8, 18, 7, 17, 6,
+  16, 5, 15, 4, 14, 3,
+  13, 2, 12, 1, 11, 0
+};
+
+static bool testAMBE()
+{
+    DSDcc::Deinterleaver deinterleaver(DSDcc::Deinterleaver::AMBE3600x2450, 72, 96);
+    char ref[4][24], out[4][24];
+    int nbErrors = 0;
+
+    for (int n = 0; n < 1000; n++)
+    {
+        memset(ref, 0, sizeof(ref));
+        memset(out, 0, sizeof(out));
+
+        for (int i = 0; i < 36; i++)
+        {
+            unsigned char dibit = rand() & 3;
+            ref[rW[i]][rX[i]] = (1 & (dibit >> 1));
+            ref[rY[i]][rZ[i]] = (1 & dibit);
+            deinterleaver.pushDibit(i, dibit);
+        }
+
+        deinterleaver.getBits((unsigned char *) out);
+
+        if (memcmp(ref, out, sizeof(ref)) != 0) {
+            nbErrors++;
+        }
+
+        for (int r = 0; r < 4; r++)
+        {
+            uint32_t word = 0;
+
+            for (int c = 0; c < 24; c++) {
+                word = (word << 1) | ref[r][c];
+            }
+
+            if (deinterleaver.getCodeword(24*r, 24) != word) {
+                nbErrors++;
+            }
+        }
+    }
+
+    std::cout << "AMBE frame: " << (nbErrors == 0 ? "OK" : "KO") << " (" << nbErrors << " errors)" << std::endl;
+    return nbErrors == 0;
+}
+
+static bool testWhitening()
+{
+    int schedule[104];
+    unsigned char whitening[104], ref[104], out[104], dibits[52];
+
+    for (int i = 0; i < 104; i++) {
+        schedule[i] = (i * 23) % 104; // 23 and 104 are coprime
+        whitening[i] = rand() & 1;
+    }
+
+    DSDcc::Deinterleaver deinterleaver(schedule, 104, 104);
+
+    for (int i = 0; i < 52; i++)
+    {
+        dibits[i] = rand() & 3;
+        deinterleaver.pushDibit(i, dibits[i]);
+        ref[schedule[2*i]]     = ((dibits[i] >> 1) & 1) ^ whitening[schedule[2*i]];
+        ref[schedule[2*i + 1]] = (dibits[i] & 1) ^ whitening[schedule[2*i + 1]];
+    }
+
+    deinterleaver.getBits(out, whitening);
+    bool ok = memcmp(ref, out, 104) == 0;
+    std::cout << "De-interleave and de-whiten: " << (ok ? "OK" : "KO") << std::endl;
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+    bool ok = testAMBE();
+    ok = testWhitening() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+// Checks the SSE2 butterflies of the NXDN K=5 Viterbi decoder against the scalar path on random
+// symbols of all lengths up to the largest channel then checks both on noisy encoded frames.
+
+#include <iostream>
+#include <string.h>
+#include <sys/time.h>
+
+#include "../nxdnconvolution.h"
+
+static const unsigned int maxSteps = DSDcc::CNXDNConvolution::MAX_DECISIONS;
+
+long long getUSecs()
+{
+    struct timeval tp;
+    gettimeofday(&tp, 0);
+    return (long long) tp.tv_sec * 1000000L + tp.tv_usec;
+}
+
+// symbols are 0 or 2 for a received bit and 1 for a punctured one like in DSDNXDN.
+// The last 4 bits out of the trellis are the zero tail.
+void decode(DSDcc::CNXDNConvolution& conv, const unsigned char *symbols, unsigned int nbSteps, unsigned char *out, unsigned int nbBits)
+{
+    conv.start();
+
+    for (unsigned int i = 0; i < nbSteps; i++) {
+        conv.decode(symbols[2*i], symbols[2*i+1]);
+    }
+
+    conv.chainback(out, nbBits);
+}
+
+// Random symbols decoded with the SSE2 and scalar paths must give the same bits
+int testSIMD()
+{
+    DSDcc::CNXDNConvolution convSIMD, convScalar;
+    unsigned char symbols[2*maxSteps];
+    unsigned char bitsSIMD[(maxSteps+7)/8], bitsScalar[(maxSteps+7)/8];
+    int nbMismatches = 0;
+    unsigned int seed = 1;
+
+    convScalar.setSIMD(false);
+
+    for (int test = 0; test < 20000; test++)
+    {
+        unsigned int nbSteps = 1 + test % maxSteps;
+
+        for (unsigned int i = 0; i < 2*nbSteps; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            symbols[i] = ((seed >> 16) & 0xFFFF) % 3;
+        }
+
+        memset(bitsSIMD, 0, sizeof(bitsSIMD));
+        memset(bitsScalar, 0, sizeof(bitsScalar));
+        decode(convSIMD, symbols, nbSteps, bitsSIMD, nbSteps); // all decisions of the survivor path
+        decode(convScalar, symbols, nbSteps, bitsScalar, nbSteps);
+
+        if (memcmp(bitsSIMD, bitsScalar, (nbSteps+7)/8) != 0) {
+            nbMismatches++;
+        }
+    }
+
+    long long ts = getUSecs();
+
+    for (int test = 0; test < 10000; test++) {
+        decode(convSIMD, symbols, maxSteps, bitsSIMD, maxSteps - 4);
+    }
+
+    long long usecsSIMD = getUSecs() - ts;
+    ts = getUSecs();
+
+    for (int test = 0; test < 10000; test++) {
+        decode(convScalar, symbols, maxSteps, bitsScalar, maxSteps - 4);
+    }
+
+    long long usecsScalar = getUSecs() - ts;
+
+    std::cout << "SIMD: " << nbMismatches << " mismatches with scalar path over 20000 random frames. 10000x"
+        << maxSteps << " steps in " << usecsSIMD << " (SIMD) " << usecsScalar << " (scalar) microseconds" << std::endl;
+
+    return nbMismatches;
+}
+
+// Encoded frames with a few flipped and punctured symbols must be recovered by both paths
+int testNoisy(bool simd)
+{
+    DSDcc::CNXDNConvolution conv;
+    unsigned char data[(maxSteps+7)/8], coded[(2*maxSteps+7)/8], decoded[(maxSteps+7)/8];
+    unsigned char symbols[2*maxSteps];
+    int nbErrors = 0;
+    unsigned int seed = 1;
+
+    conv.setSIMD(simd);
+
+    for (int test = 0; test < 1000; test++)
+    {
+        memset(data, 0, sizeof(data));
+
+        for (unsigned int i = 0; i < maxSteps - 4; i++) // zero tail
+        {
+            seed = seed * 1103515245 + 12345;
+
+            if ((seed >> 16) & 1) {
+                data[i>>3] |= 0x80 >> (i&7);
+            }
+        }
+
+        conv.encode(data, coded, maxSteps);
+
+        for (unsigned int i = 0; i < 2*maxSteps; i++)
+        {
+            symbols[i] = (coded[i>>3] & (0x80 >> (i&7))) ? 2 : 0;
+
+            if (i % 23 == 11) { // flipped
+                symbols[i] = 2 - symbols[i];
+            } else if (i % 17 == 5) { // punctured
+                symbols[i] = 1;
+            }
+        }
+
+        decode(conv, symbols, maxSteps, decoded, maxSteps - 4);
+
+        if (memcmp(decoded, data, (maxSteps-4)/8) != 0) {
+            nbErrors++;
+        }
+    }
+
+    std::cout << "Noisy frames " << (simd ? "(SIMD)" : "(scalar)") << ": " << nbErrors << " not recovered out of 1000" << std::endl;
+
+    return nbErrors;
+}
+
+int main(int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+    int nbErrors = testSIMD();
+    nbErrors += testNoisy(true);
+    nbErrors += testNoisy(false);
+    std::cout << (nbErrors == 0 ? "OK" : "KO") << std::endl;
+    return nbErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2016 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+// Checks the packed codeword decoders against the bit array decoders for all information words
+// and all error patterns up to the correction capability of each code. Then checks the batch decoder
+// against the single codeword decoder with two or three errors.
+
+#include <iostream>
+#include <string.h>
+#include <vector>
+#include "../fec.h"
+
+static uint32_t pack(const unsigned char *bits, int nbBits)
+{
+    uint32_t word = 0;
+
+    for (int i = 0; i < nbBits; i++) {
+        word = (word << 1) | bits[i];
+    }
+
+    return word;
+}
+
+// single codeword bit array decoders
+template<class Codec> bool decodeBits(Codec& codec, unsigned char *bits) { return codec.decode(bits); }
+bool decodeBits(DSDcc::Hamming_12_8& codec, unsigned char *bits) { unsigned char d[8]; return codec.decode(bits, d, 1); }
+bool decodeBits(DSDcc::Hamming_15_11& codec, unsigned char *bits) { return codec.decode(bits, 0, 1); }
+bool decodeBits(DSDcc::Hamming_16_11_4& codec, unsigned char *bits) { return codec.decode(bits, 0, 1); }
+
+template<class Codec>
+int test(const char *name, int n, int k, int t)
+{
+    Codec codec;
+    unsigned char msg[24], codeword[24], rxBits[24];
+    int nbErrors = 0, nbTests = 0;
+
+    for (uint32_t m = 0; m < (1U << k); m++)
+    {
+        for (int i = 0; i < k; i++) {
+            msg[i] = (m >> (k - 1 - i)) & 1;
+        }
+
+        codec.encode(msg, codeword);
+
+        for (int e1 = -1; e1 < n; e1++)
+        {
+            for (int e2 = (t > 1 ? e1 + 1 : n); e2 <= n; e2++)
+            {
+                for (int e3 = (t > 2 ? e2 + 1 : n); e3 <= n; e3++)
+                {
+                    memcpy(rxBits, codeword, n);
+                    if (e1 >= 0) { rxBits[e1] ^= 1; }
+                    if (e2 < n) { rxBits[e2] ^= 1; }
+                    if (e3 < n) { rxBits[e3] ^= 1; }
+
+                    uint16_t data;
+                    bool packedOK = codec.decode(pack(rxBits, n), data);
+                    bool bitsOK = decodeBits(codec, rxBits);
+                    nbTests++;
+
+                    if (!packedOK || !bitsOK || (data != m) || (pack(rxBits, n) != pack(codeword, n))) {
+                        nbErrors++;
+                    }
+                }
+            }
+        }
+    }
+
+    // batch decoding with up to t+1 errors: must match single codeword decoding including the error map
+    std::vector<uint32_t> batch, single;
+    std::vector<uint16_t> batchData;
+    std::vector<uint32_t> errorMap;
+    int nbBatchErrors = 0;
+
+    for (uint32_t m = 0; m < (1U << k); m += (k > 8 ? 7 : 1))
+    {
+        for (int i = 0; i < k; i++) {
+            msg[i] = (m >> (k - 1 - i)) & 1;
+        }
+
+        codec.encode(msg, codeword);
+        uint32_t word = pack(codeword, n);
+
+        for (int e1 = 0; e1 < n; e1++)
+        {
+            for (int e2 = e1 + 1; e2 < n; e2++)
+            {
+                uint32_t error = (1U << e1) | (1U << e2);
+
+                if (t > 1) {
+                    error |= 1U << ((e2 + 5) % n == e1 ? (e2 + 6) % n : (e2 + 5) % n);
+                }
+
+                batch.push_back(word ^ error);
+            }
+        }
+    }
+
+    single = batch;
+    batchData.resize(batch.size());
+    errorMap.resize((batch.size() + 31) / 32);
+    codec.decodeBatch(&batch[0], &batchData[0], batch.size(), &errorMap[0]);
+
+    for (unsigned int i = 0; i < single.size(); i++)
+    {
+        bool correctable = codec.correct(single[i]);
+        bool batchCorrectable = ((errorMap[i/32] >> (i%32)) & 1) == 0;
+
+        if ((correctable != batchCorrectable) || (single[i] != batch[i]) || (batchData[i] != (batch[i] >> (n - k)))) {
+            nbBatchErrors++;
+        }
+    }
+
+    nbErrors += nbBatchErrors;
+    std::cout << name << ": " << nbTests << " tests " << single.size() << " batch tests " << nbErrors << " errors" << std::endl;
+    return nbErrors;
+}
+
+int main(int argc, char *argv[])
+{
+    (void) argc;
+    (void) argv;
+    int nbErrors = 0;
+
+    nbErrors += test<DSDcc::Hamming_7_4>("Hamming_7_4", 7, 4, 1);
+    nbErrors += test<DSDcc::Hamming_12_8>("Hamming_12_8", 12, 8, 1);
+    nbErrors += test<DSDcc::Hamming_15_11>("Hamming_15_11", 15, 11, 1);
+    nbErrors += test<DSDcc::Hamming_16_11_4>("Hamming_16_11_4", 16, 11, 1);
+    nbErrors += test<DSDcc::Golay_20_8>("Golay_20_8", 20, 8, 3);
+    nbErrors += test<DSDcc::Golay_23_12>("Golay_23_12", 23, 12, 3);
+    nbErrors += test<DSDcc::Golay_24_12>("Golay_24_12", 24, 12, 3);
+    nbErrors += test<DSDcc::QR_16_7_6>("QR_16_7_6", 16, 7, 2);
+
+    std::cout << (nbErrors ? "Packed decoding FAILED" : "Packed decoding OK") << std::endl;
+    return nbErrors ? 1 : 0;
+}
@@ -411,6 +411,104 @@ void testYSF()
 	std::cout << std::endl;
 }
 
+// Random symbols of all error levels decoded with the SIMD kernels and the scalar path must give the same bits
+void testSIMD(DSDcc::Viterbi& viterbiSIMD, DSDcc::Viterbi& viterbiScalar, const char *name)
+{
+    unsigned char symbols[400];
+    unsigned char bitsSIMD[400], bitsScalar[400];
+    int nbMismatches = 0;
+    unsigned int seed = 1;
+
+    viterbiScalar.setSIMD(false);
+
+    for (int test = 0; test < 1000; test++)
+    {
+        int nbSymbols = 1 + test % 400;
+
+        for (int i = 0; i < nbSymbols; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            symbols[i] = (seed >> 16) & 3;
+        }
+
+        viterbiSIMD.decodeFromSymbols(bitsSIMD, symbols, nbSymbols, 0);
+        viterbiScalar.decodeFromSymbols(bitsScalar, symbols, nbSymbols, 0);
+
+        if (memcmp(bitsSIMD, bitsScalar, nbSymbols) != 0) {
+            nbMismatches++;
+        }
+    }
+
+    long long ts = getUSecs();
+
+    for (int test = 0; test < 1000; test++) {
+        viterbiSIMD.decodeFromSymbols(bitsSIMD, symbols, 330, 0);
+    }
+
+    long long usecsSIMD = getUSecs() - ts;
+    ts = getUSecs();
+
+    for (int test = 0; test < 1000; test++) {
+        viterbiScalar.decodeFromSymbols(bitsScalar, symbols, 330, 0);
+    }
+
+    long long usecsScalar = getUSecs() - ts;
+
+    std::cout << "SIMD " << name << ": " << nbMismatches << " mismatches with scalar path. 1000x330 symbols in "
+        << usecsSIMD << " (SIMD) " << usecsScalar << " (scalar) microseconds" << std::endl;
+}
+
+// Noisy frames decoded from hard bits and from soft bits. Soft decision should leave fewer errors.
+void testSoft(DSDcc::Viterbi& viterbi, const char *name)
+{
+    unsigned char dataBits[104], symbols[104], hardBits[208], softBits[208], decodedBits[104];
+    int nbHardErrors = 0, nbSoftErrors = 0;
+    unsigned int seed = 1;
+
+    for (int test = 0; test < 1000; test++)
+    {
+        for (int i = 0; i < 104; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            dataBits[i] = i < 104 - (viterbi.getK() - 1) ? (seed >> 16) & 1 : 0; // zero tail
+        }
+
+        viterbi.encodeToSymbols(symbols, dataBits, 104, 0);
+
+        for (int i = 0; i < 208; i++) // bits in symbol LSB first like decodeFromBits
+        {
+            int codedBit = (symbols[i/2] >> (i%2)) & 1;
+            int noise = 0;
+
+            for (int j = 0; j < 4; j++) // roughly gaussian
+            {
+                seed = seed * 1103515245 + 12345;
+                noise += ((seed >> 16) & 0xFF) - 128;
+            }
+
+            int soft = (codedBit ? 192 : 64) + noise / 3;
+            softBits[i] = soft < 0 ? 0 : soft > 255 ? 255 : soft;
+            hardBits[i] = softBits[i] >= 128 ? 1 : 0;
+        }
+
+        viterbi.decodeFromBits(decodedBits, hardBits, 208, 0);
+
+        for (int i = 0; i < 104; i++) {
+            nbHardErrors += decodedBits[i] != dataBits[i] ? 1 : 0;
+        }
+
+        viterbi.decodeFromSoftBits(decodedBits, softBits, 208, 0);
+
+        for (int i = 0; i < 104; i++) {
+            nbSoftErrors += decodedBits[i] != dataBits[i] ? 1 : 0;
+        }
+    }
+
+    std::cout << "Soft " << name << ": " << nbHardErrors << " bit errors with hard decision "
+        << nbSoftErrors << " with soft decision over 1000x104 bits"
+        << (nbSoftErrors < nbHardErrors ? " OK" : " KO") << std::endl;
+}
+
 int main(int argc, char *argv[])
 {
 	testBitifyCharify();
@@ -419,5 +517,12 @@ int main(int argc, char *argv[])
 	test25();
 	testYSF();
 	testViterbiLegacy();
+
+	DSDcc::Viterbi3 viterbi3a(2, DSDcc::Viterbi::Poly23a, false), viterbi3b(2, DSDcc::Viterbi::Poly23a, false);
+	testSIMD(viterbi3a, viterbi3b, "K=3");
+	DSDcc::Viterbi5 viterbi5a(2, DSDcc::Viterbi::Poly25y), viterbi5b(2, DSDcc::Viterbi::Poly25y);
+	testSIMD(viterbi5a, viterbi5b, "K=5");
+	testSoft(viterbi3a, "K=3");
+	testSoft(viterbi5a, "K=5");
 	return 0;
 }
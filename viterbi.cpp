@@ -18,6 +18,7 @@
 #include <string.h>
 #include <limits.h>
 #include "viterbi.h"
+#include "dsd_stats.h"
 
 namespace DSDcc
 {
@@ -117,12 +118,12 @@ Viterbi::Viterbi(int k, int n, const unsigned int *polys, bool msbFirst) :
         m_polys(polys),
         m_msbFirst(msbFirst),
         m_nbSymbolsMax(0),
-        m_nbBitsMax(0)
+        m_simd(detectSIMD())
 {
     m_branchCodes = new unsigned char[(1<<m_k)];
     m_predA = new unsigned char[1<<(m_k-1)];
     m_predB = new unsigned char[1<<(m_k-1)];
-    m_pathMetrics = 0;
+    m_pathMetrics = new uint32_t[(1<<(m_k-1))*2]; // only one step back in memory
     m_traceback = 0;
     m_symbols = 0;
 
@@ -136,19 +137,48 @@ Viterbi::~Viterbi()
         delete[] m_symbols;
     }
 
-    if (m_pathMetrics) {
-        delete[] m_pathMetrics;
-    }
-
     if (m_traceback) {
         delete[] m_traceback;
     }
 
+    delete[] m_pathMetrics;
     delete[] m_predB;
     delete[] m_predA;
 	delete[] m_branchCodes;
 }
 
+Viterbi::SIMDLevel Viterbi::detectSIMD()
+{
+#if defined(DSD_VITERBI_X86_SIMD)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        return SIMDAVX2;
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        return SIMDSSE41;
+    }
+#endif
+    return SIMDNone;
+}
+
+void Viterbi::reserve(unsigned int nbSymbols)
+{
+    if (nbSymbols > m_nbSymbolsMax)
+    {
+        if (m_traceback) {
+            delete[] m_traceback;
+        }
+
+        if (m_symbols) {
+            delete[] m_symbols;
+        }
+
+        m_traceback = new unsigned char[(1<<(m_k-1)) * nbSymbols];
+        m_symbols = new unsigned char[nbSymbols];
+        m_nbSymbolsMax = nbSymbols;
+    }
+}
+
 void Viterbi::initCodes()
 {
 	unsigned char symbol;
@@ -225,15 +255,7 @@ void Viterbi::decodeFromBits(
         unsigned int startstate)      //!< Encoder starting state
 
 {
-    if (nbBits > m_nbBitsMax)
-    {
-        if (m_symbols) {
-            delete[] m_symbols;
-        }
-
-        m_symbols = new unsigned char[nbBits/m_n];
-        m_nbBitsMax = nbBits;
-    }
+    reserve(nbBits/m_n);
 
     for (unsigned int i = 0; i < nbBits; i += m_n)
     {
@@ -255,20 +277,8 @@ void Viterbi::decodeFromSymbols(
         unsigned int startstate)      //!< Encoder starting state
 
 {
-    if (nbSymbols > m_nbSymbolsMax)
-    {
-        if (m_traceback) {
-            delete[] m_traceback;
-        }
-
-        if (m_pathMetrics) {
-            delete[] m_pathMetrics;
-        }
-
-        m_traceback = new unsigned char[(1<<(m_k-1)) * nbSymbols];
-        m_pathMetrics = new uint32_t[(1<<(m_k-1))*2]; // only one step back in memory
-        m_nbSymbolsMax = nbSymbols;
-    }
+    DSD_STATS_FEC_SCOPE();
+    reserve(nbSymbols);
 
     // initial path metrics state
     memset(m_pathMetrics, m_maxMetric, sizeof(uint32_t) * (1<<(m_k-1)));
@@ -391,6 +401,79 @@ void Viterbi::decodeFromSymbols(
     }
 }
 
+void Viterbi::decodeFromSoftBits(
+        unsigned char *dataBits,       //!< Decoded output data bits
+        const unsigned char *softBits, //!< Input soft bits
+        unsigned int nbBits,           //!< Number of input soft bits
+        unsigned int startstate)       //!< Encoder starting state
+{
+    DSD_STATS_FEC_SCOPE();
+    unsigned int nbSymbols = nbBits / m_n;
+    unsigned int nbStates = 1<<(m_k-1);
+    reserve(nbSymbols);
+
+    // larger than any metric a path can accumulate so that all paths come from the start state
+    uint32_t unreachable = 255U * m_n * nbSymbols + 1U;
+    uint32_t *pathMetrics = m_pathMetrics;
+    uint32_t *newPathMetrics = &m_pathMetrics[nbStates];
+    uint32_t branchMetrics[1<<8];
+
+    for (unsigned int ib = 0; ib < nbStates; ib++) {
+        pathMetrics[ib] = unreachable;
+    }
+
+    pathMetrics[startstate] = 0;
+
+    for (unsigned int is = 0; is < nbSymbols; is++)
+    {
+        const unsigned char *soft = &softBits[is*m_n];
+
+        // distance of the soft bits to each possible code
+        for (int code = 0; code < (1<<m_n); code++)
+        {
+            branchMetrics[code] = 0;
+
+            for (int j = 0; j < m_n; j++) {
+                branchMetrics[code] += ((code>>j) & 1) ? 255 - soft[j] : soft[j];
+            }
+        }
+
+        for (unsigned int ib = 0; ib < nbStates; ib++)
+        {
+            unsigned char bit = ib < nbStates/2 ? 0 : 1;
+            unsigned char predA = m_predA[ib];
+            unsigned char predB = m_predB[ib];
+            uint32_t pmA = pathMetrics[predA] + branchMetrics[m_branchCodes[(predA<<1)+bit]];
+            uint32_t pmB = pathMetrics[predB] + branchMetrics[m_branchCodes[(predB<<1)+bit]];
+
+            if (pmA <= pmB)
+            {
+                newPathMetrics[ib] = pmA;
+                m_traceback[ib + is*nbStates] = predA;
+            }
+            else
+            {
+                newPathMetrics[ib] = pmB;
+                m_traceback[ib + is*nbStates] = predB;
+            }
+        }
+
+        uint32_t *tmp = pathMetrics;
+        pathMetrics = newPathMetrics;
+        newPathMetrics = tmp;
+    }
+
+    // trace back from the zero state reached by the tail bits
+
+    unsigned int bIx = 0;
+
+    for (int is = nbSymbols-1; is >= 0; is--)
+    {
+        dataBits[is] = bIx < nbStates/2 ? 0U : 1U;
+        bIx = m_traceback[bIx + is*nbStates];
+    }
+}
+
 
 } // namespace DSDcc
 
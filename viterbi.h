@@ -23,6 +23,10 @@
 
 #include "export.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DSD_VITERBI_X86_SIMD //!< SSE4.1 and AVX2 kernels selected at run time
+#endif
+
 namespace DSDcc
 {
 
@@ -64,6 +68,21 @@ public:
         unsigned int startstate     //!< Encoder starting state
     );
 
+    /** Viterbi decoder with soft decision input. There are n soft bits per symbol from 0 (surely 0)
+     *  to 255 (surely 1) in the same order as the bits given to decodeFromBits() */
+    void decodeFromSoftBits(
+        unsigned char *dataBits,       //!< Decoded output data bits
+        const unsigned char *softBits, //!< Input soft bits
+        unsigned int nbBits,           //!< Number of input soft bits
+        unsigned int startstate        //!< Encoder starting state
+    );
+
+    /** Preallocate the decoding buffers for inputs of up to nbSymbols symbols so that decoding does not allocate */
+    void reserve(unsigned int nbSymbols);
+
+    /** Use the SIMD add-compare-select kernels when the CPU supports them (default) or force the scalar path */
+    void setSIMD(bool simd) { m_simd = simd ? detectSIMD() : SIMDNone; }
+
     int getK() const { return m_k; }
     int getN() const { return m_n; }
     const unsigned char *getBranchCodes() const { return m_branchCodes; }
@@ -80,6 +99,14 @@ public:
     static const unsigned char NbOnes[];
 
 protected:
+    typedef enum
+    {
+        SIMDNone,
+        SIMDSSE41,
+        SIMDAVX2
+    } SIMDLevel;
+
+    static SIMDLevel detectSIMD();
     void initCodes();
     void initTreillis();
 
@@ -101,7 +128,7 @@ protected:
     unsigned char *m_predB;
     unsigned char *m_symbols;
     unsigned int m_nbSymbolsMax;
-    unsigned int m_nbBitsMax;
+    SIMDLevel m_simd;
     static const uint32_t m_maxMetric;
 };
 
@@ -21,10 +21,74 @@
 #include <limits.h>
 
 #include "viterbi3.h"
+#include "dsd_stats.h"
+
+#if defined(DSD_VITERBI_X86_SIMD)
+#include <immintrin.h>
+#endif
 
 namespace DSDcc
 {
 
+#if defined(DSD_VITERBI_X86_SIMD)
+// Number of ones in each 16 bit lane holding a value below 256
+__attribute__((target("sse4.1")))
+static inline __m128i nbOnesSSE41(__m128i x)
+{
+    const __m128i nibbleOnes = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i lowNibble = _mm_set1_epi8(0x0F);
+    return _mm_add_epi8(_mm_shuffle_epi8(nibbleOnes, _mm_and_si128(x, lowNibble)),
+            _mm_shuffle_epi8(nibbleOnes, _mm_and_si128(_mm_srli_epi16(x, 4), lowNibble)));
+}
+
+// Same add-compare-select as Viterbi3::doMetrics on 16 bit saturated metrics renormalised to the
+// smallest one at each step. Decisions only depend on metric differences so they are the same.
+__attribute__((target("sse4.1")))
+static void doMetricsSSE41(
+        const unsigned char *branchCodes,
+        const unsigned char *symbols,
+        unsigned int nbSymbols,
+        unsigned char *pathMemory,
+        uint32_t *pathMetrics)
+{
+    // state S takes the upper path from 2*(S%2) and the lower path from 2*(S%2)+1 with input bit S/2
+    const __m128i codes0 = _mm_setr_epi16(branchCodes[0], branchCodes[4], branchCodes[1], branchCodes[5], 0, 0, 0, 0);
+    const __m128i codes1 = _mm_setr_epi16(branchCodes[2], branchCodes[6], branchCodes[3], branchCodes[7], 0, 0, 0, 0);
+    const __m128i upperPaths = _mm_setr_epi8(0, 1, 4, 5, 0, 1, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i lowerPaths = _mm_setr_epi8(2, 3, 6, 7, 2, 3, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i upperStates = _mm_setr_epi16(0, 2, 0, 2, 0, 0, 0, 0);
+    const __m128i unusedLanes = _mm_setr_epi16(0, 0, 0, 0, -1, -1, -1, -1);
+    const __m128i broadcast0 = _mm_setr_epi8(0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1);
+    const __m128i one = _mm_set1_epi16(1);
+    uint16_t metrics[8];
+
+    for (int i = 0; i < 4; i++) {
+        metrics[i] = pathMetrics[i] < 0xFFFF ? pathMetrics[i] : 0xFFFF;
+    }
+
+    __m128i pm = _mm_setr_epi16(metrics[0], metrics[1], metrics[2], metrics[3], 0, 0, 0, 0);
+
+    for (unsigned int is = 0; is < nbSymbols; is++)
+    {
+        __m128i symbol = _mm_set1_epi16(symbols[is]);
+        __m128i m1 = _mm_adds_epu16(_mm_shuffle_epi8(pm, upperPaths), nbOnesSSE41(_mm_xor_si128(codes0, symbol)));
+        __m128i m2 = _mm_adds_epu16(_mm_shuffle_epi8(pm, lowerPaths), nbOnesSSE41(_mm_xor_si128(codes1, symbol)));
+        __m128i pmNew = _mm_min_epu16(m1, m2);
+        __m128i states = _mm_add_epi16(upperStates, _mm_and_si128(_mm_cmpeq_epi16(pmNew, m2), one)); // lower path if m1 >= m2
+        int predecessors = _mm_cvtsi128_si32(_mm_packus_epi16(states, states));
+        memcpy(&pathMemory[4*is], &predecessors, 4);
+        __m128i minMetric = _mm_minpos_epu16(_mm_or_si128(pmNew, unusedLanes));
+        pm = _mm_sub_epi16(pmNew, _mm_shuffle_epi8(minMetric, broadcast0));
+    }
+
+    _mm_storeu_si128((__m128i *) metrics, pm);
+
+    for (int i = 0; i < 4; i++) {
+        pathMetrics[i] = metrics[i];
+    }
+}
+#endif
+
 Viterbi3::Viterbi3(int n, const unsigned int *polys, bool msbFirst) :
         Viterbi(3, n, polys, msbFirst)
 {
@@ -41,15 +105,7 @@ void Viterbi3::decodeFromBits(
         unsigned int startstate)      //!< Encoder starting state
 
 {
-    if (nbBits > m_nbBitsMax)
-    {
-        if (m_symbols) {
-            delete[] m_symbols;
-        }
-
-        m_symbols = new unsigned char[nbBits/m_n];
-        m_nbBitsMax = nbBits;
-    }
+    reserve(nbBits/m_n);
 
     for (unsigned int i = 0; i < nbBits; i += m_n)
     {
@@ -71,38 +127,29 @@ void Viterbi3::decodeFromSymbols(
         unsigned int startstate)      //!< Encoder starting state
 
 {
-    if (nbSymbols > m_nbSymbolsMax)
-    {
-        if (m_traceback) {
-            delete[] m_traceback;
-        }
-
-        if (m_pathMetrics) {
-            delete[] m_pathMetrics;
-        }
-
-        m_traceback = new unsigned char[4 * nbSymbols];
-        m_pathMetrics = new uint32_t[4];
-        m_nbSymbolsMax = nbSymbols;
-    }
+    DSD_STATS_FEC_SCOPE();
+    reserve(nbSymbols);
 
     // initial path metrics state
-    memset(m_pathMetrics, Viterbi::m_maxMetric, sizeof(uint32_t) * (1<<(m_k-1)));
+    memset(m_pathMetrics, Viterbi::m_maxMetric, 4 * sizeof(uint32_t));
     m_pathMetrics[startstate] = 0;
 
+    // traceback holds the 4 predecessor states of each symbol
+#if defined(DSD_VITERBI_X86_SIMD)
+    if (m_simd != SIMDNone) { // 4 states fit in a SSE register
+
+        doMetricsSSE41(m_branchCodes, symbols, nbSymbols, m_traceback, m_pathMetrics);
+    } else
+#endif
     for (unsigned int is = 0; is < nbSymbols; is++)
     {
 //        std::cerr << "Viterbi3::decodeFromSymbols: S[" << is << "]=" << (int) symbols[is] << std::endl;
 
         // compute metrics
         doMetrics(
-                is,
                 m_branchCodes,
                 symbols[is],
-                m_traceback,
-                &m_traceback[nbSymbols],
-                &m_traceback[2*nbSymbols],
-                &m_traceback[3*nbSymbols],
+                &m_traceback[4*is],
                 m_pathMetrics
         );
     } // symbols
@@ -127,21 +174,14 @@ void Viterbi3::decodeFromSymbols(
             nbSymbols,
             minPathIndex,
             dataBits,
-            m_traceback,
-            &m_traceback[nbSymbols],
-            &m_traceback[2*nbSymbols],
-            &m_traceback[3*nbSymbols]
+            m_traceback
     );
 }
 
 void Viterbi3::doMetrics(
-        int n,
-        unsigned char *branchCodes,
+        const unsigned char *branchCodes,
         unsigned char symbol,
-        unsigned char *m_pathMemory0,
-        unsigned char *m_pathMemory1,
-        unsigned char *m_pathMemory2,
-        unsigned char *m_pathMemory3,
+        unsigned char *pathMemory,
         uint32_t  *m_pathMetric
 )
 {
@@ -171,12 +211,12 @@ void Viterbi3::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory0[n] = 0; // upper path (S0)
+        pathMemory[0] = 0; // upper path (S0)
         tempMetric[0] = m1;
     }
     else
     {
-        m_pathMemory0[n] = 1; // lower path (S1)
+        pathMemory[0] = 1; // lower path (S1)
         tempMetric[0] = m2;
     }; // end else - if
 
@@ -186,12 +226,12 @@ void Viterbi3::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory1[n] = 2; // upper path (S2)
+        pathMemory[1] = 2; // upper path (S2)
         tempMetric[1] = m1;
     }
     else
     {
-        m_pathMemory1[n] = 3; // lower path (S3)
+        pathMemory[1] = 3; // lower path (S3)
         tempMetric[1] = m2;
     }; // end else - if
 
@@ -201,12 +241,12 @@ void Viterbi3::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory2[n] = 0; // upper path (S0)
+        pathMemory[2] = 0; // upper path (S0)
         tempMetric[2] = m1;
     }
     else
     {
-        m_pathMemory2[n] = 1; // lower path (S1)
+        pathMemory[2] = 1; // lower path (S1)
         tempMetric[2] = m2;
     }
 
@@ -216,12 +256,12 @@ void Viterbi3::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory3[n] = 2; // upper path (S2)
+        pathMemory[3] = 2; // upper path (S2)
         tempMetric[3] = m1;
     }
     else
     {
-        m_pathMemory3[n] = 3; // lower path (S3)
+        pathMemory[3] = 3; // lower path (S3)
         tempMetric[3] = m2;
     }; // end else - if
 
@@ -239,41 +279,16 @@ void Viterbi3::traceBack (
         int nbSymbols,
         unsigned int startState,
         unsigned char *out,
-        unsigned char *m_pathMemory0,
-        unsigned char *m_pathMemory1,
-        unsigned char *m_pathMemory2,
-        unsigned char *m_pathMemory3
+        const unsigned char *pathMemory
 )
 {
     unsigned int state = startState;
 
     for (int loop = nbSymbols - 1; loop >= 0; loop--)
     {
-        // TODO: store directly the integer state value in path memory
-        switch (state)
-        {
-        case 0: // if state S0, Prev. state = S0 | S1
-            state = m_pathMemory0[loop];
-            out[loop] = 0;
-            break;
-
-        case 1: // if state S1, Prev. state = S2 | S3
-            state = m_pathMemory1[loop];
-            out[loop] = 0;
-            break;
-
-        case 2: // if state S2, Prev. state = S0 | S1
-            state = m_pathMemory2[loop];
-            out[loop] = 1;
-            break;
-
-        case 3: // if state S3, Prev. state = S2 | S3
-            state = m_pathMemory3[loop];
-            out[loop] = 1;
-            break;
-
-        }; // end switch
-    }; // end for
+        out[loop] = state < 2 ? 0 : 1; // upper half of the states are reached with a one
+        state = pathMemory[4*loop + state];
+    }
 }
 
 }
@@ -49,13 +49,9 @@ public:
 
 private:
     static void doMetrics (
-            int n,
-            unsigned char *branchCodes,
+            const unsigned char *branchCodes,
             unsigned char symbol,
-            unsigned char *m_pathMemory0,
-            unsigned char *m_pathMemory1,
-            unsigned char *m_pathMemory2,
-            unsigned char *m_pathMemory3,
+            unsigned char *pathMemory,
             uint32_t *m_pathMetric
     );
 
@@ -63,10 +59,7 @@ private:
             int nbSymbols,
             unsigned int startState,
             unsigned char *out,
-            unsigned char *m_pathMemory0,
-            unsigned char *m_pathMemory1,
-            unsigned char *m_pathMemory2,
-            unsigned char *m_pathMemory3
+            const unsigned char *pathMemory
     );
 };
 
@@ -21,10 +21,154 @@
 #include <limits.h>
 
 #include "viterbi5.h"
+#include "dsd_stats.h"
+
+#if defined(DSD_VITERBI_X86_SIMD)
+#include <immintrin.h>
+#endif
 
 namespace DSDcc
 {
 
+#if defined(DSD_VITERBI_X86_SIMD)
+// Number of ones in each 16 bit lane holding a value below 256
+__attribute__((target("sse4.1")))
+static inline __m128i nbOnesSSE41(__m128i x)
+{
+    const __m128i nibbleOnes = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i lowNibble = _mm_set1_epi8(0x0F);
+    return _mm_add_epi8(_mm_shuffle_epi8(nibbleOnes, _mm_and_si128(x, lowNibble)),
+            _mm_shuffle_epi8(nibbleOnes, _mm_and_si128(_mm_srli_epi16(x, 4), lowNibble)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i nbOnesAVX2(__m256i x)
+{
+    const __m256i nibbleOnes = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(nibbleOnes, _mm256_and_si256(x, lowNibble)),
+            _mm256_shuffle_epi8(nibbleOnes, _mm256_and_si256(_mm256_srli_epi16(x, 4), lowNibble)));
+}
+
+// Same add-compare-select as Viterbi5::doMetrics on 16 bit saturated metrics renormalised to the
+// smallest one at each step. Decisions only depend on metric differences so they are the same.
+// State S takes the upper path from 2*(S%8) and the lower path from 2*(S%8)+1 with input bit S/8.
+__attribute__((target("sse4.1")))
+static void doMetricsSSE41(
+        const unsigned char *branchCodes,
+        const unsigned char *symbols,
+        unsigned int nbSymbols,
+        unsigned char *pathMemory,
+        uint32_t *pathMetrics)
+{
+    __m128i codes[4]; // upper and lower paths for input bit 0 then 1
+
+    for (int i = 0; i < 4; i++)
+    {
+        const int path = i & 1, bit = i >> 1;
+        codes[i] = _mm_setr_epi16(branchCodes[path*2 + bit], branchCodes[4 + path*2 + bit],
+                branchCodes[8 + path*2 + bit], branchCodes[12 + path*2 + bit],
+                branchCodes[16 + path*2 + bit], branchCodes[20 + path*2 + bit],
+                branchCodes[24 + path*2 + bit], branchCodes[28 + path*2 + bit]);
+    }
+
+    const __m128i evenOdd = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    const __m128i upperStates = _mm_setr_epi16(0, 2, 4, 6, 8, 10, 12, 14);
+    const __m128i broadcast0 = _mm_setr_epi8(0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1);
+    const __m128i one = _mm_set1_epi16(1);
+    uint16_t metrics[16];
+
+    for (int i = 0; i < 16; i++) {
+        metrics[i] = pathMetrics[i] < 0xFFFF ? pathMetrics[i] : 0xFFFF;
+    }
+
+    __m128i pmLo = _mm_loadu_si128((const __m128i *) &metrics[0]);
+    __m128i pmHi = _mm_loadu_si128((const __m128i *) &metrics[8]);
+
+    for (unsigned int is = 0; is < nbSymbols; is++)
+    {
+        __m128i symbol = _mm_set1_epi16(symbols[is]);
+        __m128i a = _mm_shuffle_epi8(pmLo, evenOdd);
+        __m128i b = _mm_shuffle_epi8(pmHi, evenOdd);
+        __m128i even = _mm_unpacklo_epi64(a, b); // upper path predecessors
+        __m128i odd = _mm_unpackhi_epi64(a, b);  // lower path predecessors
+        __m128i m1Lo = _mm_adds_epu16(even, nbOnesSSE41(_mm_xor_si128(codes[0], symbol)));
+        __m128i m2Lo = _mm_adds_epu16(odd, nbOnesSSE41(_mm_xor_si128(codes[1], symbol)));
+        __m128i m1Hi = _mm_adds_epu16(even, nbOnesSSE41(_mm_xor_si128(codes[2], symbol)));
+        __m128i m2Hi = _mm_adds_epu16(odd, nbOnesSSE41(_mm_xor_si128(codes[3], symbol)));
+        __m128i newLo = _mm_min_epu16(m1Lo, m2Lo);
+        __m128i newHi = _mm_min_epu16(m1Hi, m2Hi);
+        __m128i statesLo = _mm_add_epi16(upperStates, _mm_and_si128(_mm_cmpeq_epi16(newLo, m2Lo), one)); // lower path if m1 >= m2
+        __m128i statesHi = _mm_add_epi16(upperStates, _mm_and_si128(_mm_cmpeq_epi16(newHi, m2Hi), one));
+        _mm_storeu_si128((__m128i *) &pathMemory[16*is], _mm_packus_epi16(statesLo, statesHi));
+        __m128i minMetric = _mm_shuffle_epi8(_mm_minpos_epu16(_mm_min_epu16(newLo, newHi)), broadcast0);
+        pmLo = _mm_sub_epi16(newLo, minMetric);
+        pmHi = _mm_sub_epi16(newHi, minMetric);
+    }
+
+    _mm_storeu_si128((__m128i *) &metrics[0], pmLo);
+    _mm_storeu_si128((__m128i *) &metrics[8], pmHi);
+
+    for (int i = 0; i < 16; i++) {
+        pathMetrics[i] = metrics[i];
+    }
+}
+
+// The 16 states in one AVX2 register
+__attribute__((target("avx2")))
+static void doMetricsAVX2(
+        const unsigned char *branchCodes,
+        const unsigned char *symbols,
+        unsigned int nbSymbols,
+        unsigned char *pathMemory,
+        uint32_t *pathMetrics)
+{
+    uint16_t codes[2][16]; // upper and lower paths
+
+    for (int s = 0; s < 16; s++)
+    {
+        codes[0][s] = branchCodes[4*(s%8) + s/8];
+        codes[1][s] = branchCodes[4*(s%8) + 2 + s/8];
+    }
+
+    const __m256i codes0 = _mm256_loadu_si256((const __m256i *) codes[0]);
+    const __m256i codes1 = _mm256_loadu_si256((const __m256i *) codes[1]);
+    const __m256i evenOdd = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+            0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    const __m256i upperStates = _mm256_setr_epi16(0, 2, 4, 6, 8, 10, 12, 14, 0, 2, 4, 6, 8, 10, 12, 14);
+    const __m256i one = _mm256_set1_epi16(1);
+    uint16_t metrics[16];
+
+    for (int i = 0; i < 16; i++) {
+        metrics[i] = pathMetrics[i] < 0xFFFF ? pathMetrics[i] : 0xFFFF;
+    }
+
+    __m256i pm = _mm256_loadu_si256((const __m256i *) metrics);
+
+    for (unsigned int is = 0; is < nbSymbols; is++)
+    {
+        __m256i symbol = _mm256_set1_epi16(symbols[is]);
+        // even predecessors in the low half and odd in the high half
+        __m256i evenOdd4 = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(pm, evenOdd), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i m1 = _mm256_adds_epu16(_mm256_permute2x128_si256(evenOdd4, evenOdd4, 0x00), nbOnesAVX2(_mm256_xor_si256(codes0, symbol)));
+        __m256i m2 = _mm256_adds_epu16(_mm256_permute2x128_si256(evenOdd4, evenOdd4, 0x11), nbOnesAVX2(_mm256_xor_si256(codes1, symbol)));
+        __m256i pmNew = _mm256_min_epu16(m1, m2);
+        __m256i states = _mm256_add_epi16(upperStates, _mm256_and_si256(_mm256_cmpeq_epi16(pmNew, m2), one)); // lower path if m1 >= m2
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(states, states), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i *) &pathMemory[16*is], _mm256_castsi256_si128(packed));
+        __m128i minMetric = _mm_minpos_epu16(_mm_min_epu16(_mm256_castsi256_si128(pmNew), _mm256_extracti128_si256(pmNew, 1)));
+        pm = _mm256_sub_epi16(pmNew, _mm256_broadcastw_epi16(minMetric));
+    }
+
+    _mm256_storeu_si256((__m256i *) metrics, pm);
+
+    for (int i = 0; i < 16; i++) {
+        pathMetrics[i] = metrics[i];
+    }
+}
+#endif
+
 Viterbi5::Viterbi5(int n, const unsigned int *polys, bool msbFirst) :
         Viterbi(5, n, polys, msbFirst)
 {
@@ -41,15 +185,7 @@ void Viterbi5::decodeFromBits(
         unsigned int startstate)      //!< Encoder starting state
 
 {
-    if (nbBits > m_nbBitsMax)
-    {
-        if (m_symbols) {
-            delete[] m_symbols;
-        }
-
-        m_symbols = new unsigned char[nbBits/m_n];
-        m_nbBitsMax = nbBits;
-    }
+    reserve(nbBits/m_n);
 
     for (unsigned int i = 0; i < nbBits; i += m_n)
     {
@@ -71,50 +207,30 @@ void Viterbi5::decodeFromSymbols(
         unsigned int startstate)      //!< Encoder starting state
 
 {
-    if (nbSymbols > m_nbSymbolsMax)
-    {
-        if (m_traceback) {
-            delete[] m_traceback;
-        }
-
-        if (m_pathMetrics) {
-            delete[] m_pathMetrics;
-        }
-
-        m_traceback = new unsigned char[16 * nbSymbols];
-        m_pathMetrics = new uint32_t[16];
-        m_nbSymbolsMax = nbSymbols;
-    }
+    DSD_STATS_FEC_SCOPE();
+    reserve(nbSymbols);
 
     // initial path metrics state
     memset(m_pathMetrics, Viterbi::m_maxMetric, 16 * sizeof(uint32_t));
     m_pathMetrics[startstate] = 0;
 
+    // traceback holds the 16 predecessor states of each symbol
+#if defined(DSD_VITERBI_X86_SIMD)
+    if (m_simd == SIMDAVX2) {
+        doMetricsAVX2(m_branchCodes, symbols, nbSymbols, m_traceback, m_pathMetrics);
+    } else if (m_simd != SIMDNone) {
+        doMetricsSSE41(m_branchCodes, symbols, nbSymbols, m_traceback, m_pathMetrics);
+    } else
+#endif
     for (unsigned int is = 0; is < nbSymbols; is++)
     {
-//        std::cerr << "Viterbi3::decodeFromSymbols: S[" << is << "]=" << (int) symbols[is] << std::endl;
+//        std::cerr << "Viterbi5::decodeFromSymbols: S[" << is << "]=" << (int) symbols[is] << std::endl;
 
         // compute metrics
         doMetrics(
-                is,
                 m_branchCodes,
                 symbols[is],
-                &m_traceback[0*nbSymbols],
-                &m_traceback[1*nbSymbols],
-                &m_traceback[2*nbSymbols],
-                &m_traceback[3*nbSymbols],
-                &m_traceback[4*nbSymbols],
-                &m_traceback[5*nbSymbols],
-                &m_traceback[6*nbSymbols],
-                &m_traceback[7*nbSymbols],
-                &m_traceback[8*nbSymbols],
-                &m_traceback[9*nbSymbols],
-                &m_traceback[10*nbSymbols],
-                &m_traceback[11*nbSymbols],
-                &m_traceback[12*nbSymbols],
-                &m_traceback[13*nbSymbols],
-                &m_traceback[14*nbSymbols],
-                &m_traceback[15*nbSymbols],
+                &m_traceback[16*is],
                 m_pathMetrics
         );
     } // symbols
@@ -133,51 +249,20 @@ void Viterbi5::decodeFromSymbols(
         }
     }
 
-//    std::cerr << "Viterbi3::decodeFromSymbols: last path node: " << minPathIndex << std::endl;
+//    std::cerr << "Viterbi5::decodeFromSymbols: last path node: " << minPathIndex << std::endl;
 
     traceBack(
             nbSymbols,
             minPathIndex,
             dataBits,
-            &m_traceback[0*nbSymbols],
-            &m_traceback[1*nbSymbols],
-            &m_traceback[2*nbSymbols],
-            &m_traceback[3*nbSymbols],
-            &m_traceback[4*nbSymbols],
-            &m_traceback[5*nbSymbols],
-            &m_traceback[6*nbSymbols],
-            &m_traceback[7*nbSymbols],
-            &m_traceback[8*nbSymbols],
-            &m_traceback[9*nbSymbols],
-            &m_traceback[10*nbSymbols],
-            &m_traceback[11*nbSymbols],
-            &m_traceback[12*nbSymbols],
-            &m_traceback[13*nbSymbols],
-            &m_traceback[14*nbSymbols],
-            &m_traceback[15*nbSymbols]
+            m_traceback
     );
 }
 
 void Viterbi5::doMetrics(
-        int n,
-        unsigned char *branchCodes,
+        const unsigned char *branchCodes,
         unsigned char symbol,
-        unsigned char *m_pathMemory0,
-        unsigned char *m_pathMemory1,
-        unsigned char *m_pathMemory2,
-        unsigned char *m_pathMemory3,
-        unsigned char *m_pathMemory4,
-        unsigned char *m_pathMemory5,
-        unsigned char *m_pathMemory6,
-        unsigned char *m_pathMemory7,
-        unsigned char *m_pathMemory8,
-        unsigned char *m_pathMemory9,
-        unsigned char *m_pathMemory10,
-        unsigned char *m_pathMemory11,
-        unsigned char *m_pathMemory12,
-        unsigned char *m_pathMemory13,
-        unsigned char *m_pathMemory14,
-        unsigned char *m_pathMemory15,
+        unsigned char *pathMemory,
         uint32_t  *m_pathMetric
 )
 {
@@ -230,12 +315,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory0[n] = 0; // upper path (S0)
+        pathMemory[0] = 0; // upper path (S0)
         tempMetric[0] = m1;
     }
     else
     {
-        m_pathMemory0[n] = 1; // lower path (S1)
+        pathMemory[0] = 1; // lower path (S1)
         tempMetric[0] = m2;
     }; // end else - if
 
@@ -245,12 +330,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory1[n] = 2; // upper path (S2)
+        pathMemory[1] = 2; // upper path (S2)
         tempMetric[1] = m1;
     }
     else
     {
-        m_pathMemory1[n] = 3; // lower path (S3)
+        pathMemory[1] = 3; // lower path (S3)
         tempMetric[1] = m2;
     }; // end else - if
 
@@ -260,12 +345,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory2[n] = 4; // upper path (S4)
+        pathMemory[2] = 4; // upper path (S4)
         tempMetric[2] = m1;
     }
     else
     {
-        m_pathMemory2[n] = 5; // lower path (S5)
+        pathMemory[2] = 5; // lower path (S5)
         tempMetric[2] = m2;
     }
 
@@ -275,12 +360,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory3[n] = 6; // upper path (S6)
+        pathMemory[3] = 6; // upper path (S6)
         tempMetric[3] = m1;
     }
     else
     {
-        m_pathMemory3[n] = 7; // lower path (S7)
+        pathMemory[3] = 7; // lower path (S7)
         tempMetric[3] = m2;
     }; // end else - if
 
@@ -290,12 +375,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory4[n] = 8; // upper path (S8)
+        pathMemory[4] = 8; // upper path (S8)
         tempMetric[4] = m1;
     }
     else
     {
-        m_pathMemory4[n] = 9; // lower path (S9)
+        pathMemory[4] = 9; // lower path (S9)
         tempMetric[4] = m2;
     }; // end else - if
 
@@ -305,12 +390,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory5[n] = 10; // upper path (S10)
+        pathMemory[5] = 10; // upper path (S10)
         tempMetric[5] = m1;
     }
     else
     {
-        m_pathMemory5[n] = 11; // lower path (S11)
+        pathMemory[5] = 11; // lower path (S11)
         tempMetric[5] = m2;
     }; // end else - if
 
@@ -320,12 +405,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory6[n] = 12; // upper path (S12)
+        pathMemory[6] = 12; // upper path (S12)
         tempMetric[6] = m1;
     }
     else
     {
-        m_pathMemory6[n] = 13; // lower path (S13)
+        pathMemory[6] = 13; // lower path (S13)
         tempMetric[6] = m2;
     }; // end else - if
 
@@ -335,12 +420,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory7[n] = 14; // upper path (S14)
+        pathMemory[7] = 14; // upper path (S14)
         tempMetric[7] = m1;
     }
     else
     {
-        m_pathMemory7[n] = 15; // lower path (S15)
+        pathMemory[7] = 15; // lower path (S15)
         tempMetric[7] = m2;
     }; // end else - if
 
@@ -352,12 +437,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory8[n] = 0; // upper path (S0)
+        pathMemory[8] = 0; // upper path (S0)
         tempMetric[8] = m1;
     }
     else
     {
-        m_pathMemory8[n] = 1; // lower path (S1)
+        pathMemory[8] = 1; // lower path (S1)
         tempMetric[8] = m2;
     }; // end else - if
 
@@ -367,12 +452,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory9[n] = 2; // upper path (S2)
+        pathMemory[9] = 2; // upper path (S2)
         tempMetric[9] = m1;
     }
     else
     {
-        m_pathMemory9[n] = 3; // lower path (S3)
+        pathMemory[9] = 3; // lower path (S3)
         tempMetric[9] = m2;
     }; // end else - if
 
@@ -382,12 +467,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory10[n] = 4; // upper path (S4)
+        pathMemory[10] = 4; // upper path (S4)
         tempMetric[10] = m1;
     }
     else
     {
-        m_pathMemory10[n] = 5; // lower path (S5)
+        pathMemory[10] = 5; // lower path (S5)
         tempMetric[10] = m2;
     }
 
@@ -397,12 +482,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory11[n] = 6; // upper path (S6)
+        pathMemory[11] = 6; // upper path (S6)
         tempMetric[11] = m1;
     }
     else
     {
-        m_pathMemory11[n] = 7; // lower path (S7)
+        pathMemory[11] = 7; // lower path (S7)
         tempMetric[11] = m2;
     }; // end else - if
 
@@ -412,12 +497,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory12[n] = 8; // upper path (S8)
+        pathMemory[12] = 8; // upper path (S8)
         tempMetric[12] = m1;
     }
     else
     {
-        m_pathMemory12[n] = 9; // lower path (S9)
+        pathMemory[12] = 9; // lower path (S9)
         tempMetric[12] = m2;
     }; // end else - if
 
@@ -427,12 +512,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory13[n] = 10; // upper path (S10)
+        pathMemory[13] = 10; // upper path (S10)
         tempMetric[13] = m1;
     }
     else
     {
-        m_pathMemory13[n] = 11; // lower path (S11)
+        pathMemory[13] = 11; // lower path (S11)
         tempMetric[13] = m2;
     }; // end else - if
 
@@ -442,12 +527,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory14[n] = 12; // upper path (S12)
+        pathMemory[14] = 12; // upper path (S12)
         tempMetric[14] = m1;
     }
     else
     {
-        m_pathMemory14[n] = 13; // lower path (S13)
+        pathMemory[14] = 13; // lower path (S13)
         tempMetric[14] = m2;
     }; // end else - if
 
@@ -457,12 +542,12 @@ void Viterbi5::doMetrics(
 
     if (m1 < m2)
     {
-        m_pathMemory15[n] = 14; // upper path (S14)
+        pathMemory[15] = 14; // upper path (S14)
         tempMetric[15] = m1;
     }
     else
     {
-        m_pathMemory15[n] = 15; // lower path (S15)
+        pathMemory[15] = 15; // lower path (S15)
         tempMetric[15] = m2;
     }; // end else - if
 
@@ -492,111 +577,16 @@ void Viterbi5::traceBack (
         int nbSymbols,
         unsigned int startState,
         unsigned char *out,
-        unsigned char *m_pathMemory0,
-        unsigned char *m_pathMemory1,
-        unsigned char *m_pathMemory2,
-        unsigned char *m_pathMemory3,
-        unsigned char *m_pathMemory4,
-        unsigned char *m_pathMemory5,
-        unsigned char *m_pathMemory6,
-        unsigned char *m_pathMemory7,
-        unsigned char *m_pathMemory8,
-        unsigned char *m_pathMemory9,
-        unsigned char *m_pathMemory10,
-        unsigned char *m_pathMemory11,
-        unsigned char *m_pathMemory12,
-        unsigned char *m_pathMemory13,
-        unsigned char *m_pathMemory14,
-        unsigned char *m_pathMemory15
+        const unsigned char *pathMemory
 )
 {
     unsigned int state = startState;
 
     for (int loop = nbSymbols - 1; loop >= 0; loop--)
     {
-        switch (state)
-        {
-        case 0: // if state S0
-            state = m_pathMemory0[loop];
-            out[loop] = 0;
-            break;
-
-        case 1: // if state S1
-            state = m_pathMemory1[loop];
-            out[loop] = 0;
-            break;
-
-        case 2: // if state S2
-            state = m_pathMemory2[loop];
-            out[loop] = 0;
-            break;
-
-        case 3: // if state S3
-            state = m_pathMemory3[loop];
-            out[loop] = 0;
-            break;
-
-        case 4: // if state S4
-            state = m_pathMemory4[loop];
-            out[loop] = 0;
-            break;
-
-        case 5: // if state S5
-            state = m_pathMemory5[loop];
-            out[loop] = 0;
-            break;
-
-        case 6: // if state S6
-            state = m_pathMemory6[loop];
-            out[loop] = 0;
-            break;
-
-        case 7: // if state S7
-            state = m_pathMemory7[loop];
-            out[loop] = 0;
-            break;
-
-        case 8: // if state S8
-            state = m_pathMemory8[loop];
-            out[loop] = 1;
-            break;
-
-        case 9: // if state S9
-            state = m_pathMemory9[loop];
-            out[loop] = 1;
-            break;
-
-        case 10: // if state S10
-            state = m_pathMemory10[loop];
-            out[loop] = 1;
-            break;
-
-        case 11: // if state S11
-            state = m_pathMemory11[loop];
-            out[loop] = 1;
-            break;
-
-        case 12: // if state S12
-            state = m_pathMemory12[loop];
-            out[loop] = 1;
-            break;
-
-        case 13: // if state S13
-            state = m_pathMemory13[loop];
-            out[loop] = 1;
-            break;
-
-        case 14: // if state S14
-            state = m_pathMemory14[loop];
-            out[loop] = 1;
-            break;
-
-        case 15: // if state S15
-            state = m_pathMemory15[loop];
-            out[loop] = 1;
-            break;
-        }; // end switch
-    }; // end for
+        out[loop] = state < 8 ? 0 : 1; // upper half of the states are reached with a one
+        state = pathMemory[16*loop + state];
+    }
 }
 
 }
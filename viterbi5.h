@@ -49,25 +49,9 @@ public:
 
 private:
     static void doMetrics (
-            int n,
-            unsigned char *branchCodes,
+            const unsigned char *branchCodes,
             unsigned char symbol,
-            unsigned char *m_pathMemory0,
-            unsigned char *m_pathMemory1,
-            unsigned char *m_pathMemory2,
-            unsigned char *m_pathMemory3,
-            unsigned char *m_pathMemory4,
-            unsigned char *m_pathMemory5,
-            unsigned char *m_pathMemory6,
-            unsigned char *m_pathMemory7,
-            unsigned char *m_pathMemory8,
-            unsigned char *m_pathMemory9,
-            unsigned char *m_pathMemory10,
-            unsigned char *m_pathMemory11,
-            unsigned char *m_pathMemory12,
-            unsigned char *m_pathMemory13,
-            unsigned char *m_pathMemory14,
-            unsigned char *m_pathMemory15,
+            unsigned char *pathMemory,
             uint32_t *m_pathMetric
     );
 
@@ -75,22 +59,7 @@ private:
             int nbSymbols,
             unsigned int startState,
             unsigned char *out,
-            unsigned char *m_pathMemory0,
-            unsigned char *m_pathMemory1,
-            unsigned char *m_pathMemory2,
-            unsigned char *m_pathMemory3,
-            unsigned char *m_pathMemory4,
-            unsigned char *m_pathMemory5,
-            unsigned char *m_pathMemory6,
-            unsigned char *m_pathMemory7,
-            unsigned char *m_pathMemory8,
-            unsigned char *m_pathMemory9,
-            unsigned char *m_pathMemory10,
-            unsigned char *m_pathMemory11,
-            unsigned char *m_pathMemory12,
-            unsigned char *m_pathMemory13,
-            unsigned char *m_pathMemory14,
-            unsigned char *m_pathMemory15
+            const unsigned char *pathMemory
     );
 };
 
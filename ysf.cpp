@@ -79,51 +79,6 @@ const int DSDYSF::m_vd2DVSIInterleave[49] = {
 		2, 5, 8, 11, 14, 17, 20, 23, 26, 29, 32, 35, 38
 };
 
-/*
- * AMBE 3600x2450 interleave schedule
- */
-// bit 1
-// frame index
-const int DSDYSF::rW[36] = {
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 1,
-  0, 1, 0, 1, 0, 2,
-  0, 2, 0, 2, 0, 2,
-  0, 2, 0, 2, 0, 2
-};
-
-// bit index
-const int DSDYSF::rX[36] = {
-  23, 10, 22, 9, 21, 8,
-  20, 7, 19, 6, 18, 5,
-  17, 4, 16, 3, 15, 2,
-  14, 1, 13, 0, 12, 10,
-  11, 9, 10, 8, 9, 7,
-  8, 6, 7, 5, 6, 4
-};
-
-// bit 0
-// frame index
-const int DSDYSF::rY[36] = {
-  0, 2, 0, 2, 0, 2,
-  0, 2, 0, 3, 0, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3,
-  1, 3, 1, 3, 1, 3
-};
-
-// bit index
-const int DSDYSF::rZ[36] = {
-  5, 3, 4, 2, 3, 1,
-  2, 0, 1, 13, 0, 12,
-  22, 11, 21, 10, 20, 9,
-  19, 8, 18, 7, 17, 6,
-  16, 5, 15, 4, 14, 3,
-  13, 2, 12, 1, 11, 0
-};
-
 /*
  * IMBE 7200x4400 interleave schedule
  *
@@ -192,14 +147,20 @@ DSDYSF::DSDYSF(DSDDecoder *dsdDecoder) :
         m_fichError(FICHNoError),
         m_viterbiFICH(2, Viterbi::Poly25y, true),
         m_crc(DSDcc::CRC::PolyCCITT16, 16, 0x0, 0xffff),
-        m_pn(0x1c9)
+        m_pn(0x1c9),
+        m_ambeDeinterleaver(Deinterleaver::AMBE3600x2450, 72, 96),
+        m_vd2Deinterleaver(m_vd2Interleave, 104, 104),
+        m_vfrDeinterleaver(m_vfrInterleave, 144, 144)
 {
     memset(m_fichRaw, 0, 100);
+    memset(m_fichSoft, 0, 200);
     memset(m_fichGolay, 0, 100);
     memset(m_fichBits, 0, 48);
     memset(m_dch1Raw, 0, 180);
+    memset(m_dch1Soft, 0, 360);
     memset(m_dch1Bits, 0, 180);
     memset(m_dch2Raw, 0, 180);
+    memset(m_dch2Soft, 0, 360);
     memset(m_dch2Bits, 0, 180);
     memset(m_vd2BitsRaw, 0, 104);
     memset(m_vd2MBEBits, 0, 72);
@@ -217,10 +178,6 @@ DSDYSF::DSDYSF(DSDDecoder *dsdDecoder) :
     memset(m_destId, 0, 5+1);
     memset(m_srcId, 0, 5+1);
 
-    w = 0;
-    x = 0;
-    y = 0;
-    z = 0;
     m_vfrStart = false;
 }
 
@@ -312,29 +269,41 @@ void DSDYSF::process() // just pass the frames for now
 
 void DSDYSF::processFICH(int symbolIndex, unsigned char dibit)
 {
-    m_fichRaw[m_fichInterleave[symbolIndex]] = dibit;
+    storeDibit(m_fichRaw, m_fichSoft, m_fichInterleave[symbolIndex], dibit);
 
     if (symbolIndex == 100-1)
     {
-        m_viterbiFICH.decodeFromSymbols(m_fichGolay, m_fichRaw, 100, 0);
-        int i = 0;
+        viterbiDecode(m_fichGolay, m_fichRaw, m_fichSoft, 100);
+        uint32_t codewords[4]; // Golay (24,12) codewords with their first bit as MSB
+        uint16_t data[4];
+        uint32_t errorMap;
 
-        for (; i < 4; i++)
+        for (int i = 0; i < 4; i++)
         {
-            if (m_golay_24_12.decode(&m_fichGolay[24*i]))
-            {
-                memcpy(&m_fichBits[12*i], &m_fichGolay[24*i], 12);
-            }
-            else
-            {
-                std::cerr << "DSDYSF::processFICH: Golay KO #" << i << std::endl;
-                m_fichError = FICHErrorGolay;
-                break;
+            codewords[i] = 0;
+
+            for (int j = 0; j < 24; j++) {
+                codewords[i] = (codewords[i] << 1) | m_fichGolay[24*i + j];
             }
         }
 
-        if (i == 4) // decoding OK
+        if (!m_golay_24_12.decodeBatch(codewords, data, 4, &errorMap))
+        {
+            int i = 0;
+
+            while (((errorMap >> i) & 1) == 0) {
+                i++;
+            }
+
+            std::cerr << "DSDYSF::processFICH: Golay KO #" << i << std::endl;
+            m_fichError = FICHErrorGolay;
+        }
+        else // decoding OK
         {
+            for (int i = 0; i < 48; i++) {
+                m_fichBits[i] = (data[i/12] >> (11 - (i%12))) & 1;
+            }
+
             if (checkCRC16(m_fichBits, 4))
             {
                 m_fich.setBytes(m_fichBits);
@@ -354,51 +323,51 @@ void DSDYSF::processHeader(int symbolIndex, unsigned char dibit)
 {
     if (symbolIndex < 36)         // DCH1(0)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex], dibit);
     }
     else if (symbolIndex < 2*36)  // DCH2(0)
     {
-        m_dch2Raw[m_dchInterleave[symbolIndex - 36]] = dibit;
+        storeDibit(m_dch2Raw, m_dch2Soft, m_dchInterleave[symbolIndex - 36], dibit);
     }
     else if (symbolIndex < 3*36)  // DCH1(1)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex - 36]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex - 36], dibit);
     }
     else if (symbolIndex < 4*36)  // DCH2(1)
     {
-        m_dch2Raw[m_dchInterleave[symbolIndex - 2*36]] = dibit;
+        storeDibit(m_dch2Raw, m_dch2Soft, m_dchInterleave[symbolIndex - 2*36], dibit);
     }
     else if (symbolIndex < 5*36)  // DCH1(2)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex - 2*36]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex - 2*36], dibit);
     }
     else if (symbolIndex < 6*36)  // DCH2(2)
     {
-        m_dch2Raw[m_dchInterleave[symbolIndex - 3*36]] = dibit;
+        storeDibit(m_dch2Raw, m_dch2Soft, m_dchInterleave[symbolIndex - 3*36], dibit);
     }
     else if (symbolIndex < 7*36)  // DCH1(3)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex - 3*36]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex - 3*36], dibit);
     }
     else if (symbolIndex < 8*36)  // DCH2(3)
     {
-        m_dch2Raw[m_dchInterleave[symbolIndex - 4*36]] = dibit;
+        storeDibit(m_dch2Raw, m_dch2Soft, m_dchInterleave[symbolIndex - 4*36], dibit);
     }
     else if (symbolIndex < 9*36)  // DCH1(4)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex - 4*36]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex - 4*36], dibit);
     }
     else if (symbolIndex < 10*36) // DCH2(4)
     {
-        m_dch2Raw[m_dchInterleave[symbolIndex - 5*36]] = dibit;
+        storeDibit(m_dch2Raw, m_dch2Soft, m_dchInterleave[symbolIndex - 5*36], dibit);
     }
 
     if (symbolIndex == 360 - 1) // final
     {
         unsigned char bytes[22];
 
-        m_viterbiFICH.decodeFromSymbols(m_dch1Bits, m_dch1Raw, 180, 0);
-        m_viterbiFICH.decodeFromSymbols(m_dch2Bits, m_dch2Raw, 180, 0);
+        viterbiDecode(m_dch1Bits, m_dch1Raw, m_dch1Soft, 180);
+        viterbiDecode(m_dch2Bits, m_dch2Raw, m_dch2Soft, 180);
 
         if (checkCRC16(m_dch1Bits, 20, bytes)) // CSD1
         {
@@ -474,7 +443,7 @@ void DSDYSF::processVD1(int symbolIndex, unsigned char dibit)
 {
     if (symbolIndex < 36)         // DCH(0)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex], dibit);
     }
     else if (symbolIndex < 2*36)  // VCH(0)
     {
@@ -482,7 +451,7 @@ void DSDYSF::processVD1(int symbolIndex, unsigned char dibit)
     }
     else if (symbolIndex < 3*36)  // DCH(1)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex - 36]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex - 36], dibit);
     }
     else if (symbolIndex < 4*36)  // VCH(1)
     {
@@ -490,7 +459,7 @@ void DSDYSF::processVD1(int symbolIndex, unsigned char dibit)
     }
     else if (symbolIndex < 5*36)  // DCH(2)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex - 2*36]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex - 2*36], dibit);
     }
     else if (symbolIndex < 6*36)  // VCH(2)
     {
@@ -498,7 +467,7 @@ void DSDYSF::processVD1(int symbolIndex, unsigned char dibit)
     }
     else if (symbolIndex < 7*36)  // DCH(3)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex - 3*36]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex - 3*36], dibit);
     }
     else if (symbolIndex < 8*36)  // VCH(3)
     {
@@ -506,13 +475,13 @@ void DSDYSF::processVD1(int symbolIndex, unsigned char dibit)
     }
     else if (symbolIndex < 9*36)  // DCH(4)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex - 4*36]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex - 4*36], dibit);
 
         if (symbolIndex == 9*36 - 1)
         {
             unsigned char bytes[22];
 
-            m_viterbiFICH.decodeFromSymbols(m_dch1Bits, m_dch1Raw, 180, 0);
+            viterbiDecode(m_dch1Bits, m_dch1Raw, m_dch1Soft, 180);
 
             if (checkCRC16(m_dch1Bits, 20, bytes)) // CSD
             {
@@ -544,7 +513,7 @@ void DSDYSF::processVD2(int symbolIndex, unsigned char dibit)
 {
     if (symbolIndex < 20) // DCH(0) - reuse FICH buffer
     {
-        m_fichRaw[m_fichInterleave[symbolIndex]] = dibit;
+        storeDibit(m_fichRaw, m_fichSoft, m_fichInterleave[symbolIndex], dibit);
     }
     else if (symbolIndex < 20 + 52) // VCH(0) and VeCH(0)
     {
@@ -552,7 +521,7 @@ void DSDYSF::processVD2(int symbolIndex, unsigned char dibit)
     }
     else if (symbolIndex < 2*20 + 52) // DCH(1)
     {
-        m_fichRaw[m_fichInterleave[symbolIndex - 52]] = dibit;
+        storeDibit(m_fichRaw, m_fichSoft, m_fichInterleave[symbolIndex - 52], dibit);
     }
     else if (symbolIndex < 2*20 + 2*52) // VCH(1) and VeCH(1)
     {
@@ -560,7 +529,7 @@ void DSDYSF::processVD2(int symbolIndex, unsigned char dibit)
     }
     else if (symbolIndex < 3*20 + 2*52) // DCH(2)
     {
-        m_fichRaw[m_fichInterleave[symbolIndex - 2*52]] = dibit;
+        storeDibit(m_fichRaw, m_fichSoft, m_fichInterleave[symbolIndex - 2*52], dibit);
     }
     else if (symbolIndex < 3*20 + 3*52) // VCH(2) and VeCH(2)
     {
@@ -568,7 +537,7 @@ void DSDYSF::processVD2(int symbolIndex, unsigned char dibit)
     }
     else if (symbolIndex < 4*20 + 3*52) // DCH(3)
     {
-        m_fichRaw[m_fichInterleave[symbolIndex - 3*52]] = dibit;
+        storeDibit(m_fichRaw, m_fichSoft, m_fichInterleave[symbolIndex - 3*52], dibit);
     }
     else if (symbolIndex < 4*20 + 4*52) // VCH(3) and VeCH(3)
     {
@@ -576,13 +545,13 @@ void DSDYSF::processVD2(int symbolIndex, unsigned char dibit)
     }
     else if (symbolIndex < 5*20 + 4*52) // DCH(4)
     {
-        m_fichRaw[m_fichInterleave[symbolIndex - 4*52]] = dibit;
+        storeDibit(m_fichRaw, m_fichSoft, m_fichInterleave[symbolIndex - 4*52], dibit);
 
         if (symbolIndex == (5*20 + 4*52) - 1) // Final DCH
         {
             unsigned char bytes[12];
 
-            m_viterbiFICH.decodeFromSymbols(m_fichGolay, m_fichRaw, 100, 0); // reuse FICH
+            viterbiDecode(m_fichGolay, m_fichRaw, m_fichSoft, 100); // reuse FICH
 
             if (checkCRC16(m_fichGolay, 10, bytes))
             {
@@ -630,24 +599,16 @@ void DSDYSF::processVD2Voice(int mbeIndex, unsigned char dibit)
 {
     if (mbeIndex == 0) // init
     {
-        w = rW;
-        x = rX;
-        y = rY;
-        z = rZ;
-
         memset((void *) m_dsdDecoder->m_mbeDVFrame1, 0, 9); // initialize DVSI frame
-        memset(m_vd2BitsRaw, 0, 104);
         memset(m_vd2MBEBits, 0, 72);
     }
 
-    // de-interleave and de-whiten in one shot
-    unsigned int msbI = m_vd2Interleave[2*mbeIndex];
-    unsigned int lsbI = m_vd2Interleave[2*mbeIndex+1];
-    m_vd2BitsRaw[msbI] = ((dibit>>1) & 1) ^ m_pn.getBit(msbI);
-    m_vd2BitsRaw[lsbI] = (dibit & 1) ^ m_pn.getBit(lsbI);
+    m_vd2Deinterleaver.pushDibit(mbeIndex, dibit);
 
     if (mbeIndex == 52 - 1) // final
     {
+        m_vd2Deinterleaver.getBits(m_vd2BitsRaw, m_pn.getBits()); // de-interleave and de-whiten in one shot
+
         int nbOnes;
         unsigned int mbeIndex;
         unsigned int bit;
@@ -698,7 +659,7 @@ void DSDYSF::processVFRSubHeader(int symbolIndex, unsigned char dibit)
 {
     if (symbolIndex < 5*36)
     {
-        m_dch1Raw[m_dchInterleave[symbolIndex]] = dibit;
+        storeDibit(m_dch1Raw, m_dch1Soft, m_dchInterleave[symbolIndex], dibit);
 
         if (symbolIndex == 5*36 - 1)
         {
@@ -706,7 +667,7 @@ void DSDYSF::processVFRSubHeader(int symbolIndex, unsigned char dibit)
 
             unsigned char bytes[22];
 
-            m_viterbiFICH.decodeFromSymbols(m_dch1Bits, m_dch1Raw, 180, 0);
+            viterbiDecode(m_dch1Bits, m_dch1Raw, m_dch1Soft, 180);
 
             if (checkCRC16(m_dch1Bits, 20, bytes)) // CSD3
             {
@@ -758,29 +719,41 @@ void DSDYSF::processVFRFullIMBE(int symbolIndex, unsigned char dibit)
     }
 }
 
+void DSDYSF::storeDibit(unsigned char *raw, unsigned char *soft, int index, unsigned char dibit)
+{
+    raw[index] = dibit;
+
+    if (m_dsdDecoder->m_opts.soft_ysf)
+    {
+        const DSDSoftDibit& softDibit = m_dsdDecoder->m_dsdSymbol.getSoftDibit();
+        soft[2*index]     = softDibit.m_bit0; // Viterbi symbol bits LSB first
+        soft[2*index + 1] = softDibit.m_bit1;
+    }
+}
+
+void DSDYSF::viterbiDecode(unsigned char *bits, const unsigned char *raw, const unsigned char *soft, unsigned int nbSymbols)
+{
+    if (m_dsdDecoder->m_opts.soft_ysf) {
+        m_viterbiFICH.decodeFromSoftBits(bits, soft, 2*nbSymbols, 0);
+    } else {
+        m_viterbiFICH.decodeFromSymbols(bits, raw, nbSymbols, 0);
+    }
+}
+
 void DSDYSF::processAMBE(int mbeIndex, unsigned char dibit)
 {
 	if (mbeIndex == 0) // init
 	{
-	    w = rW;
-	    x = rX;
-	    y = rY;
-	    z = rZ;
-
         memset((void *) m_dsdDecoder->m_mbeDVFrame1, 0, 9); // initialize DVSI frame
 	}
 
-	m_dsdDecoder->ambe_fr[*w][*x] = (1 & (dibit >> 1)); // bit 1
-	m_dsdDecoder->ambe_fr[*y][*z] = (1 & dibit);        // bit 0
-	w++;
-	x++;
-	y++;
-	z++;
+	m_ambeDeinterleaver.pushDibit(mbeIndex, dibit);
 
 	storeSymbolDV(m_dsdDecoder->m_mbeDVFrame1, mbeIndex, dibit); // store dibit for DVSI hardware decoder
 
 	if (mbeIndex == 36-1) // finalize
 	{
+        m_ambeDeinterleaver.getBits((unsigned char *) m_dsdDecoder->ambe_fr);
         m_dsdDecoder->m_mbeDecoder1.processFrame(0, m_dsdDecoder->ambe_fr, 0);
         m_dsdDecoder->m_mbeDVReady1 = true; // Indicate that a DVSI frame is available
 	}
@@ -793,17 +766,12 @@ void DSDYSF::procesVFRFrame(int mbeIndex, unsigned char dibit)
         memset((void *) m_dsdDecoder->m_mbeDVFrame1, 0, 18); // initialize DVSI frame
 	}
 
-	m_vfrBitsRaw[m_vfrInterleave[2*mbeIndex]]     = (1 & (dibit >> 1)); // bit 1
-	m_vfrBitsRaw[m_vfrInterleave[2*mbeIndex + 1]] = (1 & dibit);        // bit 0
+	m_vfrDeinterleaver.pushDibit(mbeIndex, dibit);
 
 	if (mbeIndex == 72-1) // finalize
 	{
-        uint16_t seed = 0;
-
-        for (uint16_t i = 0; i < 12; i++)
-        {
-            seed = (seed << 1) | m_vfrBitsRaw[i];
-        }
+        m_vfrDeinterleaver.getBits(m_vfrBitsRaw);
+        uint16_t seed = m_vfrDeinterleaver.getCodeword(0, 12);
 
         scrambleVFR(m_vfrBitsRaw+23, m_vfrBitsRaw+23, 144-23-7, seed, 4);
 
@@ -865,32 +833,28 @@ void DSDYSF::storeSymbolDV(unsigned char *mbeFrame, int dibitindex, unsigned cha
 
 bool DSDYSF::checkCRC16(unsigned char *bits,  unsigned long nbBytes, unsigned char *xoredBytes)
 {
-    unsigned char bytes[22];
-//    std::cerr << "DSDYSF::checkCRC16: value: ";
-
-    for (unsigned int i = 0; i < nbBytes+2; i++)
+    if (xoredBytes)
     {
-        bytes[i] = (bits[8*i+0]<<7)
-                + (bits[8*i+1]<<6)
-                + (bits[8*i+2]<<5)
-                + (bits[8*i+3]<<4)
-                + (bits[8*i+4]<<3)
-                + (bits[8*i+5]<<2)
-                + (bits[8*i+6]<<1)
-                + (bits[8*i+7]<<0);
-
-        if (xoredBytes)
+        for (unsigned int i = 0; i < nbBytes+2; i++)
         {
-            xoredBytes[i] = bytes[i] ^ m_pn.getByte(i);
+            xoredBytes[i] = ((bits[8*i+0]<<7)
+                    + (bits[8*i+1]<<6)
+                    + (bits[8*i+2]<<5)
+                    + (bits[8*i+3]<<4)
+                    + (bits[8*i+4]<<3)
+                    + (bits[8*i+5]<<2)
+                    + (bits[8*i+6]<<1)
+                    + (bits[8*i+7]<<0)) ^ m_pn.getByte(i);
         }
-//        std::cerr << std::hex << (int) bytes[i] << " ";
     }
 
-    unsigned int crc = (bytes[nbBytes]<<8) + bytes[nbBytes+1];
+    unsigned int crc = 0;
 
-//    std::cerr << "crc: " << std::hex << crc << std::endl;
+    for (int i = 0; i < 16; i++) {
+        crc = (crc << 1) + bits[8*nbBytes + i];
+    }
 
-    return m_crc.crctablefast(bytes, nbBytes) == crc;
+    return m_crc.crcbits(bits, 8*nbBytes) == crc;
 }
 
 void DSDYSF::scrambleVFR(uint8_t out[], uint8_t in[], uint16_t n, uint32_t seed, uint8_t shift)
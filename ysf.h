@@ -25,6 +25,7 @@
 #include "fec.h"
 #include "crc.h"
 #include "pn.h"
+#include "deinterleave.h"
 #include "export.h"
 
 namespace DSDcc
@@ -218,6 +219,8 @@ private:
     void processCSD3_1(unsigned char *dchBytes);
     void processCSD3_2(unsigned char *dchBytes);
     void processAMBE(int mbeIndex, unsigned char dibit);
+    void storeDibit(unsigned char *raw, unsigned char *soft, int index, unsigned char dibit);
+    void viterbiDecode(unsigned char *bits, const unsigned char *raw, const unsigned char *soft, unsigned int nbSymbols);
     void procesVFRFrame(int mbeIndex, unsigned char dibit);
     void storeSymbolDV(unsigned char *mbeFrame, int dibitindex, unsigned char dibit, bool invertDibit = false);
 
@@ -228,15 +231,18 @@ private:
     int m_symbolIndex;                //!< Current symbol index
 
     unsigned char m_fichRaw[100];     //!< FICH dibits after de-interleave + Viterbi stuff symbols
+    unsigned char m_fichSoft[200];    //!< FICH soft bits after de-interleave (LSB then MSB of each dibit)
     unsigned char m_fichGolay[100];   //!< FICH Golay encoded bits + 4 stuff bits + Viterbi stuff bits
     unsigned char m_fichBits[48];     //!< Final FICH + CRC16
     FICH          m_fich;             //!< Validated FICH
     FICHError     m_fichError;        //!< FICH decoding error status
 
     unsigned char m_dch1Raw[180];     //!< DCH1 dibits after de-interleave
+    unsigned char m_dch1Soft[360];    //!< DCH1 soft bits after de-interleave
     unsigned char m_dch1Bits[180];    //!< DCH1 bits after de-convolution
 
     unsigned char m_dch2Raw[180];     //!< DCH2 dibits after de-interleave
+    unsigned char m_dch2Soft[360];    //!< DCH2 soft bits after de-interleave
     unsigned char m_dch2Bits[180];    //!< DCH2 bits after de-convolution
 
     unsigned char m_vd2BitsRaw[104];  //!< V/D type 2 VCH+VeCH after de-interleave and de-whitening
@@ -250,6 +256,9 @@ private:
     Golay_24_12 m_golay_24_12;
     CRC m_crc;
     PN_9_5 m_pn;
+    Deinterleaver m_ambeDeinterleaver; //!< V/D mode 1 AMBE frames
+    Deinterleaver m_vd2Deinterleaver;  //!< V/D mode 2 VCH+VeCH
+    Deinterleaver m_vfrDeinterleaver;  //!< VFR full rate IMBE frames
     unsigned char m_bitWork[48];
 
     char m_dest[10+1];     //!< Destination callsign from CSD1
@@ -263,13 +272,6 @@ private:
     char m_destId[5+1];    //!< Destination radio ID
     char m_srcId[5+1];     //!< Source radio ID
 
-    // AMBE interleave
-    const int *w, *x, *y, *z;
-    static const int rW[36];
-    static const int rX[36];
-    static const int rY[36];
-    static const int rZ[36];
-
     static const int m_fichInterleave[100];   //!< FICH symbols interleaving matrix
     static const int m_dchInterleave[180];    //!< DCH symbols interleaving matrix
     static const int m_vd2Interleave[104];    //!< V/D type 2 interleaving matrix